@@ -375,10 +375,12 @@ int main (int argc, char* args[]) {
     HEADER << "#include <boost/statechart/custom_reaction.hpp>"<<endl;
     HEADER << "#include <boost/statechart/transition.hpp>"<<endl;
     HEADER << "#include <boost/mpl/list.hpp>"<<endl;
-    HEADER << "#include <boost/config.hpp>"<<endl<<endl;
+    HEADER << "#include <boost/config.hpp>"<<endl;
+    HEADER << "#include <boost/pool/pool_alloc.hpp>"<<endl<<endl;
     HEADER << "#include \"ChasteSerialization.hpp\"" << endl;
     HEADER << "#include <boost/serialization/base_object.hpp>" <<endl;
     HEADER << "#include <boost/serialization/vector.hpp>" <<endl<<endl;  
+    HEADER << "#include \"PoolAllocated.hpp\"" <<endl<<endl;
     HEADER << "namespace sc = boost::statechart;"<<endl;
     HEADER << "namespace mpl = boost::mpl;"<<endl<<endl;
 
@@ -415,7 +417,9 @@ int main (int argc, char* args[]) {
     //Declare the chart structure starting with the CellStatechart itself
     HEADER<<"//PARENT STATECHART"<<endl<<endl;
     
-    HEADER<<"struct CellStatechart:  sc::state_machine<CellStatechart,Running>{"<< endl;
+    //The chart and its state objects are pool allocated, as charts are created and destroyed on every
+    //division and death.
+    HEADER<<"struct CellStatechart:  sc::state_machine<CellStatechart,Running,boost::fast_pool_allocator<int> >, PoolAllocated<CellStatechart>{"<< endl;
     //Declare some functions and variables a statechart is expected to have:
     //1) A constructor.
     HEADER<<"  CellStatechart();"<<endl<<endl;
@@ -428,10 +432,16 @@ int main (int argc, char* args[]) {
     //   - for any chart-associated-variables (used in archiving simulations ONLY)
     //   - a setter method for the cell pointer.
     HEADER<<"  int GetState();"<<endl;
-    HEADER<<"  std::vector<double> GetVariables();"<<endl;
+    HEADER<<"  void GetVariables(double* pValues);"<<endl;
     HEADER<<"  void SetState(int state);"<<endl;
-    HEADER<<"  void SetVariables(std::vector<double> variableValues);"<<endl;
+    HEADER<<"  void SetVariables(const double* pValues);"<<endl;
     HEADER<<"  void SetCell(CellPtr newCell);"<<endl<<endl;
+    //   - the chart-associated-variable schema: the number of variables, their names and the members
+    //     they live in. Archives store variables by name using this table.
+    HEADER<<"  static const unsigned NUM_VARIABLES=1;"<<endl;
+    HEADER<<"  static const char* const VARIABLE_NAMES[NUM_VARIABLES];"<<endl;
+    HEADER<<"  static double CellStatechart::* const VARIABLE_MEMBERS[NUM_VARIABLES];"<<endl;
+    HEADER<<"  static int GetVariableIndex(const std::string& rName);"<<endl<<endl;
     //5) Finally, a list of chart-associated-variables (doubles). To make the cell cycle work,
     //   we expect at a minimum to have one double here named TimeInPhase
     HEADER<<"  double TimeInPhase;"<<endl;
@@ -574,16 +584,33 @@ MAIN<< "     assert(newCell!=NULL);"<<endl;
 MAIN<< "     pCell=newCell;"<<endl;
 MAIN<< "};"<<endl<<endl;
 
-//Get chart-associated-variables in array form for archiving.
-MAIN<<"std::vector<double> CellStatechart::GetVariables(){"<<endl;
-MAIN<<"    std::vector<double> variables;"<<endl;
-MAIN<<"    variables.push_back(TimeInPhase);"<<endl;
-MAIN<<"    return variables;"<<endl;
+//Chart-associated-variable schema. Any variable added to the chart must be added to both tables.
+MAIN<<"const unsigned CellStatechart::NUM_VARIABLES;"<<endl;
+MAIN<<"const char* const CellStatechart::VARIABLE_NAMES[CellStatechart::NUM_VARIABLES]={\"TimeInPhase\"};"<<endl;
+MAIN<<"double CellStatechart::* const CellStatechart::VARIABLE_MEMBERS[CellStatechart::NUM_VARIABLES]={&CellStatechart::TimeInPhase};"<<endl<<endl;
+
+//Look up a variable's position in the schema by name. Returns -1 if the chart has no such variable.
+MAIN<<"int CellStatechart::GetVariableIndex(const std::string& rName){"<<endl;
+MAIN<<"    for(unsigned i=0; i<NUM_VARIABLES; i++){"<<endl;
+MAIN<<"        if(rName==VARIABLE_NAMES[i]){"<<endl;
+MAIN<<"            return i;"<<endl;
+MAIN<<"        }"<<endl;
+MAIN<<"    }"<<endl;
+MAIN<<"    return -1;"<<endl;
+MAIN<<"}"<<endl;
+
+//Get chart-associated-variables into a caller-supplied array of NUM_VARIABLES doubles for archiving.
+MAIN<<"void CellStatechart::GetVariables(double* pValues){"<<endl;
+MAIN<<"    for(unsigned i=0; i<NUM_VARIABLES; i++){"<<endl;
+MAIN<<"        pValues[i]=this->*VARIABLE_MEMBERS[i];"<<endl;
+MAIN<<"    }"<<endl;
 MAIN<<"}"<<endl;
 
 //For archiving, write a method that takes a stored array and unpacks values for all variables.
-MAIN<<"void CellStatechart::SetVariables(std::vector<double> variables){"<<endl;
-MAIN<<"    TimeInPhase=variables.at(0);"<<endl;
+MAIN<<"void CellStatechart::SetVariables(const double* pValues){"<<endl;
+MAIN<<"    for(unsigned i=0; i<NUM_VARIABLES; i++){"<<endl;
+MAIN<<"        this->*VARIABLE_MEMBERS[i]=pValues[i];"<<endl;
+MAIN<<"    }"<<endl;
 MAIN<<"}"<<endl<<endl;
 
 //For archiving, a function that encodes the state as an integer for saving.
@@ -732,7 +759,7 @@ for (int i=0; i<StateList.size(); i++){
          ||StateList.at(i).name.find("_G1",StateList.at(i).name.length()-6)!=string::npos 
          ||StateList.at(i).name.find("_M",StateList.at(i).name.length()-2)!=string::npos 
          ||StateList.at(i).name.find("_S",StateList.at(i).name.length()-2)!=string::npos){
-            MAIN<<"  context<CellStatechart>().TimeInPhase+=GetTimestep();"<<endl;           
+            MAIN<<"  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);"<<endl;           
         }
         
         if(StateList.at(i).name.find("Meiosis")!=string::npos){
@@ -829,8 +856,11 @@ INTER<<"//Misc"<<endl;
 INTER<<"bool IsDead(CellPtr pCell){"<<endl;
 INTER<<"     return pCell->IsDead();"<<endl;
 INTER<<"};"<<endl;
-INTER<<"double GetTimestep(){"<<endl;
-INTER<<"     return SimulationTime::Instance()->GetTimeStep();"<<endl;
+INTER<<"//The time the statechart is advancing through in this update: one or more simulation timesteps,"<<endl;
+INTER<<"//depending on the cell cycle model's statechart update interval."<<endl;
+INTER<<"double GetTimestep(CellPtr pCell){"<<endl;
+INTER<<"    AbstractCellCycleModel* model = pCell->GetCellCycleModel();"<<endl;
+INTER<<"    return dynamic_cast<StatechartCellCycleModelSerializable*>(model)->GetStatechartTimestep();"<<endl;
 INTER<<"};"<<endl;
 INTER<<"double GetTime(){"<<endl;
 INTER<<"     return SimulationTime::Instance()->GetTime();"<<endl;
@@ -844,17 +874,20 @@ INTER<<"};"<<endl;
 INTER<<"void   SetRadius(CellPtr pCell, double radius){"<<endl;
 INTER<<"       pCell->GetCellData()->SetItem(\"Radius\",radius);"<<endl;
 INTER<<"};"<<endl;
+INTER<<"//Recorded in the cell cycle model by a GonadArmGeometryModifier, falling back to cell data if it hasn't run"<<endl;
 INTER<<"double GetDistanceFromDTC(CellPtr pCell){"<<endl;
-INTER<<"    return pCell->GetCellData()->GetItem(\"DistanceAwayFromDTC\");"<<endl;
+INTER<<"    AbstractCellCycleModel* model = pCell->GetCellCycleModel();"<<endl;
+INTER<<"    return dynamic_cast<StatechartCellCycleModelSerializable*>(model)->GetDistanceAwayFromDTC();"<<endl;
 INTER<<"};"<<endl;
 INTER<<"double GetMaxRadius(CellPtr pCell){"<<endl;
-INTER<<"    return pCell->GetCellData()->GetItem(\"MaxRadius\");"<<endl;
+INTER<<"    AbstractCellCycleModel* model = pCell->GetCellCycleModel();"<<endl;
+INTER<<"    return dynamic_cast<StatechartCellCycleModelSerializable*>(model)->GetMaxRadius();"<<endl;
 INTER<<"};"<<endl<<endl;
 INTER<<"void UpdateRadius(CellPtr pCell){"<<endl;
 INTER<< "  double MaxRad = GetMaxRadius(pCell);"<<endl;
 INTER<< "  double Rad = pCell->GetCellData()->GetItem(\"Radius\");"<<endl;
 INTER<< "  if(Rad<MaxRad-0.1){"<<endl;
-INTER<< "    SetRadius(pCell,Rad+=GetTimestep());"<<endl;
+INTER<< "    SetRadius(pCell,Rad+=GetTimestep(pCell));"<<endl;
 INTER<< "  }"<<endl;
 INTER<<"};"<<endl;
 
@@ -0,0 +1,274 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AdaptiveTimestepOffLatticeSimulation.hpp"
+#include "AbstractOffLatticeCellPopulation.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "RepulsionForceMassCorrected.hpp"
+#include "CellBasedEventHandler.hpp"
+#include "Exception.hpp"
+#include <cmath>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::AdaptiveTimestepOffLatticeSimulation(
+        AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation,
+        bool deleteCellPopulationInDestructor,
+        bool initialiseCells)
+    : OffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells),
+      mMaxDisplacement(0.05),
+      mMaxRefinementLevel(8),
+      mNumSubsteps(0),
+      mNumRefinedSubsteps(0),
+      mNumPairUpdates(0)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::CalculateForces()
+{
+    for (typename AbstractMesh<ELEMENT_DIM,SPACE_DIM>::NodeIterator node_iter = this->mrCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != this->mrCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        node_iter->ClearAppliedForce();
+    }
+
+    for (typename std::vector<boost::shared_ptr<AbstractForce<ELEMENT_DIM,SPACE_DIM> > >::iterator iter = this->mForceCollection.begin();
+         iter != this->mForceCollection.end();
+         ++iter)
+    {
+        (*iter)->AddForceContribution(this->mrCellPopulation);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::CalculateMaxNodeSpeed()
+{
+    AbstractOffLatticeCellPopulation<ELEMENT_DIM,SPACE_DIM>* p_population =
+        static_cast<AbstractOffLatticeCellPopulation<ELEMENT_DIM,SPACE_DIM>*>(&(this->mrCellPopulation));
+
+    // Nodes move with velocity F/damping under the population's overdamped update
+    double max_speed = 0.0;
+    for (typename AbstractMesh<ELEMENT_DIM,SPACE_DIM>::NodeIterator node_iter = this->mrCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != this->mrCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        double damping = p_population->GetDampingConstant(node_iter->GetIndex());
+        max_speed = std::max(max_speed, norm_2(node_iter->rGetAppliedForce())/damping);
+    }
+    return max_speed;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::CalculatePairRefreshDistance()
+{
+    NodesOnlyMesh<SPACE_DIM>* p_mesh = dynamic_cast<NodesOnlyMesh<SPACE_DIM>*>(&(this->mrCellPopulation.rGetMesh()));
+    if (p_mesh == NULL)
+    {
+        return mMaxDisplacement;
+    }
+
+    // The furthest apart two nodes can be and still interact
+    double max_radius = 0.0;
+    for (typename AbstractMesh<SPACE_DIM,SPACE_DIM>::NodeIterator node_iter = p_mesh->GetNodeIteratorBegin();
+         node_iter != p_mesh->GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        max_radius = std::max(max_radius, node_iter->GetRadius());
+    }
+    double interaction_distance = 2.0*max_radius;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<ELEMENT_DIM,SPACE_DIM> > >::iterator iter = this->mForceCollection.begin();
+         iter != this->mForceCollection.end();
+         ++iter)
+    {
+        RepulsionForceMassCorrected<SPACE_DIM>* p_repulsion = dynamic_cast<RepulsionForceMassCorrected<SPACE_DIM>*>(iter->get());
+        if (p_repulsion != NULL)
+        {
+            interaction_distance = std::max(interaction_distance, 2.0*max_radius + p_repulsion->GetVerletSkin());
+        }
+    }
+
+    // Each node of a pair can close half the margin; with no margin, refresh after every substep
+    return std::max(0.5*(p_mesh->GetMaximumInteractionDistance() - interaction_distance), 0.0);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::RecordPairReferenceLocations()
+{
+    mPairReferenceLocations.clear();
+    for (typename AbstractMesh<ELEMENT_DIM,SPACE_DIM>::NodeIterator node_iter = this->mrCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != this->mrCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        mPairReferenceLocations.push_back(node_iter->rGetLocation());
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::CalculateMaxDisplacementSincePairsUpdated()
+{
+    // Nodes are neither added nor removed within a step, so they are visited in the same order as when recorded
+    double max_displacement = 0.0;
+    unsigned i = 0;
+    for (typename AbstractMesh<ELEMENT_DIM,SPACE_DIM>::NodeIterator node_iter = this->mrCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != this->mrCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter, ++i)
+    {
+        assert(i < mPairReferenceLocations.size());
+        max_displacement = std::max(max_displacement, norm_2(node_iter->rGetLocation() - mPairReferenceLocations[i]));
+    }
+    return max_displacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::UpdateCellLocationsAndTopology()
+{
+    // The cell-level step; restored before returning so the rest of the simulation never sees a substep
+    const double step = this->mDt;
+
+    double time_remaining = step;
+    const double pair_refresh_distance = CalculatePairRefreshDistance();
+    RecordPairReferenceLocations();
+    while (time_remaining > 1e-12*step)
+    {
+        CellBasedEventHandler::BeginEvent(CellBasedEventHandler::FORCE);
+        CalculateForces();
+        double max_speed = CalculateMaxNodeSpeed();
+        CellBasedEventHandler::EndEvent(CellBasedEventHandler::FORCE);
+
+        // Halve the step until no node moves further than mMaxDisplacement, landing on dt/2^k so substeps tile dt
+        unsigned level = 0;
+        double substep = step;
+        while (level < mMaxRefinementLevel && max_speed*substep > mMaxDisplacement)
+        {
+            substep *= 0.5;
+            level++;
+        }
+        substep = std::min(substep, time_remaining);
+
+        CellBasedEventHandler::BeginEvent(CellBasedEventHandler::POSITION);
+        this->mDt = substep;
+        this->UpdateNodePositions();
+        this->mDt = step;
+        CellBasedEventHandler::EndEvent(CellBasedEventHandler::POSITION);
+
+        time_remaining -= substep;
+        mNumSubsteps++;
+        if (level > 0)
+        {
+            mNumRefinedSubsteps++;
+        }
+
+        // Refresh the node pairs once some pair the forces need could be missing from them. The actual
+        // displacements are used, as boundary conditions can move nodes further than the forces do.
+        if (time_remaining > 1e-12*step && CalculateMaxDisplacementSincePairsUpdated() >= pair_refresh_distance)
+        {
+            this->mrCellPopulation.Update(false);
+            RecordPairReferenceLocations();
+            mNumPairUpdates++;
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::SetMaxDisplacement(double maxDisplacement)
+{
+    if (maxDisplacement <= 0.0)
+    {
+        EXCEPTION("The maximum displacement per substep must be positive");
+    }
+    mMaxDisplacement = maxDisplacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::GetMaxDisplacement()
+{
+    return mMaxDisplacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::SetMaxRefinementLevel(unsigned maxRefinementLevel)
+{
+    mMaxRefinementLevel = maxRefinementLevel;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::GetMaxRefinementLevel()
+{
+    return mMaxRefinementLevel;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::GetNumSubsteps()
+{
+    return mNumSubsteps;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::GetNumRefinedSubsteps()
+{
+    return mNumRefinedSubsteps;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::GetNumPairUpdates()
+{
+    return mNumPairUpdates;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::OutputSimulationParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t<MaxDisplacement>" << mMaxDisplacement << "</MaxDisplacement>\n";
+    *rParamsFile << "\t\t<MaxRefinementLevel>" << mMaxRefinementLevel << "</MaxRefinementLevel>\n";
+
+    // Call method on direct parent class
+    OffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>::OutputSimulationParameters(rParamsFile);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class AdaptiveTimestepOffLatticeSimulation<1,1>;
+template class AdaptiveTimestepOffLatticeSimulation<1,2>;
+template class AdaptiveTimestepOffLatticeSimulation<2,2>;
+template class AdaptiveTimestepOffLatticeSimulation<1,3>;
+template class AdaptiveTimestepOffLatticeSimulation<2,3>;
+template class AdaptiveTimestepOffLatticeSimulation<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(AdaptiveTimestepOffLatticeSimulation)
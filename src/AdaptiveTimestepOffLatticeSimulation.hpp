@@ -0,0 +1,236 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ADAPTIVETIMESTEPOFFLATTICESIMULATION_HPP_
+#define ADAPTIVETIMESTEPOFFLATTICESIMULATION_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "OffLatticeSimulation.hpp"
+
+/**
+ * An off-lattice simulation whose mechanics take as many substeps within each timestep as the forces require.
+ *
+ * The simulation's dt is the step for everything except node movement: cell cycles and statecharts, killers,
+ * modifiers and moving boundaries all advance once per dt, as in OffLatticeSimulation. Node positions are then
+ * integrated across that step in substeps of dt/2^k, with k the smallest level at which no node moves further
+ * than mMaxDisplacement in one substep (up to mMaxRefinementLevel). Boundary conditions are imposed after every
+ * substep. A fixed dt has to be small enough for the worst overlap just after division; here only the steps
+ * that see such overlaps are refined, and quiescent periods run at the full dt.
+ *
+ * Node pairs are only recalculated part way through a step once they could be incomplete. For a NodesOnlyMesh
+ * they hold every pair within the mesh's interaction distance when recalculated, while forces need the pairs
+ * within twice the largest cell radius (plus the Verlet skin of any RepulsionForceMassCorrected), so the pairs
+ * stay complete until two nodes have closed the difference between the two. Other meshes are updated once the
+ * nodes have moved mMaxDisplacement.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class AdaptiveTimestepOffLatticeSimulation : public OffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<OffLatticeSimulation<ELEMENT_DIM,SPACE_DIM> >(*this);
+        archive & mMaxDisplacement;
+        archive & mMaxRefinementLevel;
+    }
+
+    /**
+     * The largest distance any node may move in one substep. Should be well below the population's absolute
+     * movement threshold and the cell radius. Defaults to 0.05.
+     */
+    double mMaxDisplacement;
+
+    /** The most times dt may be halved to find a substep. Defaults to 8. */
+    unsigned mMaxRefinementLevel;
+
+    /** The number of substeps taken since construction. Not archived. */
+    unsigned mNumSubsteps;
+
+    /** The number of substeps shorter than dt because of the forces (rather than the end of the step). Not archived. */
+    unsigned mNumRefinedSubsteps;
+
+    /** The number of times the node pairs were recalculated part way through a step. Not archived. */
+    unsigned mNumPairUpdates;
+
+    /** The location of each node when the node pairs were last recalculated, in mesh order. Not archived. */
+    std::vector<c_vector<double, SPACE_DIM> > mPairReferenceLocations;
+
+    /**
+     * Clear the applied force on each node and add the contributions from each force.
+     */
+    void CalculateForces();
+
+    /**
+     * @return the largest distance any node would move in unit time under its current applied force.
+     */
+    double CalculateMaxNodeSpeed();
+
+    /**
+     * @return how far any node may move before the population's node pairs must be recalculated.
+     */
+    double CalculatePairRefreshDistance();
+
+    /**
+     * Record the location of each node in mPairReferenceLocations, after the node pairs are recalculated.
+     */
+    void RecordPairReferenceLocations();
+
+    /**
+     * @return the largest distance any node has moved since RecordPairReferenceLocations() was last called.
+     */
+    double CalculateMaxDisplacementSincePairsUpdated();
+
+protected:
+
+    /**
+     * Overridden UpdateCellLocationsAndTopology() method.
+     *
+     * Moves the nodes across one dt in adaptive substeps, imposing the boundary conditions after each.
+     */
+    virtual void UpdateCellLocationsAndTopology();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation Reference to a cell population object
+     * @param deleteCellPopulationInDestructor Whether to delete the cell population on destruction to
+     *     free up memory (defaults to false)
+     * @param initialiseCells Whether to initialise cells (defaults to true, set to false when loading
+     *     from an archive)
+     */
+    AdaptiveTimestepOffLatticeSimulation(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation,
+                                         bool deleteCellPopulationInDestructor=false,
+                                         bool initialiseCells=true);
+
+    /**
+     * Set mMaxDisplacement.
+     *
+     * @param maxDisplacement the new value of mMaxDisplacement
+     */
+    void SetMaxDisplacement(double maxDisplacement);
+
+    /**
+     * @return mMaxDisplacement
+     */
+    double GetMaxDisplacement();
+
+    /**
+     * Set mMaxRefinementLevel.
+     *
+     * @param maxRefinementLevel the new value of mMaxRefinementLevel
+     */
+    void SetMaxRefinementLevel(unsigned maxRefinementLevel);
+
+    /**
+     * @return mMaxRefinementLevel
+     */
+    unsigned GetMaxRefinementLevel();
+
+    /**
+     * @return mNumSubsteps
+     */
+    unsigned GetNumSubsteps();
+
+    /**
+     * @return mNumRefinedSubsteps
+     */
+    unsigned GetNumRefinedSubsteps();
+
+    /**
+     * @return mNumPairUpdates
+     */
+    unsigned GetNumPairUpdates();
+
+    /**
+     * Overridden OutputSimulationParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationParameters(out_stream& rParamsFile);
+};
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(AdaptiveTimestepOffLatticeSimulation)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct an AdaptiveTimestepOffLatticeSimulation.
+ */
+template<class Archive, unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+inline void save_construct_data(
+    Archive & ar, const AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM> * t, const BOOST_PFTO unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>* p_cell_population = &(t->rGetCellPopulation());
+    ar & p_cell_population;
+}
+
+/**
+ * De-serialize constructor parameters and initialise an AdaptiveTimestepOffLatticeSimulation.
+ */
+template<class Archive, unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+inline void load_construct_data(
+    Archive & ar, AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    // Invoke inplace constructor to initialise instance, middle two variables set extra
+    // member variables to be deleted as they are loaded from archive and to not initialise cells.
+    ::new(t)AdaptiveTimestepOffLatticeSimulation<ELEMENT_DIM,SPACE_DIM>(*p_cell_population, true, false);
+}
+}
+} // namespace
+
+#endif /*ADAPTIVETIMESTEPOFFLATTICESIMULATION_HPP_*/
@@ -0,0 +1,156 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CompositePairwiseForce.hpp"
+#include <algorithm>
+#include <cfloat>
+
+template<unsigned DIM>
+CompositePairwiseForce<DIM>::CompositePairwiseForce()
+   : AbstractForce<DIM>()
+{
+}
+
+template<unsigned DIM>
+CompositePairwiseForce<DIM>::~CompositePairwiseForce()
+{
+}
+
+template<unsigned DIM>
+void CompositePairwiseForce<DIM>::AddForceLaw(boost::shared_ptr<AbstractTwoBodyInteractionForce<DIM> > pForceLaw)
+{
+    assert(pForceLaw);
+    mForceLaws.push_back(pForceLaw);
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<AbstractTwoBodyInteractionForce<DIM> > >& CompositePairwiseForce<DIM>::rGetForceLaws() const
+{
+    return mForceLaws;
+}
+
+template<unsigned DIM>
+void CompositePairwiseForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    // Throw an exception message if not using a NodeBasedCellPopulation
+    if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation) == NULL)
+    {
+        EXCEPTION("CompositePairwiseForce is to be used with a NodeBasedCellPopulation only");
+    }
+
+    unsigned num_laws = mForceLaws.size();
+    if (num_laws == 0)
+    {
+        return;
+    }
+
+    // Each law's squared cut-off, and the largest of them: pairs beyond it need no law at all. Squared, so the
+    // composite's check needs no square root; the laws in range calculate the distance themselves.
+    std::vector<double> squared_cut_offs(num_laws, DBL_MAX);
+    double max_squared_cut_off = 0.0;
+    for (unsigned law=0; law<num_laws; law++)
+    {
+        if (mForceLaws[law]->GetUseCutOffLength())
+        {
+            double cut_off = mForceLaws[law]->GetCutOffLength();
+            squared_cut_offs[law] = cut_off*cut_off;
+        }
+        max_squared_cut_off = std::max(max_squared_cut_off, squared_cut_offs[law]);
+    }
+
+    NodeBasedCellPopulation<DIM>* p_population = static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = p_population->rGetNodePairs();
+
+    for (typename std::vector< std::pair<Node<DIM>*, Node<DIM>* > >::iterator iter = r_node_pairs.begin();
+         iter != r_node_pairs.end();
+         ++iter)
+    {
+        Node<DIM>* p_node_a = iter->first;
+        Node<DIM>* p_node_b = iter->second;
+
+        const c_vector<double, DIM>& r_location_a = p_node_a->rGetLocation();
+        const c_vector<double, DIM>& r_location_b = p_node_b->rGetLocation();
+        double squared_distance = 0.0;
+        for (unsigned d=0; d<DIM; d++)
+        {
+            double difference = r_location_b[d] - r_location_a[d];
+            squared_distance += difference*difference;
+        }
+        if (squared_distance >= max_squared_cut_off)
+        {
+            continue;
+        }
+
+        unsigned node_a_index = p_node_a->GetIndex();
+        unsigned node_b_index = p_node_b->GetIndex();
+
+        c_vector<double, DIM> force = zero_vector<double>(DIM);
+        for (unsigned law=0; law<num_laws; law++)
+        {
+            if (squared_distance < squared_cut_offs[law])
+            {
+                force += mForceLaws[law]->CalculateForceBetweenNodes(node_a_index, node_b_index, rCellPopulation);
+            }
+        }
+
+        c_vector<double, DIM> negative_force = -1.0*force;
+        p_node_b->AddAppliedForceContribution(negative_force);
+        p_node_a->AddAppliedForceContribution(force);
+    }
+}
+
+template<unsigned DIM>
+void CompositePairwiseForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    for (unsigned law=0; law<mForceLaws.size(); law++)
+    {
+        mForceLaws[law]->OutputForceInfo(rParamsFile);
+    }
+
+    // Call method on direct parent class
+    AbstractForce<DIM>::OutputForceParameters(rParamsFile);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class CompositePairwiseForce<1>;
+template class CompositePairwiseForce<2>;
+template class CompositePairwiseForce<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(CompositePairwiseForce)
@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef COMPOSITEPAIRWISEFORCE_HPP_
+#define COMPOSITEPAIRWISEFORCE_HPP_
+
+#include "AbstractForce.hpp"
+#include "AbstractTwoBodyInteractionForce.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * A force made up of several two-body force laws (for example BuskeAdhesiveForce and BuskeElasticForce),
+ * evaluated in a single pass over the population's node pairs.
+ *
+ * Adding each law to the simulation separately visits every pair once per law, and applies each law's
+ * contribution to the two nodes separately. Here each pair is visited once: its squared separation is
+ * checked against each law's squared cut-off length, the forces of the laws in range are summed, and the
+ * total is applied to each node once.
+ *
+ * The saving is in the pair traversal, the cut-off checks and the force application. The laws are evaluated
+ * through their CalculateForceBetweenNodes() methods, which take node indices, so each law in range of a pair
+ * still looks up the node locations and radii and calculates the separation itself; only pairs out of range
+ * of every law are settled by the composite's own check alone.
+ *
+ * Forces that are not sums over pairs, such as BuskeCompressionForce (which needs each cell's total overlap
+ * with all of its neighbours), cannot be included and should be added to the simulation as before.
+ */
+template<unsigned DIM>
+class CompositePairwiseForce : public AbstractForce<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractForce<DIM> >(*this);
+        archive & mForceLaws;
+    }
+
+    /** The two-body force laws, in the order they were added. */
+    std::vector<boost::shared_ptr<AbstractTwoBodyInteractionForce<DIM> > > mForceLaws;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    CompositePairwiseForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~CompositePairwiseForce();
+
+    /**
+     * Add a two-body force law.
+     *
+     * @param pForceLaw the force law
+     */
+    void AddForceLaw(boost::shared_ptr<AbstractTwoBodyInteractionForce<DIM> > pForceLaw);
+
+    /**
+     * @return the force laws.
+     */
+    const std::vector<boost::shared_ptr<AbstractTwoBodyInteractionForce<DIM> > >& rGetForceLaws() const;
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * Visits each node pair once, adding the sum of the force laws' contributions to the two nodes.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputForceParameters() method. Outputs each force law's parameters.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputForceParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(CompositePairwiseForce)
+
+#endif /*COMPOSITEPAIRWISEFORCE_HPP_*/
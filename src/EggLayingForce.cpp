@@ -35,11 +35,25 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "EggLayingForce.hpp"
 #include "IsNan.hpp"
+#include "Exception.hpp"
+#include <cfloat>
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 EggLayingForce<ELEMENT_DIM,SPACE_DIM>::EggLayingForce()
-   : AbstractForce<ELEMENT_DIM,SPACE_DIM>()
+   : AbstractForce<ELEMENT_DIM,SPACE_DIM>(),
+     mNumNodesInRegion(0)
 {
+    // Default to pushing along x everything in the lower straight of the arm (x>0, y<0)
+    mForce = zero_vector<double>(SPACE_DIM);
+    mForce[0] = 5.0;
+
+    mRegionLowerCorner = scalar_vector<double>(SPACE_DIM, -DBL_MAX);
+    mRegionUpperCorner = scalar_vector<double>(SPACE_DIM, DBL_MAX);
+    mRegionLowerCorner[0] = 0.0;
+    if (SPACE_DIM > 1)
+    {
+        mRegionUpperCorner[1] = 0.0;
+    }
 }
 
 
@@ -51,28 +65,102 @@ EggLayingForce<ELEMENT_DIM,SPACE_DIM>::~EggLayingForce()
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 void EggLayingForce<ELEMENT_DIM,SPACE_DIM>::AddForceContribution(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
 {
-    for (typename AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>::Iterator cell_iter = rCellPopulation.Begin();
-         cell_iter != rCellPopulation.End();
-         ++cell_iter)
+    mNumNodesInRegion = 0;
+
+    AbstractMesh<ELEMENT_DIM,SPACE_DIM>& r_mesh = rCellPopulation.rGetMesh();
+    for (typename AbstractMesh<ELEMENT_DIM,SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        // Accumulate the box test without branching on each coordinate
+        const c_vector<double,SPACE_DIM>& r_location = node_iter->rGetLocation();
+        bool is_in_region = true;
+        for (unsigned d=0; d<SPACE_DIM; d++)
+        {
+            is_in_region &= (r_location[d] > mRegionLowerCorner[d]) & (r_location[d] < mRegionUpperCorner[d]);
+        }
+
+        if (is_in_region)
+        {
+            node_iter->AddAppliedForceContribution(mForce);
+            mNumNodesInRegion++;
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void EggLayingForce<ELEMENT_DIM,SPACE_DIM>::SetForce(const c_vector<double, SPACE_DIM>& rForce)
+{
+    for (unsigned d=0; d<SPACE_DIM; d++)
     {
-    	c_vector<double,SPACE_DIM> force;
-    	force[0]=5;
-    	force[1]=0;
-    	force[2]=0;
+        if (std::isnan(rForce[d]) || fabs(rForce[d]) > DBL_MAX)
+        {
+            EXCEPTION("The egg laying force must be finite.");
+        }
+    }
+    mForce = rForce;
+}
 
-    	 c_vector<double,SPACE_DIM> cell_location = rCellPopulation.GetLocationOfCellCentre(*cell_iter);
-    	 Node<SPACE_DIM>* cell_centre_node = rCellPopulation.GetNode(rCellPopulation.GetLocationIndexUsingCell(*cell_iter));
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+const c_vector<double, SPACE_DIM>& EggLayingForce<ELEMENT_DIM,SPACE_DIM>::rGetForce() const
+{
+    return mForce;
+}
 
-    	 if(cell_location[0]>0 && cell_location[1]<0){
-    		 cell_centre_node->AddAppliedForceContribution(force);
-    	 }
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void EggLayingForce<ELEMENT_DIM,SPACE_DIM>::SetRegion(const c_vector<double, SPACE_DIM>& rLowerCorner, const c_vector<double, SPACE_DIM>& rUpperCorner)
+{
+    for (unsigned d=0; d<SPACE_DIM; d++)
+    {
+        if (!(rLowerCorner[d] < rUpperCorner[d]))
+        {
+            EXCEPTION("The lower corner of the egg laying region must be below the upper corner in every direction.");
+        }
     }
+    mRegionLowerCorner = rLowerCorner;
+    mRegionUpperCorner = rUpperCorner;
 }
 
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+const c_vector<double, SPACE_DIM>& EggLayingForce<ELEMENT_DIM,SPACE_DIM>::rGetRegionLowerCorner() const
+{
+    return mRegionLowerCorner;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+const c_vector<double, SPACE_DIM>& EggLayingForce<ELEMENT_DIM,SPACE_DIM>::rGetRegionUpperCorner() const
+{
+    return mRegionUpperCorner;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned EggLayingForce<ELEMENT_DIM,SPACE_DIM>::GetNumNodesInRegion() const
+{
+    return mNumNodesInRegion;
+}
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 void EggLayingForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_stream& rParamsFile)
 {
+    *rParamsFile << "\t\t\t<Force>";
+    for (unsigned d=0; d<SPACE_DIM; d++)
+    {
+        *rParamsFile << mForce[d] << (d+1 < SPACE_DIM ? "," : "");
+    }
+    *rParamsFile << "</Force>\n";
+    *rParamsFile << "\t\t\t<RegionLowerCorner>";
+    for (unsigned d=0; d<SPACE_DIM; d++)
+    {
+        *rParamsFile << mRegionLowerCorner[d] << (d+1 < SPACE_DIM ? "," : "");
+    }
+    *rParamsFile << "</RegionLowerCorner>\n";
+    *rParamsFile << "\t\t\t<RegionUpperCorner>";
+    for (unsigned d=0; d<SPACE_DIM; d++)
+    {
+        *rParamsFile << mRegionUpperCorner[d] << (d+1 < SPACE_DIM ? "," : "");
+    }
+    *rParamsFile << "</RegionUpperCorner>\n";
+
     // Call method on direct parent class
     AbstractForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
 }
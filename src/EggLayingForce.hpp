@@ -39,9 +39,20 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "AbstractForce.hpp"
 
 #include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
 #include <boost/serialization/base_object.hpp>
 
-
+/**
+ * A constant force applied to every cell whose centre lies in a box-shaped region, pushing eggs along the
+ * proximal arm towards the spermatheca.
+ *
+ * The region is the open box mRegionLowerCorner < x < mRegionUpperCorner, with infinite corners for
+ * unbounded directions. By default it is x>0, y<0 (the lower straight of the arm) and the force is 5 along x.
+ *
+ * The force works over the mesh's nodes directly, rather than looking up each cell's node through the
+ * population, and tests each node against the box without branching on each coordinate. Every node moves every
+ * timestep, so each is tested once per call; no membership is cached between calls.
+ */
 template<unsigned  ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
 class EggLayingForce : public AbstractForce<ELEMENT_DIM, SPACE_DIM>
 {
@@ -61,9 +72,26 @@ private:
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        // Older archives keep the constructor's defaults, which are the force and region that were fixed then
+        if (version > 0)
+        {
+            archive & mForce;
+            archive & mRegionLowerCorner;
+            archive & mRegionUpperCorner;
+        }
     }
 
+    /** The force applied to each node in the region. */
+    c_vector<double, SPACE_DIM> mForce;
+
+    /** The lower corner of the region. */
+    c_vector<double, SPACE_DIM> mRegionLowerCorner;
 
+    /** The upper corner of the region. */
+    c_vector<double, SPACE_DIM> mRegionUpperCorner;
+
+    /** The number of nodes the force was applied to in the last call to AddForceContribution(). Not archived. */
+    unsigned mNumNodesInRegion;
 
 public:
 
@@ -77,21 +105,51 @@ public:
      */
     virtual ~EggLayingForce();
 
-
     /**
-     * Overridden CalculateForceBetweenNodes() method.
+     * Overridden AddForceContribution() method.
      *
-     * Calculates the force between two nodes.
+     * Adds mForce to each node in the region.
      *
-     * Note that this assumes they are connected and is called by AddForceContribution()
-     *
-     * @param nodeAGlobalIndex index of one neighbouring node
-     * @param nodeBGlobalIndex index of the other neighbouring node
      * @param rCellPopulation the cell population
-     * @return The force exerted on Node A by Node B.
      */
     void AddForceContribution(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
 
+    /**
+     * Set mForce.
+     *
+     * @param rForce the force applied to each node in the region
+     */
+    void SetForce(const c_vector<double, SPACE_DIM>& rForce);
+
+    /**
+     * @return mForce
+     */
+    const c_vector<double, SPACE_DIM>& rGetForce() const;
+
+    /**
+     * Set the region. Each lower corner coordinate must be below the corresponding upper one; use -DBL_MAX or
+     * DBL_MAX for unbounded directions.
+     *
+     * @param rLowerCorner the lower corner of the region
+     * @param rUpperCorner the upper corner of the region
+     */
+    void SetRegion(const c_vector<double, SPACE_DIM>& rLowerCorner, const c_vector<double, SPACE_DIM>& rUpperCorner);
+
+    /**
+     * @return mRegionLowerCorner
+     */
+    const c_vector<double, SPACE_DIM>& rGetRegionLowerCorner() const;
+
+    /**
+     * @return mRegionUpperCorner
+     */
+    const c_vector<double, SPACE_DIM>& rGetRegionUpperCorner() const;
+
+    /**
+     * @return the number of nodes the force was applied to in the last call to AddForceContribution().
+     */
+    unsigned GetNumNodesInRegion() const;
+
     /**
      * Overridden OutputForceParameters() method.
      *
@@ -100,6 +158,19 @@ public:
     virtual void OutputForceParameters(out_stream& rParamsFile);
 };
 
+// Version 1 archives the force and region, which were fixed before.
+namespace boost
+{
+namespace serialization
+{
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+struct version<EggLayingForce<ELEMENT_DIM, SPACE_DIM> >
+{
+    CHASTE_VERSION_CONTENT(1);
+};
+} // namespace serialization
+} // namespace boost
+
 #include "SerializationExportWrapper.hpp"
 EXPORT_TEMPLATE_CLASS_ALL_DIMS(EggLayingForce)
 
@@ -0,0 +1,130 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ForceLawTable.hpp"
+#include "Exception.hpp"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+ForceLawTable::ForceLawTable(unsigned numIntervalsPerUnit,
+                             bool useCubicInterpolation,
+                             double alpha,
+                             double minOverlap,
+                             double maxOverlap)
+    : mAlpha(alpha),
+      mUseCubicInterpolation(useCubicInterpolation)
+{
+    if (numIntervalsPerUnit == 0)
+    {
+        EXCEPTION("The force law table needs at least one interval per unit overlap.");
+    }
+    if (minOverlap <= -1.0 || minOverlap >= 0.0 || maxOverlap <= 0.0)
+    {
+        EXCEPTION("The force law table range must lie above -1 and include 0.");
+    }
+
+    mSpacing = 1.0/numIntervalsPerUnit;
+    mInverseSpacing = numIntervalsPerUnit;
+
+    // Whole numbers of intervals either side of zero, so that zero is a tabulated point
+    unsigned num_below = (unsigned)floor(-minOverlap*numIntervalsPerUnit + 1e-9);
+    unsigned num_above = (unsigned)ceil(maxOverlap*numIntervalsPerUnit - 1e-9);
+    if (num_below == 0)
+    {
+        EXCEPTION("The force law table is too coarse for its range.");
+    }
+    mMinOverlap = -(double)num_below*mSpacing;
+    mMaxOverlap = (double)num_above*mSpacing;
+
+    unsigned num_points = num_below + num_above + 1;
+    mValues.resize(num_points);
+    mScaledDerivatives.resize(num_points);
+    for (unsigned i=0; i<num_points; i++)
+    {
+        double x = ((double)i - (double)num_below)*mSpacing;
+        mValues[i] = CalculateExactly(x, mAlpha);
+
+        // The derivative is 1 from both sides at x=0
+        double derivative = (x <= 0.0) ? 1.0/(1.0 + x) : (1.0 - mAlpha*x)*exp(-mAlpha*x);
+        mScaledDerivatives[i] = derivative*mSpacing;
+    }
+}
+
+double ForceLawTable::CalculateExactly(double normalisedOverlap, double alpha)
+{
+    assert(normalisedOverlap > -1.0);
+    if (normalisedOverlap <= 0.0)
+    {
+        return log(1.0 + normalisedOverlap);
+    }
+    return normalisedOverlap*exp(-alpha*normalisedOverlap);
+}
+
+double ForceLawTable::GetMinOverlap() const
+{
+    return mMinOverlap;
+}
+
+double ForceLawTable::GetMaxOverlap() const
+{
+    return mMaxOverlap;
+}
+
+double ForceLawTable::GetSpacing() const
+{
+    return mSpacing;
+}
+
+bool ForceLawTable::GetUseCubicInterpolation() const
+{
+    return mUseCubicInterpolation;
+}
+
+double ForceLawTable::GetErrorBound() const
+{
+    // On the compressed side |g''| = 1/(1+x)^2 and |g''''| = 6/(1+x)^4, largest at the smallest x. On the
+    // stretched side g'' = alpha(alpha x - 2)exp(-alpha x) and g'''' = alpha^3(alpha x - 4)exp(-alpha x), whose
+    // magnitudes are largest at x=0.
+    double one_plus_min = 1.0 + mMinOverlap;
+    double h = mSpacing;
+    if (mUseCubicInterpolation)
+    {
+        double max_fourth_derivative = std::max(6.0/pow(one_plus_min, 4), 4.0*pow(mAlpha, 3));
+        return pow(h, 4)*max_fourth_derivative/384.0;
+    }
+    double max_second_derivative = std::max(1.0/(one_plus_min*one_plus_min), 2.0*mAlpha);
+    return h*h*max_second_derivative/8.0;
+}
@@ -0,0 +1,162 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef FORCELAWTABLE_HPP_
+#define FORCELAWTABLE_HPP_
+
+#include <vector>
+
+/**
+ * A lookup table for the shape of the GeneralisedLinearSpringForce law used by RepulsionForceMassCorrected.
+ *
+ * For a contact with rest length L (the sum of the radii), overlap o and stiffness k, the force magnitude is
+ * k*L*g(x) with x = o/L the normalised overlap and
+ *
+ *     g(x) = log(1+x)        for x <= 0 (compressed),
+ *     g(x) = x*exp(-alpha*x) for x > 0  (stretched, for dying cells whose rest length has shrunk).
+ *
+ * As the radii only enter through L, one table in x serves every pair of radii. The table holds g and its
+ * derivative at evenly spaced x, with a point at x=0 where the second derivative jumps, and interpolates
+ * linearly or by cubic Hermite interpolation. Outside the tabulated range (in particular close to x=-1, where
+ * the log is singular) g is evaluated exactly.
+ */
+class ForceLawTable
+{
+private:
+
+    /** The decay constant of the stretched branch. */
+    double mAlpha;
+
+    /** The smallest tabulated normalised overlap. */
+    double mMinOverlap;
+
+    /** The largest tabulated normalised overlap. */
+    double mMaxOverlap;
+
+    /** The spacing of the tabulated points. */
+    double mSpacing;
+
+    /** One over mSpacing. */
+    double mInverseSpacing;
+
+    /** Whether to use cubic Hermite rather than linear interpolation. */
+    bool mUseCubicInterpolation;
+
+    /** g at each tabulated point. */
+    std::vector<double> mValues;
+
+    /** The derivative of g at each tabulated point, times the spacing. */
+    std::vector<double> mScaledDerivatives;
+
+public:
+
+    /**
+     * Constructor. Builds the table.
+     *
+     * @param numIntervalsPerUnit the number of table intervals per unit of normalised overlap
+     * @param useCubicInterpolation whether to use cubic Hermite rather than linear interpolation
+     * @param alpha the decay constant of the stretched branch (defaults to 5, as in GeneralisedLinearSpringForce)
+     * @param minOverlap the smallest normalised overlap to tabulate (defaults to -0.9)
+     * @param maxOverlap the largest normalised overlap to tabulate (defaults to 1)
+     *
+     * The range is shrunk at the compressed end and stretched at the other to the nearest multiples of the spacing.
+     */
+    ForceLawTable(unsigned numIntervalsPerUnit,
+                  bool useCubicInterpolation,
+                  double alpha=5.0,
+                  double minOverlap=-0.9,
+                  double maxOverlap=1.0);
+
+    /**
+     * @return g(x), evaluated exactly.
+     *
+     * @param normalisedOverlap the normalised overlap x, which must be greater than -1
+     * @param alpha the decay constant of the stretched branch
+     */
+    static double CalculateExactly(double normalisedOverlap, double alpha);
+
+    /**
+     * @return g(x), interpolated from the table if x is in range and evaluated exactly otherwise.
+     *
+     * @param normalisedOverlap the normalised overlap x, which must be greater than -1
+     */
+    inline double Calculate(double normalisedOverlap) const
+    {
+        double position = (normalisedOverlap - mMinOverlap)*mInverseSpacing;
+        int interval = (int)position;
+        if (position < 0.0 || interval >= (int)mValues.size() - 1)
+        {
+            // Includes x equal to the largest tabulated overlap, which is cheap to get exactly
+            return CalculateExactly(normalisedOverlap, mAlpha);
+        }
+
+        double t = position - interval;
+        double value_0 = mValues[interval];
+        double value_1 = mValues[interval+1];
+        if (!mUseCubicInterpolation)
+        {
+            return value_0 + t*(value_1 - value_0);
+        }
+
+        // Cubic Hermite basis functions on the interval
+        double t_squared = t*t;
+        double t_cubed = t_squared*t;
+        return (2.0*t_cubed - 3.0*t_squared + 1.0)*value_0
+             + (t_cubed - 2.0*t_squared + t)*mScaledDerivatives[interval]
+             + (-2.0*t_cubed + 3.0*t_squared)*value_1
+             + (t_cubed - t_squared)*mScaledDerivatives[interval+1];
+    }
+
+    /** @return the smallest tabulated normalised overlap. */
+    double GetMinOverlap() const;
+
+    /** @return the largest tabulated normalised overlap. */
+    double GetMaxOverlap() const;
+
+    /** @return the spacing of the tabulated points. */
+    double GetSpacing() const;
+
+    /** @return whether the table uses cubic Hermite interpolation. */
+    bool GetUseCubicInterpolation() const;
+
+    /**
+     * @return a bound on the absolute interpolation error in g over the tabulated range, from the standard
+     * remainder terms h^2/8 max|g''| (linear) and h^4/384 max|g''''| (cubic Hermite), where h is the spacing.
+     * The derivatives of g are largest at the compressed end of the table.
+     */
+    double GetErrorBound() const;
+};
+
+#endif /*FORCELAWTABLE_HPP_*/
@@ -0,0 +1,215 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GonadArmGeometryModifier.hpp"
+#include "StatechartCellCycleModelSerializable.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+GonadArmGeometryModifier<DIM>::GonadArmGeometryModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mUpdateInterval(1),
+      mWriteCellData(false)
+{
+}
+
+template<unsigned DIM>
+GonadArmGeometryModifier<DIM>::~GonadArmGeometryModifier()
+{
+}
+
+template<unsigned DIM>
+AbstractGonadArmGeometryProvider<DIM>* GonadArmGeometryModifier<DIM>::GetGeometry()
+{
+    AbstractGonadArmGeometryProvider<DIM>* p_geometry = dynamic_cast<AbstractGonadArmGeometryProvider<DIM>*>(mpBoundaryCondition.get());
+    if (p_geometry == NULL)
+    {
+        EXCEPTION("A GonadArmGeometryModifier needs a boundary condition that provides the gonad arm geometry.");
+    }
+    return p_geometry;
+}
+
+template<unsigned DIM>
+void GonadArmGeometryModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (SimulationTime::Instance()->GetTimeStepsElapsed()%mUpdateInterval == 0)
+    {
+        UpdateGeometry(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void GonadArmGeometryModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    // Registered again here, as the boundary condition does not archive it
+    GetGeometry()->SetRecordedByModifier(true);
+    UpdateGeometry(rCellPopulation);
+}
+
+template<unsigned DIM>
+void GonadArmGeometryModifier<DIM>::UpdateGeometry(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    const AbstractGonadArmGeometryProvider<DIM>* p_geometry = GetGeometry();
+
+    // Gather every cell's node and location
+    mCells.clear();
+    mNodeIndices.clear();
+    mLocations.clear();
+    unsigned max_node_index = 0;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        unsigned node_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        mCells.push_back(*cell_iter);
+        mNodeIndices.push_back(node_index);
+        mLocations.push_back(rCellPopulation.GetNode(node_index)->rGetLocation());
+        max_node_index = std::max(max_node_index, node_index);
+    }
+    if (mCells.empty())
+    {
+        return;
+    }
+
+    // Project them in one batch onto the part of the centreline grown so far
+    double tip_arc_length = p_geometry->GetDistalTipArcLength();
+    p_geometry->rGetCentreline().ProjectAll(mLocations, mClosestPoints, mCellArcLengths, mDistances, tip_arc_length);
+
+    if (mArcLengths.size() <= max_node_index)
+    {
+        mArcLengths.resize(max_node_index+1, 0.0);
+        mDistancesAwayFromDTC.resize(max_node_index+1, 0.0);
+        mMaxRadii.resize(max_node_index+1, -1.0);
+    }
+
+    for (unsigned i=0; i<mCells.size(); i++)
+    {
+        unsigned node_index = mNodeIndices[i];
+        double arc_length = mCellArcLengths[i];
+        double distance_away_from_dtc = tip_arc_length - arc_length;
+        double max_radius = p_geometry->GetMaxCellRadius(arc_length);
+        mArcLengths[node_index] = arc_length;
+        mDistancesAwayFromDTC[node_index] = distance_away_from_dtc;
+        mMaxRadii[node_index] = max_radius;
+
+        StatechartCellCycleModelSerializable* p_model = dynamic_cast<StatechartCellCycleModelSerializable*>(mCells[i]->GetCellCycleModel());
+        if (p_model != NULL)
+        {
+            p_model->SetDistanceAwayFromDTC(distance_away_from_dtc);
+            if (max_radius >= 0.0)
+            {
+                p_model->SetMaxRadius(max_radius);
+            }
+        }
+
+        if (mWriteCellData)
+        {
+            mCells[i]->GetCellData()->SetItem("DistanceAwayFromDTC", distance_away_from_dtc);
+            if (max_radius >= 0.0)
+            {
+                mCells[i]->GetCellData()->SetItem("MaxRadius", max_radius);
+            }
+        }
+    }
+}
+
+template<unsigned DIM>
+void GonadArmGeometryModifier<DIM>::SetBoundaryCondition(boost::shared_ptr<AbstractCellPopulationBoundaryCondition<DIM,DIM> > pBoundaryCondition)
+{
+    mpBoundaryCondition = pBoundaryCondition;
+    GetGeometry()->SetRecordedByModifier(true);
+}
+
+template<unsigned DIM>
+void GonadArmGeometryModifier<DIM>::SetUpdateInterval(unsigned updateInterval)
+{
+    if (updateInterval == 0)
+    {
+        EXCEPTION("The update interval must be at least one timestep");
+    }
+    mUpdateInterval = updateInterval;
+}
+
+template<unsigned DIM>
+unsigned GonadArmGeometryModifier<DIM>::GetUpdateInterval()
+{
+    return mUpdateInterval;
+}
+
+template<unsigned DIM>
+void GonadArmGeometryModifier<DIM>::SetWriteCellData(bool writeCellData)
+{
+    mWriteCellData = writeCellData;
+}
+
+template<unsigned DIM>
+bool GonadArmGeometryModifier<DIM>::GetWriteCellData()
+{
+    return mWriteCellData;
+}
+
+template<unsigned DIM>
+double GonadArmGeometryModifier<DIM>::GetArcLength(unsigned nodeIndex) const
+{
+    assert(nodeIndex < mArcLengths.size());
+    return mArcLengths[nodeIndex];
+}
+
+template<unsigned DIM>
+double GonadArmGeometryModifier<DIM>::GetDistanceAwayFromDTC(unsigned nodeIndex) const
+{
+    assert(nodeIndex < mDistancesAwayFromDTC.size());
+    return mDistancesAwayFromDTC[nodeIndex];
+}
+
+template<unsigned DIM>
+double GonadArmGeometryModifier<DIM>::GetMaxRadius(unsigned nodeIndex) const
+{
+    assert(nodeIndex < mMaxRadii.size());
+    return mMaxRadii[nodeIndex];
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class GonadArmGeometryModifier<1>;
+template class GonadArmGeometryModifier<2>;
+template class GonadArmGeometryModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GonadArmGeometryModifier)
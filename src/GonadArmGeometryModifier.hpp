@@ -0,0 +1,202 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GONADARMGEOMETRYMODIFIER_HPP_
+#define GONADARMGEOMETRYMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "AbstractCellPopulationBoundaryCondition.hpp"
+#include "AbstractGonadArmGeometryProvider.hpp"
+
+/**
+ * A modifier class which every few timesteps works out where each cell is along the gonad arm defined by a
+ * boundary condition (one implementing AbstractGonadArmGeometryProvider), so that the boundary condition
+ * itself need only confine cells.
+ *
+ * All cells are projected onto the arm's centreline in one batch. The results are kept in arrays indexed by
+ * node index: the arc length of each cell's closest centreline point, its distance from the distal tip
+ * (DistanceAwayFromDTC) and the largest radius it may grow to there (MaxRadius). They are also passed to each
+ * cell's StatechartCellCycleModelSerializable, where the statechart reads them without a string lookup, and
+ * optionally written to cell data as well, for output or for code that reads the cell data items. The boundary
+ * condition is told the modifier records the geometry, so it stops writing the cell data items itself.
+ */
+template<unsigned DIM>
+class GonadArmGeometryModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mpBoundaryCondition;
+        archive & mUpdateInterval;
+        archive & mWriteCellData;
+    }
+
+    /** The boundary condition defining the arm. Must implement AbstractGonadArmGeometryProvider. */
+    boost::shared_ptr<AbstractCellPopulationBoundaryCondition<DIM,DIM> > mpBoundaryCondition;
+
+    /** The number of timesteps between updates. Defaults to 1. */
+    unsigned mUpdateInterval;
+
+    /** Whether to write the values to cell data as well. Defaults to false. */
+    bool mWriteCellData;
+
+    /** The arc length of each node's closest point on the centreline, indexed by node index. */
+    std::vector<double> mArcLengths;
+
+    /** Each node's distance from the distal tip along the arm, indexed by node index. */
+    std::vector<double> mDistancesAwayFromDTC;
+
+    /** The largest radius each node's cell may grow to, indexed by node index; negative if not limited. */
+    std::vector<double> mMaxRadii;
+
+    /*
+     * Work space for UpdateGeometry(): each cell, its node index and location, and its closest point on the
+     * centreline and the distance to it.
+     */
+    std::vector<CellPtr> mCells;
+    std::vector<unsigned> mNodeIndices;
+    std::vector<c_vector<double, DIM> > mLocations;
+    std::vector<c_vector<double, DIM> > mClosestPoints;
+    std::vector<double> mDistances;
+    std::vector<double> mCellArcLengths;
+
+    /**
+     * @return the boundary condition as a geometry provider.
+     */
+    AbstractGonadArmGeometryProvider<DIM>* GetGeometry();
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    GonadArmGeometryModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~GonadArmGeometryModifier();
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method
+     *
+     * Updates the geometry if mUpdateInterval timesteps have passed since the last update.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overriden SetupSolve method
+     *
+     * Registers with the boundary condition and updates the geometry before the start of the time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Project every cell onto the arm's centreline and record the results.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateGeometry(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Set the boundary condition defining the arm.
+     *
+     * @param pBoundaryCondition the boundary condition, which must implement AbstractGonadArmGeometryProvider
+     */
+    void SetBoundaryCondition(boost::shared_ptr<AbstractCellPopulationBoundaryCondition<DIM,DIM> > pBoundaryCondition);
+
+    /**
+     * Set mUpdateInterval.
+     *
+     * @param updateInterval the new value of mUpdateInterval, in timesteps
+     */
+    void SetUpdateInterval(unsigned updateInterval);
+
+    /**
+     * @return mUpdateInterval
+     */
+    unsigned GetUpdateInterval();
+
+    /**
+     * Set mWriteCellData.
+     *
+     * @param writeCellData whether to write the values to cell data as well
+     */
+    void SetWriteCellData(bool writeCellData);
+
+    /**
+     * @return mWriteCellData
+     */
+    bool GetWriteCellData();
+
+    /**
+     * @return the arc length of a node's closest point on the centreline at the last update.
+     *
+     * @param nodeIndex the node index
+     */
+    double GetArcLength(unsigned nodeIndex) const;
+
+    /**
+     * @return a node's distance from the distal tip at the last update.
+     *
+     * @param nodeIndex the node index
+     */
+    double GetDistanceAwayFromDTC(unsigned nodeIndex) const;
+
+    /**
+     * @return the largest radius a node's cell could grow to at the last update, or a negative value if the
+     * arm does not limit cell radii.
+     *
+     * @param nodeIndex the node index
+     */
+    double GetMaxRadius(unsigned nodeIndex) const;
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GonadArmGeometryModifier)
+
+#endif /*GONADARMGEOMETRYMODIFIER_HPP_*/
@@ -35,6 +35,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "GonadArmPositionTrackerModifier.hpp"
 #include "MeshBasedCellPopulation.hpp"
+#include "StatechartCellCycleModelSerializable.hpp"
 
 template<unsigned DIM>
 GonadArmPositionTrackerModifier<DIM>::GonadArmPositionTrackerModifier()
@@ -62,7 +63,9 @@ void GonadArmPositionTrackerModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPop
     {
 
     	double id = cell_iter->GetCellId();
-    	double position = cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC");
+    	// Read the position recorded by the GonadArmGeometryModifier, if the cell can hold it
+    	StatechartCellCycleModelSerializable* p_model = dynamic_cast<StatechartCellCycleModelSerializable*>(cell_iter->GetCellCycleModel());
+    	double position = (p_model != NULL) ? p_model->GetDistanceAwayFromDTC() : cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC");
     	double prolif = cell_iter->GetCellData()->GetItem("Proliferating");
 
     	fprintf(OutputPositionFile,"%e\t",SimulationTime::Instance()->GetTime());
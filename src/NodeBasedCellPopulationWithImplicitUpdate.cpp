@@ -0,0 +1,245 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "NodeBasedCellPopulationWithImplicitUpdate.hpp"
+#include "UblasCustomFunctions.hpp"
+#include "Warnings.hpp"
+#include <climits>
+
+template<unsigned DIM>
+NodeBasedCellPopulationWithImplicitUpdate<DIM>::NodeBasedCellPopulationWithImplicitUpdate(NodesOnlyMesh<DIM>& rMesh,
+                                                                                        std::vector<CellPtr>& rCells,
+                                                                                        const std::vector<unsigned> locationIndices,
+                                                                                        bool deleteMesh)
+    : NodeBasedCellPopulation<DIM>(rMesh, rCells, locationIndices, deleteMesh),
+      mMaxIterations(100),
+      mTolerance(1e-6),
+      mNumIterationsLastUpdate(0),
+      mNumUpdatesNotConverged(0)
+{
+}
+
+template<unsigned DIM>
+NodeBasedCellPopulationWithImplicitUpdate<DIM>::NodeBasedCellPopulationWithImplicitUpdate(NodesOnlyMesh<DIM>& rMesh)
+    : NodeBasedCellPopulation<DIM>(rMesh),
+      mMaxIterations(100),
+      mTolerance(1e-6),
+      mNumIterationsLastUpdate(0),
+      mNumUpdatesNotConverged(0)
+{
+}
+
+template<unsigned DIM>
+void NodeBasedCellPopulationWithImplicitUpdate<DIM>::UpdateNodeLocations(double dt)
+{
+    if (!mpImplicitForce)
+    {
+        NodeBasedCellPopulation<DIM>::UpdateNodeLocations(dt);
+        return;
+    }
+
+    // Give each node a row, starting from the diagonal damping term and the applied force
+    mRowOfIndex.clear();
+    mRowNodes.clear();
+    mRowMassCorrections.clear();
+    mRowInverseBlocks.clear();
+    mRowForces.clear();
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = this->rGetMesh().GetNodeIteratorBegin();
+         node_iter != this->rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        unsigned node_index = node_iter->GetIndex();
+        if (node_index >= mRowOfIndex.size())
+        {
+            mRowOfIndex.resize(node_index+1, UINT_MAX);
+        }
+        mRowOfIndex[node_index] = mRowNodes.size();
+
+        double damping_const = this->GetDampingConstant(node_index);
+        mRowNodes.push_back(&(*node_iter));
+        mRowMassCorrections.push_back(mpImplicitForce->GetMassCorrection(node_iter->GetRadius()));
+        mRowInverseBlocks.push_back(identity_matrix<double>(DIM)*damping_const/dt);
+        mRowForces.push_back(node_iter->rGetAppliedForce());
+    }
+    unsigned num_rows = mRowNodes.size();
+
+    // Each contact adds c*k*n*n^T to the diagonal blocks of its two nodes, and couples them through the same term
+    mpImplicitForce->GetContactLinearisation(mContactNodesA, mContactNodesB, mContactUnitVectors, mContactStiffnesses);
+    unsigned num_contacts = mContactNodesA.size();
+    for (unsigned contact=0; contact<num_contacts; contact++)
+    {
+        unsigned row_a = mRowOfIndex[mContactNodesA[contact]->GetIndex()];
+        unsigned row_b = mRowOfIndex[mContactNodesB[contact]->GetIndex()];
+        c_matrix<double, DIM, DIM> coupling = mContactStiffnesses[contact]*outer_prod(mContactUnitVectors[contact], mContactUnitVectors[contact]);
+        mRowInverseBlocks[row_a] += mRowMassCorrections[row_a]*coupling;
+        mRowInverseBlocks[row_b] += mRowMassCorrections[row_b]*coupling;
+    }
+    for (unsigned row=0; row<num_rows; row++)
+    {
+        mRowInverseBlocks[row] = Inverse(mRowInverseBlocks[row]);
+    }
+
+    /*
+     * Block Jacobi iteration from zero displacement. The first iterate is the applied force damped by the full
+     * diagonal block, which is never larger than the explicit step, and each later one adds the neighbours'
+     * latest displacements; with the diagonal blocks dominant every iterate stays bounded, however large dt is.
+     */
+    mRowDisplacements.assign(num_rows, zero_vector<double>(DIM));
+    mNumIterationsLastUpdate = 0;
+    bool converged = false;
+    for (unsigned iteration=0; iteration<mMaxIterations; iteration++)
+    {
+        mRowRightHandSides = mRowForces;
+        for (unsigned contact=0; contact<num_contacts; contact++)
+        {
+            unsigned row_a = mRowOfIndex[mContactNodesA[contact]->GetIndex()];
+            unsigned row_b = mRowOfIndex[mContactNodesB[contact]->GetIndex()];
+            const c_vector<double, DIM>& r_unit_vector = mContactUnitVectors[contact];
+            double stiffness = mContactStiffnesses[contact];
+
+            mRowRightHandSides[row_a] += mRowMassCorrections[row_a]*stiffness*inner_prod(r_unit_vector, mRowDisplacements[row_b])*r_unit_vector;
+            mRowRightHandSides[row_b] += mRowMassCorrections[row_b]*stiffness*inner_prod(r_unit_vector, mRowDisplacements[row_a])*r_unit_vector;
+        }
+
+        double max_change = 0.0;
+        for (unsigned row=0; row<num_rows; row++)
+        {
+            c_vector<double, DIM> new_displacement = prod(mRowInverseBlocks[row], mRowRightHandSides[row]);
+            max_change = std::max(max_change, norm_2(new_displacement - mRowDisplacements[row]));
+            mRowDisplacements[row] = new_displacement;
+        }
+        mNumIterationsLastUpdate++;
+
+        if (max_change < mTolerance)
+        {
+            converged = true;
+            break;
+        }
+    }
+    if (!converged)
+    {
+        mNumUpdatesNotConverged++;
+        WARN_ONCE_ONLY("The implicit node update did not converge within the maximum number of iterations: use SetMaxIterations() to allow more, or a smaller timestep.");
+    }
+
+    // Move the nodes, with the same check on large movements as the explicit update
+    for (unsigned row=0; row<num_rows; row++)
+    {
+        double displacement_size = norm_2(mRowDisplacements[row]);
+        if (displacement_size > this->GetAbsoluteMovementThreshold())
+        {
+            EXCEPTION("Cells are moving by: " << displacement_size << ", which is more than the AbsoluteMovementThreshold: use a smaller timestep to avoid this exception.");
+        }
+
+        c_vector<double, DIM> new_node_location = mRowNodes[row]->rGetLocation() + mRowDisplacements[row];
+        ChastePoint<DIM> new_point(new_node_location);
+        this->SetNode(mRowNodes[row]->GetIndex(), new_point);
+    }
+}
+
+template<unsigned DIM>
+void NodeBasedCellPopulationWithImplicitUpdate<DIM>::SetImplicitForce(boost::shared_ptr<RepulsionForceMassCorrected<DIM> > pForce)
+{
+    mpImplicitForce = pForce;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<RepulsionForceMassCorrected<DIM> > NodeBasedCellPopulationWithImplicitUpdate<DIM>::GetImplicitForce()
+{
+    return mpImplicitForce;
+}
+
+template<unsigned DIM>
+void NodeBasedCellPopulationWithImplicitUpdate<DIM>::SetMaxIterations(unsigned maxIterations)
+{
+    if (maxIterations == 0)
+    {
+        EXCEPTION("At least one iteration is needed");
+    }
+    mMaxIterations = maxIterations;
+}
+
+template<unsigned DIM>
+unsigned NodeBasedCellPopulationWithImplicitUpdate<DIM>::GetMaxIterations()
+{
+    return mMaxIterations;
+}
+
+template<unsigned DIM>
+void NodeBasedCellPopulationWithImplicitUpdate<DIM>::SetTolerance(double tolerance)
+{
+    assert(tolerance >= 0.0);
+    mTolerance = tolerance;
+}
+
+template<unsigned DIM>
+double NodeBasedCellPopulationWithImplicitUpdate<DIM>::GetTolerance()
+{
+    return mTolerance;
+}
+
+template<unsigned DIM>
+unsigned NodeBasedCellPopulationWithImplicitUpdate<DIM>::GetNumIterationsLastUpdate()
+{
+    return mNumIterationsLastUpdate;
+}
+
+template<unsigned DIM>
+unsigned NodeBasedCellPopulationWithImplicitUpdate<DIM>::GetNumUpdatesNotConverged()
+{
+    return mNumUpdatesNotConverged;
+}
+
+template<unsigned DIM>
+void NodeBasedCellPopulationWithImplicitUpdate<DIM>::OutputCellPopulationParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t<MaxIterations>" << mMaxIterations << "</MaxIterations>\n";
+    *rParamsFile << "\t\t<Tolerance>" << mTolerance << "</Tolerance>\n";
+
+    // Call method on direct parent class
+    NodeBasedCellPopulation<DIM>::OutputCellPopulationParameters(rParamsFile);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class NodeBasedCellPopulationWithImplicitUpdate<1>;
+template class NodeBasedCellPopulationWithImplicitUpdate<2>;
+template class NodeBasedCellPopulationWithImplicitUpdate<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(NodeBasedCellPopulationWithImplicitUpdate)
@@ -0,0 +1,263 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef NODEBASEDCELLPOPULATIONWITHIMPLICITUPDATE_HPP_
+#define NODEBASEDCELLPOPULATIONWITHIMPLICITUPDATE_HPP_
+
+#include "NodeBasedCellPopulation.hpp"
+#include "RepulsionForceMassCorrected.hpp"
+
+#include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * A NodeBasedCellPopulation whose node positions are updated semi-implicitly, so that the stiff repulsion
+ * between small, overlapping cells doesn't limit the timestep.
+ *
+ * With a RepulsionForceMassCorrected set, each update solves the linearised backward Euler equations
+ *
+ *     (damping_i/dt) dx_i + c_i sum_j k_ij n_ij n_ij^T (dx_i - dx_j) = F_i
+ *
+ * where F_i is the node's applied force (from every force, evaluated at the start of the step), c_i the
+ * repulsion force's mass correction for node i, and k_ij and n_ij the stiffness and unit vector of each
+ * contact taken from the force. Only the repulsion is treated implicitly; any other forces enter through F_i.
+ * The system is solved by block Jacobi iteration, each node's DIMxDIM diagonal block being inverted exactly.
+ * An update that reaches the maximum number of iterations without converging is counted, and warned about once.
+ * Without a force set the update is the usual explicit one.
+ */
+template<unsigned DIM>
+class NodeBasedCellPopulationWithImplicitUpdate : public NodeBasedCellPopulation<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<NodeBasedCellPopulation<DIM> >(*this);
+        archive & mMaxIterations;
+        archive & mTolerance;
+        if (version > 0)
+        {
+            archive & mpImplicitForce;
+        }
+    }
+
+    /**
+     * The repulsion force to treat implicitly. Archived through its shared pointer, so that after loading a
+     * simulation it is the same object as the force in the simulation's force collection.
+     */
+    boost::shared_ptr<RepulsionForceMassCorrected<DIM> > mpImplicitForce;
+
+    /**
+     * The most block Jacobi iterations per update. Defaults to 100: each iteration typically reduces the error
+     * by a factor of 0.6-0.8 for tightly packed cells at ten times the explicit timestep, so a few dozen are
+     * needed from rest.
+     */
+    unsigned mMaxIterations;
+
+    /** Iteration stops once no node's displacement changes by more than this. Defaults to 1e-6. */
+    double mTolerance;
+
+    /** The number of iterations taken by the last update. Not archived. */
+    unsigned mNumIterationsLastUpdate;
+
+    /** The number of updates that stopped at mMaxIterations before reaching mTolerance. Not archived. */
+    unsigned mNumUpdatesNotConverged;
+
+    /** Work space for the contacts given by mpImplicitForce. */
+    std::vector<Node<DIM>*> mContactNodesA;
+    std::vector<Node<DIM>*> mContactNodesB;
+    std::vector<c_vector<double, DIM> > mContactUnitVectors;
+    std::vector<double> mContactStiffnesses;
+
+    /** Work space for the rows of the linear system: one per node, indexed through mRowOfIndex by node index. */
+    std::vector<unsigned> mRowOfIndex;
+    std::vector<Node<DIM>*> mRowNodes;
+    std::vector<double> mRowMassCorrections;
+    std::vector<c_matrix<double, DIM, DIM> > mRowInverseBlocks;
+    std::vector<c_vector<double, DIM> > mRowForces;
+    std::vector<c_vector<double, DIM> > mRowDisplacements;
+    std::vector<c_vector<double, DIM> > mRowRightHandSides;
+
+public:
+
+    /**
+     * Default constructor.
+     *
+     * Note that the cell population will take responsibility for freeing the memory used by the nodes.
+     *
+     * @param rMesh a mutable nodes-only mesh
+     * @param rCells a vector of cells
+     * @param locationIndices an optional vector of location indices that correspond to real cells
+     * @param deleteMesh whether to delete nodes-only mesh in destructor
+     */
+    NodeBasedCellPopulationWithImplicitUpdate(NodesOnlyMesh<DIM>& rMesh,
+                                              std::vector<CellPtr>& rCells,
+                                              const std::vector<unsigned> locationIndices=std::vector<unsigned>(),
+                                              bool deleteMesh=false);
+
+    /**
+     * Constructor for use by the de-serializer.
+     *
+     * @param rMesh a mutable nodes-only mesh
+     */
+    NodeBasedCellPopulationWithImplicitUpdate(NodesOnlyMesh<DIM>& rMesh);
+
+    /**
+     * Overridden UpdateNodeLocations() method.
+     *
+     * @param dt the time step
+     */
+    virtual void UpdateNodeLocations(double dt);
+
+    /**
+     * Set mpImplicitForce. The force must also be added to the simulation as usual.
+     *
+     * @param pForce the repulsion force to treat implicitly
+     */
+    void SetImplicitForce(boost::shared_ptr<RepulsionForceMassCorrected<DIM> > pForce);
+
+    /**
+     * @return mpImplicitForce
+     */
+    boost::shared_ptr<RepulsionForceMassCorrected<DIM> > GetImplicitForce();
+
+    /**
+     * Set mMaxIterations.
+     *
+     * @param maxIterations the new value of mMaxIterations
+     */
+    void SetMaxIterations(unsigned maxIterations);
+
+    /**
+     * @return mMaxIterations
+     */
+    unsigned GetMaxIterations();
+
+    /**
+     * Set mTolerance.
+     *
+     * @param tolerance the new value of mTolerance
+     */
+    void SetTolerance(double tolerance);
+
+    /**
+     * @return mTolerance
+     */
+    double GetTolerance();
+
+    /**
+     * @return mNumIterationsLastUpdate
+     */
+    unsigned GetNumIterationsLastUpdate();
+
+    /**
+     * @return mNumUpdatesNotConverged
+     */
+    unsigned GetNumUpdatesNotConverged();
+
+    /**
+     * Outputs CellPopulation parameters to file
+     *
+     * As this method is pure virtual, it must be overridden
+     * in subclasses.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputCellPopulationParameters(out_stream& rParamsFile);
+};
+
+// Version 1 archives the implicit force.
+namespace boost
+{
+namespace serialization
+{
+template<unsigned DIM>
+struct version<NodeBasedCellPopulationWithImplicitUpdate<DIM> >
+{
+    CHASTE_VERSION_CONTENT(1);
+};
+} // namespace serialization
+} // namespace boost
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(NodeBasedCellPopulationWithImplicitUpdate)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a NodeBasedCellPopulationWithImplicitUpdate.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const NodeBasedCellPopulationWithImplicitUpdate<DIM> * t, const BOOST_PFTO unsigned int file_version)
+{
+    // Save data required to construct instance
+    const NodesOnlyMesh<DIM>* p_mesh = &(t->rGetMesh());
+    ar & p_mesh;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a NodeBasedCellPopulationWithImplicitUpdate.
+ * Loads the mesh from separate files.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, NodeBasedCellPopulationWithImplicitUpdate<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    NodesOnlyMesh<DIM>* p_mesh;
+    ar >> p_mesh;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)NodeBasedCellPopulationWithImplicitUpdate<DIM>(*p_mesh);
+}
+}
+} // namespace ...
+
+#endif /*NODEBASEDCELLPOPULATIONWITHIMPLICITUPDATE_HPP_*/
@@ -35,73 +35,583 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "RepulsionForceMassCorrected.hpp"
 #include "IsNan.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <typeinfo>
+#include "SpaceFillingCurve.hpp"
 
 template<unsigned DIM>
 RepulsionForceMassCorrected<DIM>::RepulsionForceMassCorrected()
-   : GeneralisedLinearSpringForce<DIM>()
+   : GeneralisedLinearSpringForce<DIM>(),
+     mVerletSkin(0.0),
+     mUseSpatialReordering(true),
+     mForceLawTableResolution(0),
+     mUseCubicForceLawTable(true),
+     mNumberOfThreads(1)
 {
 }
 
 template<unsigned DIM>
-void RepulsionForceMassCorrected<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+bool RepulsionForceMassCorrected<DIM>::NeighbourListNeedsRebuilding(NodeBasedCellPopulation<DIM>& rCellPopulation)
 {
-    // Throw an exception message if not using a NodeBasedCellPopulation
-    if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation) == NULL)
+    AbstractMesh<DIM,DIM>& r_mesh = rCellPopulation.rGetMesh();
+
+    if (r_mesh.GetNumNodes() != mListNodes.size())
     {
-        EXCEPTION("RepulsionForceMassCorrected is to be used with a NodeBasedCellPopulation only");
+        return true;
+    }
+
+    double max_movement = 0.0;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        // Check this node was present at the last rebuild
+        Node<DIM>* p_node = &(*node_iter);
+        unsigned node_index = p_node->GetIndex();
+        if (node_index >= mSlotOfIndex.size() || mSlotOfIndex[node_index] == UINT_MAX
+            || mListNodes[mSlotOfIndex[node_index]] != p_node)
+        {
+            return true;
+        }
+        unsigned slot = mSlotOfIndex[node_index];
+
+        // A pair can only come into contact once the movement plus growth of its two nodes adds up to the skin
+        double displacement = norm_2(r_mesh.GetVectorFromAtoB(mReferenceLocations[slot], p_node->rGetLocation()));
+        double growth = std::max(p_node->GetRadius() - mReferenceRadii[slot], 0.0);
+        max_movement = std::max(max_movement, displacement + growth);
+
+        if (max_movement > 0.5*mVerletSkin)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::RebuildNeighbourList(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    AbstractMesh<DIM,DIM>& r_mesh = rCellPopulation.rGetMesh();
+
+    // Collect the nodes and their current locations and radii
+    std::vector<Node<DIM>*> nodes;
+    std::vector<c_vector<double, DIM> > locations;
+    double max_radius = 0.0;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        nodes.push_back(&(*node_iter));
+        locations.push_back(node_iter->rGetLocation());
+        max_radius = std::max(max_radius, node_iter->GetRadius());
+    }
+
+    // Give the nodes slots in space-filling curve order, or in mesh order
+    std::vector<unsigned> order;
+    if (mUseSpatialReordering)
+    {
+        double cube_size = (max_radius > 0.0) ? 2.0*max_radius : 1.0;
+        SpaceFillingCurve::CalculateMortonOrder<DIM>(locations, cube_size, order);
+    }
+    else
+    {
+        order.resize(nodes.size());
+        for (unsigned i=0; i<order.size(); i++)
+        {
+            order[i] = i;
+        }
     }
 
-    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = (static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation))->rGetNodePairs();
+    mListNodes.clear();
+    mReferenceLocations.clear();
+    mReferenceRadii.clear();
+    mSlotOfIndex.clear();
+    for (unsigned slot=0; slot<order.size(); slot++)
+    {
+        Node<DIM>* p_node = nodes[order[slot]];
+        unsigned node_index = p_node->GetIndex();
+        if (node_index >= mSlotOfIndex.size())
+        {
+            mSlotOfIndex.resize(node_index+1, UINT_MAX);
+        }
+        mSlotOfIndex[node_index] = slot;
 
-    for (typename std::vector< std::pair<Node<DIM>*, Node<DIM>* > >::iterator iter = r_node_pairs.begin();
-        iter != r_node_pairs.end();
-        iter++)
+        mListNodes.push_back(p_node);
+        mReferenceLocations.push_back(locations[order[slot]]);
+        mReferenceRadii.push_back(p_node->GetRadius());
+    }
+
+    // Collect candidate pairs of slots, from the spatial index or the population's node pairs
+    if (mpSpatialIndex)
+    {
+        mpSpatialIndex->CalculatePairs(mReferenceLocations, 2.0*max_radius + mVerletSkin, mIndexPairs);
+    }
+    else
     {
-        std::pair<Node<DIM>*, Node<DIM>* > pair = *iter;
+        mIndexPairs.clear();
+        std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = rCellPopulation.rGetNodePairs();
+        for (typename std::vector< std::pair<Node<DIM>*, Node<DIM>* > >::iterator iter = r_node_pairs.begin();
+            iter != r_node_pairs.end();
+            iter++)
+        {
+            assert(mSlotOfIndex[iter->first->GetIndex()] != UINT_MAX);
+            assert(mSlotOfIndex[iter->second->GetIndex()] != UINT_MAX);
+            unsigned slot_a = mSlotOfIndex[iter->first->GetIndex()];
+            unsigned slot_b = mSlotOfIndex[iter->second->GetIndex()];
+            mIndexPairs.push_back(std::make_pair(std::min(slot_a, slot_b), std::max(slot_a, slot_b)));
+        }
+    }
 
-        Node<DIM>* p_node_a = pair.first;
-        Node<DIM>* p_node_b = pair.second;
+    // Keep the pairs within rest length plus skin, visiting them in slot order
+    if (mUseSpatialReordering)
+    {
+        std::sort(mIndexPairs.begin(), mIndexPairs.end());
+    }
+    mPairSlotsA.clear();
+    mPairSlotsB.clear();
+    for (unsigned i=0; i<mIndexPairs.size(); i++)
+    {
+        unsigned slot_a = mIndexPairs[i].first;
+        unsigned slot_b = mIndexPairs[i].second;
+
+        double list_radius = mReferenceRadii[slot_a] + mReferenceRadii[slot_b] + mVerletSkin;
+        if (norm_2(r_mesh.GetVectorFromAtoB(mReferenceLocations[slot_a], mReferenceLocations[slot_b])) < list_radius)
+        {
+            mPairSlotsA.push_back(slot_a);
+            mPairSlotsB.push_back(slot_b);
+        }
+    }
+
+    // Size the kernel buffers
+    unsigned num_slots = mListNodes.size();
+    unsigned num_pairs = mPairSlotsA.size();
+    mSlotLocations.resize(DIM*num_slots);
+    mSlotRadii.resize(num_slots);
+    mSlotApoptosisFactors.resize(num_slots);
+    mSlotIsNewlyDivided.resize(num_slots);
+    mSlotForces.resize(DIM*num_slots);
+    mPairDistances.resize(num_pairs);
+    mContactPairs.reserve(num_pairs);
+    mContactFinalRestLengths.reserve(num_pairs);
+    mContactOverlaps.reserve(num_pairs);
+    mContactStiffnesses.reserve(num_pairs);
+    mContactForceMagnitudes.reserve(num_pairs);
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::GatherNodeData(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    unsigned num_slots = mListNodes.size();
+    double spring_growth_duration = this->GetMeinekeSpringGrowthDuration();
+
+    for (unsigned slot=0; slot<num_slots; slot++)
+    {
+        Node<DIM>* p_node = mListNodes[slot];
+        const c_vector<double, DIM>& r_location = p_node->rGetLocation();
+        for (unsigned d=0; d<DIM; d++)
+        {
+            mSlotLocations[d*num_slots + slot] = r_location[d];
+            mSlotForces[d*num_slots + slot] = 0.0;
+        }
+        mSlotRadii[slot] = p_node->GetRadius();
 
-        // Get the node locations
-        c_vector<double, DIM> node_a_location = p_node_a->rGetLocation();
-        c_vector<double, DIM> node_b_location =  p_node_b->rGetLocation();
+        // For apoptosis, progressively reduce the cell's half of the rest length
+        CellPtr p_cell = rCellPopulation.GetCellUsingLocationIndex(p_node->GetIndex());
+        mSlotApoptosisFactors[slot] = 1.0;
+        if (p_cell->HasApoptosisBegun())
+        {
+            mSlotApoptosisFactors[slot] = p_cell->GetTimeUntilDeath()/p_cell->GetApoptosisTime();
+        }
+        mSlotIsNewlyDivided[slot] = (p_cell->GetAge() < spring_growth_duration);
+    }
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::CalculatePairDistances()
+{
+    unsigned num_pairs = mPairSlotsA.size();
+    if (num_pairs == 0)
+    {
+        return;
+    }
+    unsigned num_slots = mListNodes.size();
+
+    const double* p_locations = &mSlotLocations[0];
+    const unsigned* p_slots_a = &mPairSlotsA[0];
+    const unsigned* p_slots_b = &mPairSlotsB[0];
+    double* p_distances = &mPairDistances[0];
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(mNumberOfThreads)
+#endif
+    for (int pair=0; pair<(int)num_pairs; pair++)
+    {
+        double distance_squared = 0.0;
+        for (unsigned d=0; d<DIM; d++)
+        {
+            double difference = p_locations[d*num_slots + p_slots_b[pair]] - p_locations[d*num_slots + p_slots_a[pair]];
+            distance_squared += difference*difference;
+        }
+        p_distances[pair] = sqrt(distance_squared);
+    }
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::FindContactPairs(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    mContactPairs.clear();
+    mContactFinalRestLengths.clear();
+    mContactOverlaps.clear();
+    mContactStiffnesses.clear();
+
+    unsigned num_pairs = mPairSlotsA.size();
+    unsigned num_slots = mListNodes.size();
+    double spring_stiffness = this->GetMeinekeSpringStiffness();
+    bool use_cutoff = this->GetUseCutOffLength();
+    double cutoff = use_cutoff ? this->GetCutOffLength() : DBL_MAX;
+
+    // This class, like GeneralisedLinearSpringForce, uses the same stiffness for every pair, so the virtual
+    // VariableSpringConstantMultiplicationFactor() is only called per contact for subclasses that may override it
+    bool use_variable_stiffness = (typeid(*this) != typeid(RepulsionForceMassCorrected<DIM>));
+
+    for (unsigned pair=0; pair<num_pairs; pair++)
+    {
+        unsigned slot_a = mPairSlotsA[pair];
+        unsigned slot_b = mPairSlotsB[pair];
+        double distance = mPairDistances[pair];
+
+        // Only cells closer than the sum of their radii repel
+        double rest_length_final = mSlotRadii[slot_a] + mSlotRadii[slot_b];
+        if (distance >= rest_length_final)
+        {
+            continue;
+        }
+
+        unsigned node_a_index = mListNodes[slot_a]->GetIndex();
+        unsigned node_b_index = mListNodes[slot_b]->GetIndex();
+
+        if (mSlotIsNewlyDivided[slot_a] && mSlotIsNewlyDivided[slot_b])
+        {
+            // The rest length of a newly divided pair depends on the population's marked springs
+            c_vector<double, DIM> force = this->CalculateForceBetweenNodes(node_a_index, node_b_index, rCellPopulation);
+            for (unsigned d=0; d<DIM; d++)
+            {
+                assert(!std::isnan(force[d]));
+                mSlotForces[d*num_slots + slot_a] += force[d]*GetMassCorrection(mSlotRadii[slot_a]);
+                mSlotForces[d*num_slots + slot_b] -= force[d]*GetMassCorrection(mSlotRadii[slot_b]);
+            }
+            continue;
+        }
+
+        if (distance >= cutoff)
+        {
+            continue;
+        }
+        assert(distance > 0);
+
+        double rest_length = 0.5*rest_length_final*(mSlotApoptosisFactors[slot_a] + mSlotApoptosisFactors[slot_b]);
+        double overlap = distance - rest_length;
+        // log(x+1) is undefined for x<=-1
+        assert(overlap > -rest_length_final);
+
+        double multiplication_factor = 1.0;
+        if (use_variable_stiffness)
+        {
+            multiplication_factor = this->VariableSpringConstantMultiplicationFactor(node_a_index, node_b_index, rCellPopulation, overlap <= 0);
+        }
+
+        mContactPairs.push_back(pair);
+        mContactFinalRestLengths.push_back(rest_length_final);
+        mContactOverlaps.push_back(overlap);
+        mContactStiffnesses.push_back(multiplication_factor*spring_stiffness);
+    }
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::CalculateForceMagnitudes()
+{
+    unsigned num_contacts = mContactPairs.size();
+    mContactForceMagnitudes.resize(num_contacts);
+    if (num_contacts == 0)
+    {
+        return;
+    }
+
+    const double* p_rest_lengths = &mContactFinalRestLengths[0];
+    const double* p_overlaps = &mContactOverlaps[0];
+    const double* p_stiffnesses = &mContactStiffnesses[0];
+    double* p_magnitudes = &mContactForceMagnitudes[0];
+
+    // The force is the stiffness times the rest length times a function of the normalised overlap, which can
+    // be read off the lookup table
+    boost::shared_ptr<ForceLawTable> p_table = GetForceLawTable();
+    if (p_table)
+    {
+        const ForceLawTable& r_table = *p_table;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(mNumberOfThreads)
+#endif
+        for (int contact=0; contact<(int)num_contacts; contact++)
+        {
+            double relative_overlap = p_overlaps[contact]/p_rest_lengths[contact];
+            p_magnitudes[contact] = p_stiffnesses[contact]*p_rest_lengths[contact]*r_table.Calculate(relative_overlap);
+        }
+        return;
+    }
 
-        // Get the node radii
-        double node_a_radius = p_node_a->GetRadius();
-        double node_b_radius = p_node_b->GetRadius();
+    // The same reasonably stable force law as GeneralisedLinearSpringForce, evaluated without branches:
+    // both sides are finite for any overlap greater than minus the rest length, so compute both and select
+    const double alpha = 5.0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(mNumberOfThreads)
+#endif
+    for (int contact=0; contact<(int)num_contacts; contact++)
+    {
+        double relative_overlap = p_overlaps[contact]/p_rest_lengths[contact];
+        double compressed = p_rest_lengths[contact]*log(1.0 + relative_overlap);
+        double stretched = p_overlaps[contact]*exp(-alpha*relative_overlap);
+        p_magnitudes[contact] = p_stiffnesses[contact]*(p_overlaps[contact] <= 0.0 ? compressed : stretched);
+    }
+}
 
-        // Get the unit vector parallel to the line joining the two nodes
-        c_vector<double, DIM> unit_difference;
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::ScatterForces()
+{
+    unsigned num_contacts = mContactPairs.size();
+    unsigned num_slots = mListNodes.size();
+    if (num_slots == 0)
+    {
+        return;
+    }
 
-        unit_difference = (static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation))->rGetMesh().GetVectorFromAtoB(node_a_location, node_b_location);
+    // With one thread, accumulate straight into the slot forces; otherwise each chunk of contacts gets its own buffer
+    unsigned num_chunks = mNumberOfThreads;
+    unsigned buffer_size = DIM*num_slots;
+    if (num_chunks > 1)
+    {
+        mChunkForces.assign(num_chunks*buffer_size, 0.0);
+    }
 
-        // Calculate the value of the rest length
-        double rest_length = node_a_radius+node_b_radius;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) num_threads(mNumberOfThreads)
+#endif
+    for (int chunk=0; chunk<(int)num_chunks; chunk++)
+    {
+        double* p_forces = (num_chunks > 1) ? &mChunkForces[chunk*buffer_size] : &mSlotForces[0];
+        unsigned first_contact = (chunk*num_contacts)/num_chunks;
+        unsigned last_contact = ((chunk+1)*num_contacts)/num_chunks;
 
-        if (norm_2(unit_difference) < rest_length)
+        for (unsigned contact=first_contact; contact<last_contact; contact++)
         {
-            // Calculate the force between nodes
-            c_vector<double, DIM> force = this->CalculateForceBetweenNodes(p_node_a->GetIndex(), p_node_b->GetIndex(), rCellPopulation);
-            c_vector<double, DIM> negative_force = -1.0 * force;
-            for (unsigned j=0; j<DIM; j++)
+            unsigned pair = mContactPairs[contact];
+            unsigned slot_a = mPairSlotsA[pair];
+            unsigned slot_b = mPairSlotsB[pair];
+
+            // Force along the unit vector from a to b, divided by each cell's cross section
+            double magnitude_over_distance = mContactForceMagnitudes[contact]/mPairDistances[pair];
+            double mass_correction_a = GetMassCorrection(mSlotRadii[slot_a]);
+            double mass_correction_b = GetMassCorrection(mSlotRadii[slot_b]);
+            for (unsigned d=0; d<DIM; d++)
             {
-                assert(!std::isnan(force[j]));
+                double force = magnitude_over_distance*(mSlotLocations[d*num_slots + slot_b] - mSlotLocations[d*num_slots + slot_a]);
+                assert(!std::isnan(force));
+                p_forces[d*num_slots + slot_a] += force*mass_correction_a;
+                p_forces[d*num_slots + slot_b] -= force*mass_correction_b;
             }
-            // Add the force contribution to each node
-            for (unsigned j=0; j<DIM; j++)
+        }
+    }
+
+    // Sum the chunk buffers in chunk order, so the result doesn't depend on thread scheduling
+    if (num_chunks > 1)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(mNumberOfThreads)
+#endif
+        for (int entry=0; entry<(int)buffer_size; entry++)
+        {
+            for (unsigned chunk=0; chunk<num_chunks; chunk++)
             {
-                force[j]=force[j]/(node_a_radius/10);
-                negative_force[j]=negative_force[j]/(node_b_radius/10);
+                mSlotForces[entry] += mChunkForces[chunk*buffer_size + entry];
             }
-            p_node_a->AddAppliedForceContribution(force);
-            p_node_b->AddAppliedForceContribution(negative_force);
         }
     }
+
+    c_vector<double, DIM> force;
+    for (unsigned slot=0; slot<num_slots; slot++)
+    {
+        for (unsigned d=0; d<DIM; d++)
+        {
+            force[d] = mSlotForces[d*num_slots + slot];
+        }
+        mListNodes[slot]->AddAppliedForceContribution(force);
+    }
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    // Throw an exception message if not using a NodeBasedCellPopulation
+    if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation) == NULL)
+    {
+        EXCEPTION("RepulsionForceMassCorrected is to be used with a NodeBasedCellPopulation only");
+    }
+
+    NodeBasedCellPopulation<DIM>* p_population = static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+
+    if (NeighbourListNeedsRebuilding(*p_population))
+    {
+        RebuildNeighbourList(*p_population);
+    }
+
+    GatherNodeData(*p_population);
+    CalculatePairDistances();
+    FindContactPairs(*p_population);
+    CalculateForceMagnitudes();
+    ScatterForces();
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::SetVerletSkin(double verletSkin)
+{
+    assert(verletSkin >= 0.0);
+    mVerletSkin = verletSkin;
+}
+
+template<unsigned DIM>
+double RepulsionForceMassCorrected<DIM>::GetVerletSkin()
+{
+    return mVerletSkin;
+}
+
+template<unsigned DIM>
+unsigned RepulsionForceMassCorrected<DIM>::GetNumNeighbourPairs()
+{
+    return mPairSlotsA.size();
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::SetNumberOfThreads(unsigned numberOfThreads)
+{
+    assert(numberOfThreads > 0);
+    mNumberOfThreads = numberOfThreads;
+}
+
+template<unsigned DIM>
+unsigned RepulsionForceMassCorrected<DIM>::GetNumberOfThreads()
+{
+    return mNumberOfThreads;
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::SetUseSpatialReordering(bool useSpatialReordering)
+{
+    mUseSpatialReordering = useSpatialReordering;
+}
+
+template<unsigned DIM>
+bool RepulsionForceMassCorrected<DIM>::GetUseSpatialReordering()
+{
+    return mUseSpatialReordering;
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::SetForceLawTable(unsigned numIntervalsPerUnit, bool useCubicInterpolation)
+{
+    mForceLawTableResolution = numIntervalsPerUnit;
+    mUseCubicForceLawTable = useCubicInterpolation;
+    mpForceLawTable.reset();
+}
+
+template<unsigned DIM>
+unsigned RepulsionForceMassCorrected<DIM>::GetForceLawTableResolution()
+{
+    return mForceLawTableResolution;
+}
+
+template<unsigned DIM>
+bool RepulsionForceMassCorrected<DIM>::GetUseCubicForceLawTable()
+{
+    return mUseCubicForceLawTable;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<ForceLawTable> RepulsionForceMassCorrected<DIM>::GetForceLawTable()
+{
+    if (mForceLawTableResolution > 0 && !mpForceLawTable)
+    {
+        mpForceLawTable.reset(new ForceLawTable(mForceLawTableResolution, mUseCubicForceLawTable));
+    }
+    return mpForceLawTable;
+}
+
+template<unsigned DIM>
+double RepulsionForceMassCorrected<DIM>::GetMassCorrection(double radius)
+{
+    return 10.0/radius;
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::GetContactLinearisation(std::vector<Node<DIM>*>& rNodesA,
+                                                               std::vector<Node<DIM>*>& rNodesB,
+                                                               std::vector<c_vector<double, DIM> >& rUnitVectors,
+                                                               std::vector<double>& rStiffnesses)
+{
+    unsigned num_contacts = mContactPairs.size();
+    unsigned num_slots = mListNodes.size();
+    rNodesA.resize(num_contacts);
+    rNodesB.resize(num_contacts);
+    rUnitVectors.resize(num_contacts);
+    rStiffnesses.resize(num_contacts);
+
+    // Derivatives of the force law in CalculateForceMagnitudes(), with the same alpha
+    const double alpha = 5.0;
+    for (unsigned contact=0; contact<num_contacts; contact++)
+    {
+        unsigned pair = mContactPairs[contact];
+        unsigned slot_a = mPairSlotsA[pair];
+        unsigned slot_b = mPairSlotsB[pair];
+
+        rNodesA[contact] = mListNodes[slot_a];
+        rNodesB[contact] = mListNodes[slot_b];
+        for (unsigned d=0; d<DIM; d++)
+        {
+            rUnitVectors[contact][d] = (mSlotLocations[d*num_slots + slot_b] - mSlotLocations[d*num_slots + slot_a])/mPairDistances[pair];
+        }
+
+        double relative_overlap = mContactOverlaps[contact]/mContactFinalRestLengths[contact];
+        double derivative;
+        if (mContactOverlaps[contact] <= 0.0)
+        {
+            derivative = 1.0/(1.0 + relative_overlap);
+        }
+        else
+        {
+            derivative = (1.0 - alpha*relative_overlap)*exp(-alpha*relative_overlap);
+        }
+        rStiffnesses[contact] = mContactStiffnesses[contact]*std::max(derivative, 0.0);
+    }
+}
+
+template<unsigned DIM>
+void RepulsionForceMassCorrected<DIM>::SetSpatialIndex(boost::shared_ptr<GonadArmSpatialIndex<DIM> > pSpatialIndex)
+{
+    mpSpatialIndex = pSpatialIndex;
+
+    // Make sure the next step rebuilds the neighbour list with the new source of pairs
+    mListNodes.clear();
 }
 
 template<unsigned DIM>
 void RepulsionForceMassCorrected<DIM>::OutputForceParameters(out_stream& rParamsFile)
 {
+    *rParamsFile << "\t\t\t<VerletSkin>" << mVerletSkin << "</VerletSkin>\n";
+    *rParamsFile << "\t\t\t<UseSpatialReordering>" << mUseSpatialReordering << "</UseSpatialReordering>\n";
+    *rParamsFile << "\t\t\t<ForceLawTableResolution>" << mForceLawTableResolution << "</ForceLawTableResolution>\n";
+    *rParamsFile << "\t\t\t<UseCubicForceLawTable>" << mUseCubicForceLawTable << "</UseCubicForceLawTable>\n";
+
     // Call direct parent class
 	GeneralisedLinearSpringForce<DIM>::OutputForceParameters(rParamsFile);
 }
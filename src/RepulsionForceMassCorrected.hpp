@@ -38,6 +38,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "GeneralisedLinearSpringForce.hpp"
 #include "NodeBasedCellPopulation.hpp"
+#include "GonadArmSpatialIndex.hpp"
+#include "ForceLawTable.hpp"
+#include "ChasteSerializationVersion.hpp"
+#include <boost/shared_ptr.hpp>
 
 /**
  * A class for a simple two-body repulsion force law. Designed
@@ -50,6 +54,29 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * Have modified the original file by DIVIDING THE FORCE EXPERIENCED BY A CELL
  * BY ITS CROSS SECTIONAL AREA to account for the differing drag force experienced
  * by cells of different sizes.
+ *
+ * Rather than visiting every pair the population's box collection generates (which, with the large
+ * interaction cutoff used to build the mesh, is mostly pairs far out of contact) the force keeps its
+ * own Verlet neighbour list: all pairs closer than the sum of their radii plus a skin distance. The
+ * list is only rebuilt when some node has moved, or grown, by more than half the skin since the last
+ * rebuild, or when nodes have been added or removed. The population's interaction cutoff must be at
+ * least the largest rest length plus the skin for the list to be complete, unless a GonadArmSpatialIndex is
+ * given (SetSpatialIndex), in which case the list is built from the index's pairs instead.
+ *
+ * Forces are evaluated in passes over structure-of-arrays work buffers: node locations, radii and per-cell
+ * spring data are gathered into flat arrays, the pairs in contact are found and their rest lengths and
+ * stiffnesses set up, the force law is evaluated for all of them in a tight loop with no virtual calls (which
+ * the compiler can vectorise), and the mass-corrected forces are scattered back so each node receives a single
+ * contribution. The contact pass only calls the virtual VariableSpringConstantMultiplicationFactor() for each
+ * contact in subclasses, which may override it; this class uses the same stiffness for every pair. Pairs of
+ * newly divided cells, whose spring rest length depends on the population's marked springs, go through the
+ * scalar CalculateForceBetweenNodes() as before. Separations are plain differences of locations, as a
+ * NodesOnlyMesh is not periodic.
+ *
+ * If built with OpenMP, the distance, force law and scatter passes can be spread over several threads
+ * (SetNumberOfThreads). Contacts are split into one contiguous chunk per thread, each accumulating into its
+ * own force buffer, and the buffers are summed in chunk order, so no atomics are needed and the result
+ * depends only on the number of threads, not on how they are scheduled.
  */
 template<unsigned DIM>
 class RepulsionForceMassCorrected : public GeneralisedLinearSpringForce<DIM>
@@ -68,8 +95,164 @@ private :
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<GeneralisedLinearSpringForce<DIM> >(*this);
+        // Older archives keep the constructor's defaults, which visit the same pairs and evaluate the law exactly
+        if (version > 0)
+        {
+            archive & mVerletSkin;
+        }
+        if (version > 1)
+        {
+            archive & mUseSpatialReordering;
+        }
+        if (version > 2)
+        {
+            archive & mForceLawTableResolution;
+            archive & mUseCubicForceLawTable;
+        }
     }
 
+    /**
+     * The skin distance added to each pair's rest length when building the neighbour list.
+     * A skin of zero rebuilds the list every time step.
+     */
+    double mVerletSkin;
+
+    /**
+     * Whether to give nodes their slots in Morton (space-filling curve) order of their locations at each
+     * rebuild, rather than in mesh order, and to visit pairs in slot order. Nodes that are close together
+     * then have nearby slots, so the kernel's gathers and scatters stay in cache however scattered the
+     * mesh's node indices have become. Defaults to true.
+     */
+    bool mUseSpatialReordering;
+
+    /**
+     * The number of intervals per unit normalised overlap in the lookup table used to evaluate the force law,
+     * or 0 (the default) to evaluate the logs and exponentials exactly for every contact.
+     */
+    unsigned mForceLawTableResolution;
+
+    /** Whether the lookup table uses cubic Hermite rather than linear interpolation. Defaults to true. */
+    bool mUseCubicForceLawTable;
+
+    /** The lookup table, built on first use after the settings change. Not archived. */
+    boost::shared_ptr<ForceLawTable> mpForceLawTable;
+
+    /** The nodes present at the last rebuild. A node's position here is its slot. */
+    std::vector<Node<DIM>*> mListNodes;
+
+    /** The slot of each node at the last rebuild, indexed by node index (UINT_MAX if none). */
+    std::vector<unsigned> mSlotOfIndex;
+
+    /** The location of each of mListNodes at the last rebuild. */
+    std::vector<c_vector<double, DIM> > mReferenceLocations;
+
+    /** The radius of each of mListNodes at the last rebuild. */
+    std::vector<double> mReferenceRadii;
+
+    /**
+     * The neighbour list: pairs within rest length plus skin at the last rebuild, stored as the slots
+     * of the first and second node of each pair. None of the neighbour list or kernel buffers are archived.
+     */
+    std::vector<unsigned> mPairSlotsA;
+
+    /** The slot of the second node of each pair in the neighbour list. */
+    std::vector<unsigned> mPairSlotsB;
+
+    /** Node locations for this time step, coordinate-major: entry [d*num_slots + slot]. */
+    std::vector<double> mSlotLocations;
+
+    /** Node radii for this time step. */
+    std::vector<double> mSlotRadii;
+
+    /** Factor scaling each cell's half of the rest length: 1, or the fraction of apoptosis left to run. */
+    std::vector<double> mSlotApoptosisFactors;
+
+    /** Whether each cell is younger than the spring growth duration. */
+    std::vector<char> mSlotIsNewlyDivided;
+
+    /** Accumulated mass-corrected forces, laid out like mSlotLocations. */
+    std::vector<double> mSlotForces;
+
+    /** Distance between the nodes of each pair in the neighbour list. */
+    std::vector<double> mPairDistances;
+
+    /** The pairs in contact this time step, as indices into the neighbour list. */
+    std::vector<unsigned> mContactPairs;
+
+    /** The rest length without apoptosis (sum of radii) of each contact pair. */
+    std::vector<double> mContactFinalRestLengths;
+
+    /** The overlap (distance minus rest length) of each contact pair. */
+    std::vector<double> mContactOverlaps;
+
+    /** The spring stiffness, including any variable multiplication factor, of each contact pair. */
+    std::vector<double> mContactStiffnesses;
+
+    /** The force magnitude for each contact pair, filled in by CalculateForceMagnitudes(). */
+    std::vector<double> mContactForceMagnitudes;
+
+    /** The number of threads used by the force kernel. Defaults to 1. Not archived, as it depends on the machine. */
+    unsigned mNumberOfThreads;
+
+    /** One force buffer per chunk of contacts when using more than one thread, laid out like mSlotForces. */
+    std::vector<double> mChunkForces;
+
+    /** If set, the index used to find pairs when rebuilding the neighbour list. Not archived. */
+    boost::shared_ptr<GonadArmSpatialIndex<DIM> > mpSpatialIndex;
+
+    /** Work space for candidate pairs of slots when rebuilding the neighbour list. */
+    std::vector<std::pair<unsigned, unsigned> > mIndexPairs;
+
+protected :
+
+    /**
+     * @return whether the neighbour list is out of date. This is the case if the mesh's nodes
+     * differ from those at the last rebuild, or if any node's displacement plus radius growth since
+     * the last rebuild exceeds half the skin.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    bool NeighbourListNeedsRebuilding(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Rebuild the neighbour list from the population's node pairs (or the spatial index's pairs, if
+     * set), keeping those within rest length plus skin, and record the reference locations and radii.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void RebuildNeighbourList(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Gather the location and radius of each node, and the spring data of its cell, into the slot arrays,
+     * and zero the slot forces.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void GatherNodeData(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Calculate the distance between the nodes of every pair in the neighbour list.
+     */
+    void CalculatePairDistances();
+
+    /**
+     * Find the pairs in contact and set up their rest lengths, overlaps and stiffnesses. Pairs of
+     * newly divided cells are handed to CalculateForceBetweenNodes() and added to the slot forces here.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void FindContactPairs(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Evaluate the force law for every contact pair, from the lookup table if one is set.
+     */
+    void CalculateForceMagnitudes();
+
+    /**
+     * Add each contact pair's mass-corrected force to its two slots, then apply the slot forces to the nodes.
+     */
+    void ScatterForces();
+
 public :
 
     /**
@@ -84,6 +267,104 @@ public :
      */
     void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
 
+    /**
+     * Set mVerletSkin.
+     *
+     * @param verletSkin the new value of mVerletSkin
+     */
+    void SetVerletSkin(double verletSkin);
+
+    /**
+     * @return mVerletSkin
+     */
+    double GetVerletSkin();
+
+    /**
+     * @return the number of pairs in the neighbour list.
+     */
+    unsigned GetNumNeighbourPairs();
+
+    /**
+     * Set mNumberOfThreads. Has no effect on speed unless the code is built with OpenMP (see README.md).
+     *
+     * @param numberOfThreads the new value of mNumberOfThreads
+     */
+    void SetNumberOfThreads(unsigned numberOfThreads);
+
+    /**
+     * @return mNumberOfThreads
+     */
+    unsigned GetNumberOfThreads();
+
+    /**
+     * Set mUseSpatialReordering.
+     *
+     * @param useSpatialReordering the new value of mUseSpatialReordering
+     */
+    void SetUseSpatialReordering(bool useSpatialReordering);
+
+    /**
+     * @return mUseSpatialReordering
+     */
+    bool GetUseSpatialReordering();
+
+    /**
+     * Evaluate the force law from a lookup table in the normalised overlap (see ForceLawTable) rather than
+     * exactly. As the radii only enter the law through the rest length, the one table covers all cell sizes.
+     *
+     * @param numIntervalsPerUnit the number of table intervals per unit normalised overlap, or 0 to go back to
+     *     evaluating the law exactly
+     * @param useCubicInterpolation whether to use cubic Hermite rather than linear interpolation (defaults to true)
+     */
+    void SetForceLawTable(unsigned numIntervalsPerUnit, bool useCubicInterpolation=true);
+
+    /**
+     * @return mForceLawTableResolution
+     */
+    unsigned GetForceLawTableResolution();
+
+    /**
+     * @return mUseCubicForceLawTable
+     */
+    bool GetUseCubicForceLawTable();
+
+    /**
+     * @return the lookup table, building it if need be, or an empty pointer if the law is evaluated exactly.
+     */
+    boost::shared_ptr<ForceLawTable> GetForceLawTable();
+
+    /**
+     * @return the factor each node's share of a contact force is multiplied by, which divides the force by
+     * the cell's cross section (10/radius).
+     *
+     * @param radius the radius of the cell
+     */
+    double GetMassCorrection(double radius);
+
+    /**
+     * Get the linearisation of the contact forces found by the last call to AddForceContribution(), for use by
+     * implicit integrators. For each contact this gives the two nodes, the unit vector from the first to the
+     * second, and the derivative of the force magnitude with respect to their separation, before mass
+     * correction. Negative derivatives (the far, softening side of the attractive branch) are returned as zero.
+     * Pairs of newly divided cells, whose force comes from CalculateForceBetweenNodes(), are not included.
+     *
+     * @param rNodesA filled with the first node of each contact
+     * @param rNodesB filled with the second node of each contact
+     * @param rUnitVectors filled with the unit vector from the first node to the second
+     * @param rStiffnesses filled with the derivative of the force magnitude
+     */
+    void GetContactLinearisation(std::vector<Node<DIM>*>& rNodesA,
+                                 std::vector<Node<DIM>*>& rNodesB,
+                                 std::vector<c_vector<double, DIM> >& rUnitVectors,
+                                 std::vector<double>& rStiffnesses);
+
+    /**
+     * Set mpSpatialIndex. Pass an empty pointer to go back to using the population's node pairs.
+     *
+     * @param pSpatialIndex the spatial index
+     */
+    void SetSpatialIndex(boost::shared_ptr<GonadArmSpatialIndex<DIM> > pSpatialIndex);
+
     /**
      * Outputs force Parameters to file
      *
@@ -95,6 +376,19 @@ public :
     virtual void OutputForceParameters(out_stream& rParamsFile);
 };
 
+// Version 1 archives the Verlet skin, version 2 spatial reordering and version 3 the force law table.
+namespace boost
+{
+namespace serialization
+{
+template<unsigned DIM>
+struct version<RepulsionForceMassCorrected<DIM> >
+{
+    CHASTE_VERSION_CONTENT(3);
+};
+} // namespace serialization
+} // namespace boost
+
 #include "SerializationExportWrapper.hpp"
 EXPORT_TEMPLATE_CLASS_SAME_DIMS(RepulsionForceMassCorrected)
 
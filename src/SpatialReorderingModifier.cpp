@@ -0,0 +1,138 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpatialReorderingModifier.hpp"
+#include "SpaceFillingCurve.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+SpatialReorderingModifier<DIM>::SpatialReorderingModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mReorderingInterval(100),
+      mCubeSize(2.0)
+{
+}
+
+template<unsigned DIM>
+SpatialReorderingModifier<DIM>::~SpatialReorderingModifier()
+{
+}
+
+template<unsigned DIM>
+void SpatialReorderingModifier<DIM>::ReorderCells(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    std::list<CellPtr>& r_cells = rCellPopulation.rGetCells();
+    if (r_cells.size() < 2)
+    {
+        return;
+    }
+
+    std::vector<CellPtr> cells(r_cells.begin(), r_cells.end());
+    std::vector<c_vector<double, DIM> > locations;
+    locations.reserve(cells.size());
+    for (unsigned i=0; i<cells.size(); i++)
+    {
+        locations.push_back(rCellPopulation.GetLocationOfCellCentre(cells[i]));
+    }
+
+    std::vector<unsigned> order;
+    SpaceFillingCurve::CalculateMortonOrder<DIM>(locations, mCubeSize, order);
+
+    r_cells.clear();
+    for (unsigned i=0; i<order.size(); i++)
+    {
+        r_cells.push_back(cells[order[i]]);
+    }
+}
+
+template<unsigned DIM>
+void SpatialReorderingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (SimulationTime::Instance()->GetTimeStepsElapsed() % mReorderingInterval == 0)
+    {
+        ReorderCells(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void SpatialReorderingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    ReorderCells(rCellPopulation);
+}
+
+template<unsigned DIM>
+void SpatialReorderingModifier<DIM>::SetReorderingInterval(unsigned reorderingInterval)
+{
+    if (reorderingInterval == 0)
+    {
+        EXCEPTION("The reordering interval must be at least one timestep");
+    }
+    mReorderingInterval = reorderingInterval;
+}
+
+template<unsigned DIM>
+unsigned SpatialReorderingModifier<DIM>::GetReorderingInterval()
+{
+    return mReorderingInterval;
+}
+
+template<unsigned DIM>
+void SpatialReorderingModifier<DIM>::SetCubeSize(double cubeSize)
+{
+    if (cubeSize <= 0.0)
+    {
+        EXCEPTION("The cube size must be positive");
+    }
+    mCubeSize = cubeSize;
+}
+
+template<unsigned DIM>
+double SpatialReorderingModifier<DIM>::GetCubeSize()
+{
+    return mCubeSize;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class SpatialReorderingModifier<1>;
+template class SpatialReorderingModifier<2>;
+template class SpatialReorderingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SpatialReorderingModifier)
@@ -0,0 +1,135 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SPATIALREORDERINGMODIFIER_HPP_
+#define SPATIALREORDERINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+/**
+ * A modifier class which every few timesteps sorts the population's list of cells into Morton (space-filling
+ * curve) order of their locations, so that loops over cells visit neighbouring cells one after another.
+ *
+ * Only the order of the list changes: cells and nodes stay where they are in memory and keep their indices.
+ */
+template<unsigned DIM>
+class SpatialReorderingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mReorderingInterval;
+        archive & mCubeSize;
+    }
+
+    /** The number of timesteps between reorderings. Defaults to 100. */
+    unsigned mReorderingInterval;
+
+    /** The side length of the cubes used to build the Morton keys. Defaults to 2, about one cell diameter. */
+    double mCubeSize;
+
+    /**
+     * Sort the population's cells into Morton order of their locations.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void ReorderCells(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    SpatialReorderingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~SpatialReorderingModifier();
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method
+     *
+     * Reorders the cells if mReorderingInterval timesteps have passed since the last reordering.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overriden SetupSolve method
+     *
+     * Reorders the cells before the start of the time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Set mReorderingInterval.
+     *
+     * @param reorderingInterval the new value of mReorderingInterval, in timesteps
+     */
+    void SetReorderingInterval(unsigned reorderingInterval);
+
+    /**
+     * @return mReorderingInterval
+     */
+    unsigned GetReorderingInterval();
+
+    /**
+     * Set mCubeSize.
+     *
+     * @param cubeSize the new value of mCubeSize
+     */
+    void SetCubeSize(double cubeSize);
+
+    /**
+     * @return mCubeSize
+     */
+    double GetCubeSize();
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SpatialReorderingModifier)
+
+#endif /*SPATIALREORDERINGMODIFIER_HPP_*/
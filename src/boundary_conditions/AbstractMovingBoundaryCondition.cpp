@@ -45,6 +45,12 @@ AbstractMovingBoundaryCondition<ELEMENT_DIM,SPACE_DIM>::AbstractMovingBoundaryCo
 {
 }
 
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+bool AbstractMovingBoundaryCondition<ELEMENT_DIM,SPACE_DIM>::IsFrozen() const
+{
+    return false;
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 // Explicit instantiation
@@ -79,6 +79,13 @@ public:
      * */
     virtual void UpdateBoundaryCondition()=0;
 
+    /**
+     * @return whether the boundary has reached its final shape, so that UpdateBoundaryCondition() will not change
+     * it again. The moving boundary modifier stops updating frozen boundaries, and skips updating the cell
+     * population once none is still moving. Defaults to false; boundaries that stop growing should override it.
+     */
+    virtual bool IsFrozen() const;
+
 };
 
 TEMPLATED_CLASS_IS_ABSTRACT_2_UNSIGNED(AbstractMovingBoundaryCondition)
@@ -35,6 +35,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "CombinedStaticGonadBoundaryCondition.hpp"
 #include "NodeBasedCellPopulation.hpp"
+#include <algorithm>
 
 template<unsigned DIM>
 CombinedStaticGonadBoundaryCondition<DIM>::CombinedStaticGonadBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation,
@@ -48,7 +49,14 @@ CombinedStaticGonadBoundaryCondition<DIM>::CombinedStaticGonadBoundaryCondition(
       mStraightLengthUpper(StraightLengthUpper),
       mTurnRadius(TurnRadius),
       mCurrentTubeRadius(CurrentTubeRadius),
-      mMaximumDistance(distance)
+      mMaximumDistance(distance),
+      mVerifyFromImposedRecord(true),
+      mCentreline(StraightLengthLower, StraightLengthUpper, TurnRadius),
+      mProjectionCache(mCentreline, 0.0),
+      mCullInteriorCells(true),
+      mNumCellsCulled(0),
+      mNumCellsImposed(0),
+      mNumberOfThreads(1)
 {
     assert(mStraightLengthLower > 0.0);
     assert(mStraightLengthUpper > 0.0);
@@ -91,98 +99,215 @@ double CombinedStaticGonadBoundaryCondition<DIM>::GetCurrentTubeRadius() const
 }
 
 
+template<unsigned DIM>
+void CombinedStaticGonadBoundaryCondition<DIM>::SetVerifyFromImposedRecord(bool verifyFromImposedRecord)
+{
+    mVerifyFromImposedRecord = verifyFromImposedRecord;
+}
+template<unsigned DIM>
+bool CombinedStaticGonadBoundaryCondition<DIM>::GetVerifyFromImposedRecord() const
+{
+    return mVerifyFromImposedRecord;
+}
 
-/*Checks whether each cell lies in the gonad arm. If not, places the cell on the closest surface point*/
 template<unsigned DIM>
-void CombinedStaticGonadBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+void CombinedStaticGonadBoundaryCondition<DIM>::SetCullInteriorCells(bool cullInteriorCells)
+{
+    mCullInteriorCells = cullInteriorCells;
+}
+template<unsigned DIM>
+bool CombinedStaticGonadBoundaryCondition<DIM>::GetCullInteriorCells() const
+{
+    return mCullInteriorCells;
+}
+template<unsigned DIM>
+unsigned CombinedStaticGonadBoundaryCondition<DIM>::GetNumCellsCulled() const
+{
+    return mNumCellsCulled;
+}
+template<unsigned DIM>
+unsigned CombinedStaticGonadBoundaryCondition<DIM>::GetNumCellsImposed() const
 {
+    return mNumCellsImposed;
+}
+
+template<unsigned DIM>
+void CombinedStaticGonadBoundaryCondition<DIM>::SetNumberOfThreads(unsigned numberOfThreads)
+{
+    assert(numberOfThreads > 0);
+    mNumberOfThreads = numberOfThreads;
+}
+
+template<unsigned DIM>
+unsigned CombinedStaticGonadBoundaryCondition<DIM>::GetNumberOfThreads() const
+{
+    return mNumberOfThreads;
+}
 
-    // Iterate over the cell population and get cell location
+
+/*Gathers every cell and its node and location*/
+template<unsigned DIM>
+void CombinedStaticGonadBoundaryCondition<DIM>::GatherCells()
+{
+    mCells.clear();
+    mNodes.clear();
+    mLocations.clear();
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
          cell_iter != this->mpCellPopulation->End();
          ++cell_iter)
     {
-    	 c_vector<double,DIM> cell_location = this->mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
-    	 Node<DIM>* cell_centre_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
-    	 double radius = cell_centre_node->GetRadius();
-
-    	 // Find C, the closest point on the growth path for this cell, and R the distance to it.
-        double R=0;
-        c_vector<double, DIM> C= zero_vector<double>(3);
-
-        //If all three parts of the path exist, measure distances to the lower+upper straights and the loop
-        //Find min distance to each of the three parts of the path
-        double R1=0; double R2=0; double R3=0;
-        c_vector<double, DIM> C1=zero_vector<double>(3);
-        c_vector<double, DIM> C2=zero_vector<double>(3);
-        c_vector<double, DIM> C3=zero_vector<double>(3);
-        GetClosestOnLowerStraight(C1,cell_location,R1);
-        GetClosestOnLoop(C2,cell_location,R2);
-        GetClosestOnUpperStraight(C3,cell_location,R3);
-        //Take min and record closest point
-        R=std::min(R1,std::min(R2,R3));
-        if(R==R1){
-        	C=C1;
-        }else if(R==R2){
-        	C=C2;
-        }else{
-        	C=C3;
+        Node<DIM>* p_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+        mCells.push_back(*cell_iter);
+        mNodes.push_back(p_node);
+        mLocations.push_back(p_node->rGetLocation());
+    }
+}
+
+
+/*Gathers every cell's node and location, then finds the closest point on the growth path to each in one batch*/
+template<unsigned DIM>
+void CombinedStaticGonadBoundaryCondition<DIM>::ProjectCells()
+{
+    GatherCells();
+    mCentreline.ProjectAll(mLocations, mClosestPoints, mArcLengths, mDistances);
+
+    mSyncytiumRadii.resize(mLocations.size());
+    for (unsigned i=0; i<mLocations.size(); i++)
+    {
+        mSyncytiumRadii[i] = GetSyncytiumRadius(mArcLengths[i]);
+    }
+}
+
+
+/*Checks whether each cell lies in the gonad arm. If not, places the cell on the closest surface point*/
+template<unsigned DIM>
+void CombinedStaticGonadBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+{
+    mImposedRecord.Clear();
+    mNumCellsCulled = 0;
+    mNumCellsImposed = 0;
+
+    // Gather the nodes first, so that each can be imposed on independently of the others
+    GatherCells();
+    unsigned num_cells = mNodes.size();
+    unsigned num_node_indices = 0;
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        num_node_indices = std::max(num_node_indices, mNodes[i]->GetIndex()+1);
+    }
+    mProjectionCache.Reserve(num_node_indices);
+    mArcLengths.resize(num_cells);
+    mWasMoved.resize(num_cells);
+    mWasCulled.resize(num_cells);
+
+    // Each cell only touches its own node, its own cache entry and its own slots, so the result does not depend on the number of threads
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(mNumberOfThreads)
+#endif
+    for (int i=0; i<(int)num_cells; i++)
+    {
+        typename std::map<Node<DIM>*, c_vector<double, DIM> >::const_iterator old_iter = rOldLocations.find(mNodes[i]);
+        const c_vector<double, DIM>* p_old_location = (old_iter == rOldLocations.end()) ? NULL : &(old_iter->second);
+
+        bool was_culled;
+        mWasMoved[i] = ImposeOnNode(mNodes[i], p_old_location, mArcLengths[i], was_culled);
+        mWasCulled[i] = was_culled;
+    }
+
+    // Record the results for VerifyBoundaryCondition(), in the order of the cells; a cell that was not moved was already satisfied
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        mImposedRecord.Record(mNodes[i], mWasMoved[i], !mWasMoved[i]);
+        if (mWasCulled[i])
+        {
+            mNumCellsCulled++;
+        }
+
+        // With no GonadArmGeometryModifier to record where each cell is along the arm, record it in cell data
+        if (!this->IsRecordedByModifier())
+        {
+            double arc_length = mArcLengths[i];
+            if (mWasCulled[i])
+            {
+                c_vector<double, DIM> closest_point;
+                mCentreline.Project(mNodes[i]->rGetLocation(), closest_point, arc_length);
+            }
+            this->RecordGeometryInCellData(mCells[i], arc_length);
         }
+    }
+    mNumCellsImposed = num_cells;
+}
+
 
-        double distance;
-        HowFarAlongAreYou(C,distance);
-        double SyncytiumRadius = GetSyncytiumRadius(distance);
+template<unsigned DIM>
+bool CombinedStaticGonadBoundaryCondition<DIM>::ImposeOnNode(Node<DIM>* pNode,
+                                                             const c_vector<double, DIM>* pOldLocation,
+                                                             double& rArcLength,
+                                                             bool& rWasCulled)
+{
+    double radius = pNode->GetRadius();
+    rArcLength = -1.0;
 
-        if(distance>mStraightLengthLower){
+    // Cells well inside the wall, and well clear of the syncytium, need not be projected
+    rWasCulled = mCullInteriorCells && IsCertainlySatisfied(pNode);
+    if (rWasCulled)
+    {
+        return false;
+    }
 
-        	//Prevent a cell moving back down the tube to somewhere it doesn't fit
-			if(radius>(mCurrentTubeRadius-SyncytiumRadius)/2){
-				unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
-				Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
-				c_vector<double,DIM>& p_force = p_node->rGetAppliedForce();
-				double damping_const = dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation)->GetDampingConstant(node_index);
-				p_node->rGetModifiableLocation() = cell_location-SimulationTime::Instance()->GetTimeStep()*(p_force)/damping_const;
+    // Find C, the closest point on the growth path, R the distance to it and how far along the arm it is
+    c_vector<double,DIM> cell_location = pNode->rGetLocation();
+    c_vector<double,DIM> C;
+    double distance;
+    double R = mProjectionCache.Project(pNode, C, distance);
+    rArcLength = distance;
+    double SyncytiumRadius = GetSyncytiumRadius(distance);
+    bool was_moved = true;
+
+    if(distance>mStraightLengthLower){
+
+    	//Prevent a cell moving back down the tube to somewhere it doesn't fit, by undoing its last move. The old
+    	//location is used rather than dt*F/damping, as the move may have been a substep or an implicit update.
+		if(radius>(mCurrentTubeRadius-SyncytiumRadius)/2){
+			if(pOldLocation!=NULL){
+				pNode->rGetModifiableLocation() = *pOldLocation;
 			}else{
-				// If the cell is too far inside the growth path, and therefore in the syncytium...
-				if (R-radius<SyncytiumRadius-mMaximumDistance)
-				{
-					// ...move the cell back onto the surface of the tube by translating away from C:
-					unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
-					Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
-					p_node->rGetModifiableLocation() = C+(SyncytiumRadius+radius)*(cell_location-C)/norm_2(cell_location-C);
-				}
-				// If the cell is too far from the growth path, and therefore outside the tube...
-				if (R+radius-mCurrentTubeRadius > mMaximumDistance)
-				{
-					// ...move the cell back onto the surface of the tube by translating toward C:
-					unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
-					Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
-					p_node->rGetModifiableLocation() = C+(mCurrentTubeRadius-radius)*(cell_location-C)/norm_2(cell_location-C);
-				}
+				//With no old location for the cell, fall back to undoing a whole timestep's move under its force
+				double damping_const = dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation)->GetDampingConstant(pNode->GetIndex());
+				pNode->rGetModifiableLocation() = cell_location-SimulationTime::Instance()->GetTimeStep()*pNode->rGetAppliedForce()/damping_const;
+			}
+		}else{
+			was_moved = false;
+			// If the cell is too far inside the growth path, and therefore in the syncytium...
+			if (R-radius<SyncytiumRadius-mMaximumDistance)
+			{
+				// ...move the cell back onto the surface of the tube by translating away from C:
+				pNode->rGetModifiableLocation() = C+(SyncytiumRadius+radius)*(cell_location-C)/R;
+				was_moved = true;
 			}
-
-        }else{
 			// If the cell is too far from the growth path, and therefore outside the tube...
 			if (R+radius-mCurrentTubeRadius > mMaximumDistance)
 			{
 				// ...move the cell back onto the surface of the tube by translating toward C:
-				unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
-				Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
-				p_node->rGetModifiableLocation() = C+(mCurrentTubeRadius-radius)*(cell_location-C)/norm_2(cell_location-C);
+				pNode->rGetModifiableLocation() = C+(mCurrentTubeRadius-radius)*(cell_location-C)/R;
+				mProjectionCache.RecordMoveTowardsCentreline(pNode, norm_2(pNode->rGetLocation()-C));
+				was_moved = true;
 			}
-        }
+		}
 
-        /*Assuming all is now well, update the cell data to record how far along the gonad arm this cell is.
-         * Use the vector C, which stores the closest point on the growth path to this cell.*/
-        HowFarAlongAreYou(C,distance);
-        cell_iter->GetCellData()->SetItem("DistanceAwayFromDTC", mStraightLengthLower+mStraightLengthUpper+mTurnRadius*M_PI-distance);
-        if(distance<(mStraightLengthLower-1)){
-        	cell_iter->GetCellData()->SetItem("MaxRadius",mCurrentTubeRadius);
-        }else{
-        	cell_iter->GetCellData()->SetItem("MaxRadius",(mCurrentTubeRadius-SyncytiumRadius-0.1)/2);
-        }
+    }else{
+		was_moved = false;
+		// If the cell is too far from the growth path, and therefore outside the tube...
+		if (R+radius-mCurrentTubeRadius > mMaximumDistance)
+		{
+			// ...move the cell back onto the surface of the tube by translating toward C:
+			pNode->rGetModifiableLocation() = C+(mCurrentTubeRadius-radius)*(cell_location-C)/R;
+			mProjectionCache.RecordMoveTowardsCentreline(pNode, norm_2(pNode->rGetLocation()-C));
+			was_moved = true;
+		}
     }
 
+    return was_moved;
 }
 
 
@@ -192,170 +317,109 @@ bool CombinedStaticGonadBoundaryCondition<DIM>::VerifyBoundaryCondition()
 {
     bool condition_satisfied = true;
 
-    // Iterate over the cell population
-    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
-         cell_iter != this->mpCellPopulation->End();
-         ++cell_iter)
+    if (mVerifyFromImposedRecord && mImposedRecord.IsValid(this->mpCellPopulation->GetNumRealCells()))
     {
-    	c_vector<double,DIM> cell_location = this->mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
-		 Node<DIM>* cell_centre_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
-		 double radius = cell_centre_node->GetRadius();
-
-        // Find R=minimum distance to the growth path for this cell, as in ImposeBoundaryCondition
-        double R=0;
-        c_vector<double, DIM> C=zero_vector<double>(3);
-        c_vector<double, DIM> C1=zero_vector<double>(3);
-        c_vector<double, DIM> C2=zero_vector<double>(3);
-        c_vector<double, DIM> C3=zero_vector<double>(3);
-        double R1=0;double R2=0;double R3=0;
-        GetClosestOnLowerStraight(C1,cell_location,R1);
-        GetClosestOnLoop(C2,cell_location,R2);
-        GetClosestOnUpperStraight(C3,cell_location,R3);
-        //Take min and record closest point
-        R=std::min(R1,std::min(R2,R3));
-        if(R==R1){
-        	C=C1;
-        }else if(R==R2){
-        	C=C2;
-        }else{
-        	C=C3;
+        // Only cells that have moved since ImposeBoundaryCondition() checked them need the geometry again
+        for (unsigned i=0; i<mImposedRecord.GetNumRecords(); i++)
+        {
+            bool is_satisfied;
+            if (mImposedRecord.NeedsChecking(i))
+            {
+                Node<DIM>* p_node = mImposedRecord.GetNode(i);
+                is_satisfied = IsCertainlySatisfied(p_node);
+                if (!is_satisfied)
+                {
+                    c_vector<double, DIM> C;
+                    double distance;
+                    double R = mCentreline.Project(p_node->rGetLocation(), C, distance);
+                    is_satisfied = IsSatisfied(R, p_node->GetRadius(), distance);
+                }
+            }
+            else
+            {
+                is_satisfied = mImposedRecord.WasSatisfied(i);
+            }
+
+            if (!is_satisfied)
+            {
+                // ...then the boundary condition is not satisfied :-(
+                condition_satisfied = false;
+                break;
+            }
         }
-
-        double distance;
-        HowFarAlongAreYou(C,distance);
-        double SyncytiumRadius = GetSyncytiumRadius(distance);
-
-        // If the cell is too far from the surface of the tube...
-        if(distance>mStraightLengthLower){
-			if (R+radius-mCurrentTubeRadius > mMaximumDistance || R-radius<SyncytiumRadius-mMaximumDistance){
-				// ...then the boundary condition is not satisfied :-(
-				condition_satisfied = false;
-				break;
-			}
-        }else{
-        	if (R+radius-mCurrentTubeRadius > mMaximumDistance){
-        	     // ...then the boundary condition is not satisfied :-(
-        	     condition_satisfied = false;
-        	     break;
-             }
+    }
+    else
+    {
+        // Find R=minimum distance to the growth path for each cell, as in ImposeBoundaryCondition
+        ProjectCells();
+
+        for (unsigned i=0; i<mCells.size(); i++)
+        {
+            // If the cell is too far from the surface of the tube...
+            if (!IsSatisfied(mDistances[i], mNodes[i]->GetRadius(), mArcLengths[i]))
+            {
+                // ...then the boundary condition is not satisfied :-(
+                condition_satisfied = false;
+                break;
+            }
         }
     }
+
+    mImposedRecord.Invalidate();
     return condition_satisfied;
 }
 
 
-/*Calculate how far along the gonad arm some point on the growth path is*/
+/*Whether a cell, whose centre is a distance R from the growth path, lies between the syncytium and the tube wall*/
 template<unsigned DIM>
-void CombinedStaticGonadBoundaryCondition<DIM>::HowFarAlongAreYou(c_vector<double, DIM> point, double& dist){
-	if(point[0]>=0 && point[1]==-mTurnRadius){
-		//if on the lower straight, look at x coord
-		dist=mStraightLengthLower-point[0];
-	}else if(point[0]>=0 && point[1]==mTurnRadius){
-		//upper straight - also look at the x coord
-		dist=mStraightLengthLower+M_PI*mTurnRadius+point[0];
-	}else{
-		//loop: use trig.
-		if(point[1]<0){
-			dist=mStraightLengthLower+mTurnRadius*atan(fabs(point[0]/point[1]));
-		}else{
-			dist=mStraightLengthLower+mTurnRadius*(-atan(fabs(point[0]/point[1]))+M_PI);
-		}
-	}
+bool CombinedStaticGonadBoundaryCondition<DIM>::IsSatisfied(double R, double radius, double arcLength)
+{
+    if (R+radius-mCurrentTubeRadius > mMaximumDistance)
+    {
+        return false;
+    }
+    if (arcLength>mStraightLengthLower && R-radius<GetSyncytiumRadius(arcLength)-mMaximumDistance)
+    {
+        return false;
+    }
+    return true;
 }
 
 
-/*Utility functions for determining the closest point on each section of the growth path to your cell centre.
- * The strategy is always to measure:
- * 1) Mid: The distance along a normal to the path, if that part of the path exists (otherwise set to DBL_MAX)
- * 2) End1: The distance to one end of the path that has grown so far
- * 3) End2: The distance to the other end of the path that has grown so far
- * Then take the minimum and output the closest point on the path to your cell.
- * */
+/*Whether the bounds on a cell's distance and arc length from the projection cache show it satisfies the
+ * condition, and is in no danger of being moved by ImposeBoundaryCondition()*/
 template<unsigned DIM>
-void CombinedStaticGonadBoundaryCondition<DIM>::GetClosestOnLowerStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist){
-	c_vector<double, DIM> end1=zero_vector<double>(3);
-	c_vector<double, DIM> end2=zero_vector<double>(3);
-	c_vector<double, DIM> mid=zero_vector<double>(3);
-	end1[0]=0; end1[1]=-mTurnRadius; end1[2]=0;
-	end2[0]=mStraightLengthLower; end2[1]=-mTurnRadius; end2[2]=0;
-	if(cell_location[0]<end2[0] && cell_location[0]>end1[0]){
-		mid[0]=cell_location[0]; mid[1]=-mTurnRadius; mid[2]=0;
-	}else{
-		mid[0]=DBL_MAX; mid[1]=DBL_MAX; mid[2]=DBL_MAX;
-	}
-	double R1=norm_2(end1-cell_location);
-	double R2=norm_2(end2-cell_location);
-	double R3=norm_2(mid-cell_location);
-	dist=std::min(R1,std::min(R2,R3));
-	if(dist==R1){
-		point=end1;
-	}else if(dist==R2){
-		point=end2;
-	}else{
-		point=mid;
-	}
-}
-
-template<unsigned DIM>
-void CombinedStaticGonadBoundaryCondition<DIM>::GetClosestOnUpperStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist){
-	c_vector<double, DIM> end1=zero_vector<double>(3);
-	c_vector<double, DIM> end2=zero_vector<double>(3);
-	c_vector<double, DIM> mid=zero_vector<double>(3);
-	end1[0]=mStraightLengthUpper; end1[1]=mTurnRadius; end1[2]=0;
-	end2[0]=0; end2[1]=mTurnRadius; end2[2]=0;
-	if(cell_location[0]<end1[0] && cell_location[0]>end2[0]){
-		mid[0]=cell_location[0]; mid[1]=mTurnRadius; mid[2]=0;
-	}else{
-		mid[0]=DBL_MAX; mid[1]=DBL_MAX; mid[2]=DBL_MAX;
-	}
-	double R1=norm_2(end1-cell_location);
-	double R2=norm_2(end2-cell_location);
-	double R3=norm_2(mid-cell_location);
-	dist=std::min(R1,std::min(R2,R3));
-	if(dist==R1){
-		point=end1;
-	}else if(dist==R2){
-		point=end2;
-	}else{
-		point=mid;
-	}
-}
+bool CombinedStaticGonadBoundaryCondition<DIM>::IsCertainlySatisfied(Node<DIM>* pNode)
+{
+    double min_R, max_R, min_arc_length, max_arc_length;
+    if (!mProjectionCache.GetBounds(pNode, DBL_MAX, min_R, max_R, min_arc_length, max_arc_length))
+    {
+        return false;
+    }
 
-template<unsigned DIM>
-void CombinedStaticGonadBoundaryCondition<DIM>::GetClosestOnLoop(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist){
-	c_vector<double, DIM> end1=zero_vector<double>(3);
-	c_vector<double, DIM> end2=zero_vector<double>(3);
-	c_vector<double, DIM> mid=zero_vector<double>(3);
-	end1[0]=0; end1[1]=mTurnRadius; end1[2]=0;
-	end2[0]=0; end2[1]=-mTurnRadius; end2[2]=0;
-	mid[0]=-fabs(mTurnRadius*cell_location[0]/pow(pow(cell_location[0],2)+pow(cell_location[1],2),0.5));
-	if(cell_location[1]<0){
-		mid[1]=-fabs(mTurnRadius*cell_location[1]/pow(pow(cell_location[0],2)+pow(cell_location[1],2),0.5));
-	}else{
-		mid[1]=fabs(mTurnRadius*cell_location[1]/pow(pow(cell_location[0],2)+pow(cell_location[1],2),0.5));
-	}
-	mid[2]=0;
-	double d1; double d2;
-	HowFarAlongAreYou(end1,d1);
-	HowFarAlongAreYou(mid,d2);
-	if(d2>d1){mid[0]=DBL_MAX;mid[1]=DBL_MAX;mid[2]=DBL_MAX;}
-	double R1=norm_2(end1-cell_location);
-	double R2=norm_2(end2-cell_location);
-	double R3=norm_2(mid-cell_location);
-	dist=std::min(R1,std::min(R2,R3));
-	if(dist==R1){
-		point=end1;
-	}else if(dist==R2){
-		point=end2;
-	}else{
-		point=mid;
-	}
+    double radius = pNode->GetRadius();
+    if (max_R+radius-mCurrentTubeRadius > mMaximumDistance)
+    {
+        return false;
+    }
+    if (max_arc_length <= mStraightLengthLower)
+    {
+        return true;
+    }
+    if (min_arc_length <= mStraightLengthLower)
+    {
+        // The cell may have crossed into the syncytium's part of the arm, or back out of it
+        return false;
+    }
 
+    // The syncytium only widens along the arm, so its radius at the largest possible arc length is the worst case
+    double max_syncytium_radius = GetSyncytiumRadius(max_arc_length);
+    return (radius <= (mCurrentTubeRadius-max_syncytium_radius)/2) && !(min_R-radius < max_syncytium_radius-mMaximumDistance);
 }
 
 
 template<unsigned DIM>
-double CombinedStaticGonadBoundaryCondition<DIM>::GetSyncytiumRadius(double distance){
+double CombinedStaticGonadBoundaryCondition<DIM>::GetSyncytiumRadius(double distance) const{
 	if(distance>mStraightLengthLower+mTurnRadius*M_PI){
 		return (mCurrentTubeRadius-6);
 	}else if(distance>mStraightLengthLower){
@@ -365,6 +429,43 @@ double CombinedStaticGonadBoundaryCondition<DIM>::GetSyncytiumRadius(double dist
 	}
 };
 
+template<unsigned DIM>
+const GonadArmCentreline<DIM>& CombinedStaticGonadBoundaryCondition<DIM>::rGetCentreline() const
+{
+    return mCentreline;
+}
+
+template<unsigned DIM>
+double CombinedStaticGonadBoundaryCondition<DIM>::GetDistalTipArcLength() const
+{
+    return mCentreline.GetTotalLength();
+}
+
+template<unsigned DIM>
+double CombinedStaticGonadBoundaryCondition<DIM>::GetMaxCellRadius(double arcLength) const
+{
+    if (arcLength < mStraightLengthLower-1)
+    {
+        return mCurrentTubeRadius;
+    }
+    return (mCurrentTubeRadius-GetSyncytiumRadius(arcLength)-0.1)/2;
+}
+
+template<unsigned DIM>
+double CombinedStaticGonadBoundaryCondition<DIM>::GetSignedDistance(const c_vector<double, DIM>& rLocation) const
+{
+    c_vector<double, DIM> closest_point;
+    double arc_length;
+    double R = mCentreline.Project(rLocation, closest_point, arc_length);
+
+    // Past the lower straight, cells must also lie outside the syncytium
+    if (arc_length > mStraightLengthLower)
+    {
+        return std::max(R - mCurrentTubeRadius, GetSyncytiumRadius(arc_length) - R);
+    }
+    return R - mCurrentTubeRadius;
+}
+
 template<unsigned DIM>
 void CombinedStaticGonadBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile)
 {
@@ -374,6 +475,8 @@ void CombinedStaticGonadBoundaryCondition<DIM>::OutputCellPopulationBoundaryCond
     *rParamsFile << "\t\t\t<RadiusOfTurn>" << mTurnRadius << "</RadiusOfTurn>\n";
     *rParamsFile << "\t\t\t<RadiusOfTube>" << mCurrentTubeRadius << "</RadiusOfTube>\n";
     *rParamsFile << "\t\t\t<MaximumDistance>" << mMaximumDistance << "</MaximumDistance>\n";
+    *rParamsFile << "\t\t\t<CullInteriorCells>" << mCullInteriorCells << "</CullInteriorCells>\n";
+    *rParamsFile << "\t\t\t<VerifyFromImposedRecord>" << mVerifyFromImposedRecord << "</VerifyFromImposedRecord>\n";
 
     // Call method on direct parent class
     AbstractCellPopulationBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(rParamsFile);
@@ -37,6 +37,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define CombinedStaticGonadBoundaryCondition_HPP_
 
 #include "AbstractCellPopulationBoundaryCondition.hpp"
+#include "GonadArmCentreline.hpp"
+#include "CentrelineProjectionCache.hpp"
+
+#include "ImposedBoundaryConditionRecord.hpp"
+#include "AbstractSignedDistanceFunction.hpp"
+#include "AbstractGonadArmGeometryProvider.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -50,13 +56,14 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * excluded volume at the centre, which cells may not enter. This excluded volume starts out with 6 units
  * smaller radius than the outer tube, and its radius decreases linearly to zero during the turn.
  *
- * As with many boundary conditions for the C. elegans gonad arm project, this boundary condition automatically
- * calculates the distance a cell is along the tube from the upper end, and records it in cell data as
- * DistanceAwayFromDTC. It also records a maximum radius that the cell can grow to at its current position without
- * violating the boundary condition.
+ * The condition only confines cells. It provides its geometry to a GonadArmGeometryModifier, which records how
+ * far along the tube each cell is from the upper end (DistanceAwayFromDTC) and the maximum radius the cell can
+ * grow to at its current position without violating the boundary condition (MaxRadius). If no modifier is
+ * registered, the condition records both in cell data itself while imposing.
  */
 template<unsigned DIM>
-class CombinedStaticGonadBoundaryCondition : public AbstractCellPopulationBoundaryCondition<DIM>
+class CombinedStaticGonadBoundaryCondition : public AbstractCellPopulationBoundaryCondition<DIM>,
+    public AbstractSignedDistanceFunction<DIM>, public AbstractGonadArmGeometryProvider<DIM>
 {
 private:
 
@@ -68,6 +75,64 @@ private:
     /** The maximum distance from the surface of the tube that cells may be. */
     double mMaximumDistance;
 
+    /**
+     * Whether VerifyBoundaryCondition() should reuse the results recorded by ImposeBoundaryCondition(), only
+     * repeating the geometry for nodes that have moved since. Defaults to true. Not archived.
+     */
+    bool mVerifyFromImposedRecord;
+
+    /** The results recorded by the last call to ImposeBoundaryCondition(). Not archived. */
+    ImposedBoundaryConditionRecord<DIM> mImposedRecord;
+
+    /** The centreline of the arm, which closest points are found on. */
+    GonadArmCentreline<DIM> mCentreline;
+
+    /**
+     * Each node's exact projection from previous timesteps, so that cells certainly still between the
+     * syncytium and the tube wall can be skipped. Not archived.
+     */
+    CentrelineProjectionCache<DIM> mProjectionCache;
+
+    /*
+     * Work space filled in by ProjectCells() for each cell: the cell, its node, its location, the closest point
+     * on the centreline, that point's arc length and the distance to it. ImposeBoundaryCondition() also fills in
+     * the nodes and arc lengths (-1 for skipped cells). Not archived.
+     */
+    std::vector<CellPtr> mCells;
+    std::vector<Node<DIM>*> mNodes;
+    std::vector<c_vector<double, DIM> > mLocations;
+    std::vector<c_vector<double, DIM> > mClosestPoints;
+    std::vector<double> mArcLengths;
+    std::vector<double> mDistances;
+
+    /** The radius of the syncytium at each cell's closest point, filled in by ProjectCells(). Not archived. */
+    std::vector<double> mSyncytiumRadii;
+
+    /**
+     * Whether ImposeBoundaryCondition() should skip cells that the projection cache shows are certainly still
+     * satisfied, rather than projecting every cell. Defaults to true. Not archived.
+     */
+    bool mCullInteriorCells;
+
+    /** The number of cells skipped by the last call to ImposeBoundaryCondition(). Not archived. */
+    unsigned mNumCellsCulled;
+
+    /** The number of cells the last call to ImposeBoundaryCondition() was imposed on. Not archived. */
+    unsigned mNumCellsImposed;
+
+    /*
+     * Whether ImposeBoundaryCondition() moved and whether it skipped each cell in mNodes. Not std::vector<bool>,
+     * so that different threads can write different cells. Not archived.
+     */
+    std::vector<unsigned char> mWasMoved;
+    std::vector<unsigned char> mWasCulled;
+
+    /**
+     * The number of threads ImposeBoundaryCondition() shares the cells between. Defaults to 1. Not archived, as
+     * it depends on the machine.
+     */
+    unsigned mNumberOfThreads;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -120,6 +185,51 @@ public:
      */
     bool VerifyBoundaryCondition();
 
+    /**
+     * Set mVerifyFromImposedRecord.
+     *
+     * @param verifyFromImposedRecord whether VerifyBoundaryCondition() should reuse the results of ImposeBoundaryCondition()
+     */
+    void SetVerifyFromImposedRecord(bool verifyFromImposedRecord);
+
+    /**
+     * @return mVerifyFromImposedRecord
+     */
+    bool GetVerifyFromImposedRecord() const;
+
+    /**
+     * Overridden GetSignedDistance() method.
+     *
+     * @return the signed distance from a location to the surface of the region between the tube and the
+     * syncytium (negative inside).
+     *
+     * @param rLocation the location
+     */
+    double GetSignedDistance(const c_vector<double, DIM>& rLocation) const;
+
+    /**
+     * Overridden rGetCentreline() method.
+     *
+     * @return the centreline of the arm
+     */
+    const GonadArmCentreline<DIM>& rGetCentreline() const;
+
+    /**
+     * Overridden GetDistalTipArcLength() method.
+     *
+     * @return the total length of the centreline, as the arm is fully grown
+     */
+    double GetDistalTipArcLength() const;
+
+    /**
+     * Overridden GetMaxCellRadius() method.
+     *
+     * @return the largest radius a cell can grow to at a given arc length without violating the condition
+     *
+     * @param arcLength the arc length of the cell's closest point on the centreline
+     */
+    double GetMaxCellRadius(double arcLength) const;
+
     /**
      * Overridden OutputCellPopulationBoundaryConditionParameters() method.
      * Output cell population boundary condition parameters to file.
@@ -128,20 +238,95 @@ public:
      */
     void OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile);
 
+    /**
+     * Set mCullInteriorCells.
+     *
+     * @param cullInteriorCells whether to skip cells that are certainly still satisfied
+     */
+    void SetCullInteriorCells(bool cullInteriorCells);
+
+    /**
+     * @return mCullInteriorCells
+     */
+    bool GetCullInteriorCells() const;
+
+    /**
+     * @return the number of cells skipped by the last call to ImposeBoundaryCondition()
+     */
+    unsigned GetNumCellsCulled() const;
+
+    /**
+     * @return the number of cells the last call to ImposeBoundaryCondition() was imposed on
+     */
+    unsigned GetNumCellsImposed() const;
+
+    /**
+     * Set mNumberOfThreads. Has no effect on speed unless the code is built with OpenMP (see README.md).
+     *
+     * @param numberOfThreads the new value of mNumberOfThreads
+     */
+    void SetNumberOfThreads(unsigned numberOfThreads);
+
+    /**
+     * @return mNumberOfThreads
+     */
+    unsigned GetNumberOfThreads() const;
+
+
     /*Functions returning the current parameter values*/
     double GetStraightLengthLower() const;
     double GetStraightLengthUpper() const;
     double GetTurnRadius() const;
     double GetCurrentTubeRadius() const;
 
+    /**
+     * @return the radius of the syncytium (the excluded volume at the centre of the tube) at a given arc length
+     *
+     * @param dist the arc length from the proximal end
+     */
+    double GetSyncytiumRadius(double dist) const;
+
+    /**
+     * Gather every cell and its node and location.
+     */
+    void GatherCells();
+
+    /**
+     * Gather every cell's node and location, and project the locations onto the centreline in one batch.
+     */
+    void ProjectCells();
+
+    /**
+     * Impose the condition on one node, unless the projection cache shows it is certainly satisfied. Only
+     * touches the node and its cache entry, so may be called for different nodes at once.
+     *
+     * A cell too big to fit where it has moved to, past the lower straight, is put back where it was before the
+     * positions were last updated. If that location is not known, it is confined like any other cell.
+     *
+     * @param pNode the node
+     * @param pOldLocation the node's location before the positions were last updated, or NULL if not known
+     * @param rArcLength filled in with the arc length of the node's closest point, or -1 if it was skipped
+     * @param rWasCulled filled in with whether the node was skipped
+     * @return whether the node was moved
+     */
+    bool ImposeOnNode(Node<DIM>* pNode, const c_vector<double, DIM>* pOldLocation, double& rArcLength, bool& rWasCulled);
 
-    /*Utility functions for calculating closest points on different parts of the gonad arm to a cell centre*/
-    void GetClosestOnLowerStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist);
-    void GetClosestOnUpperStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist);
-    void GetClosestOnLoop(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist);
-    /*And for calculating how far along the gonad arm a point on the growth path is */
-    void HowFarAlongAreYou(c_vector<double, DIM> point, double& dist);
-    double GetSyncytiumRadius(double dist);
+    /**
+     * @return whether a cell satisfies the condition
+     *
+     * @param distance the distance from the cell centre to its closest point on the centreline
+     * @param radius the radius of the cell
+     * @param arcLength the arc length of the closest point
+     */
+    bool IsSatisfied(double distance, double radius, double arcLength);
+
+    /**
+     * @return whether a cell certainly satisfies the condition and would not be moved by
+     * ImposeBoundaryCondition(), judging from the bounds the projection cache gives on its distance and arc length
+     *
+     * @param pNode the cell's node
+     */
+    bool IsCertainlySatisfied(Node<DIM>* pNode);
 };
 
 #include "SerializationExportWrapper.hpp"
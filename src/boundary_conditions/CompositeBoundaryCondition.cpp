@@ -0,0 +1,332 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CompositeBoundaryCondition.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include <ctime>
+
+template<unsigned DIM>
+CompositeBoundaryCondition<DIM>::CompositeBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation, double distance)
+    : AbstractCellPopulationBoundaryCondition<DIM>(pCellPopulation),
+      mMaximumDistance(distance),
+      mUseCellRadii(true),
+      mMaxIterations(10),
+      mGradientStep(1e-4),
+      mRecordTimings(false),
+      mVerifyFromImposedRecord(true)
+{
+    assert(mMaximumDistance > 0.0);
+
+    if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation) == NULL)
+    {
+        EXCEPTION("A NodeBasedCellPopulation must be used with this boundary condition object.");
+    }
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::AddShape(boost::shared_ptr<AbstractSignedDistanceFunction<DIM> > pShape)
+{
+    assert(pShape);
+    mShapes.push_back(pShape);
+    mNumEvaluations.push_back(0);
+    mNumMoves.push_back(0);
+    mEvaluationTimes.push_back(0.0);
+}
+
+template<unsigned DIM>
+unsigned CompositeBoundaryCondition<DIM>::GetNumShapes() const
+{
+    return mShapes.size();
+}
+
+template<unsigned DIM>
+double CompositeBoundaryCondition<DIM>::GetMaximumDistance() const
+{
+    return mMaximumDistance;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::SetUseCellRadii(bool useCellRadii)
+{
+    mUseCellRadii = useCellRadii;
+}
+
+template<unsigned DIM>
+bool CompositeBoundaryCondition<DIM>::GetUseCellRadii() const
+{
+    return mUseCellRadii;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::SetMaxIterations(unsigned maxIterations)
+{
+    assert(maxIterations > 0);
+    mMaxIterations = maxIterations;
+}
+
+template<unsigned DIM>
+unsigned CompositeBoundaryCondition<DIM>::GetMaxIterations() const
+{
+    return mMaxIterations;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::SetGradientStep(double gradientStep)
+{
+    assert(gradientStep > 0.0);
+    mGradientStep = gradientStep;
+}
+
+template<unsigned DIM>
+double CompositeBoundaryCondition<DIM>::GetGradientStep() const
+{
+    return mGradientStep;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::SetRecordTimings(bool recordTimings)
+{
+    mRecordTimings = recordTimings;
+}
+
+template<unsigned DIM>
+bool CompositeBoundaryCondition<DIM>::GetRecordTimings() const
+{
+    return mRecordTimings;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::SetVerifyFromImposedRecord(bool verifyFromImposedRecord)
+{
+    mVerifyFromImposedRecord = verifyFromImposedRecord;
+}
+
+template<unsigned DIM>
+bool CompositeBoundaryCondition<DIM>::GetVerifyFromImposedRecord() const
+{
+    return mVerifyFromImposedRecord;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::ResetCounters()
+{
+    mNumEvaluations.assign(mShapes.size(), 0);
+    mNumMoves.assign(mShapes.size(), 0);
+    mEvaluationTimes.assign(mShapes.size(), 0.0);
+}
+
+template<unsigned DIM>
+unsigned CompositeBoundaryCondition<DIM>::GetNumEvaluations(unsigned shapeIndex) const
+{
+    assert(shapeIndex < mShapes.size());
+    return mNumEvaluations[shapeIndex];
+}
+
+template<unsigned DIM>
+unsigned CompositeBoundaryCondition<DIM>::GetNumMoves(unsigned shapeIndex) const
+{
+    assert(shapeIndex < mShapes.size());
+    return mNumMoves[shapeIndex];
+}
+
+template<unsigned DIM>
+double CompositeBoundaryCondition<DIM>::GetEvaluationTime(unsigned shapeIndex) const
+{
+    assert(shapeIndex < mShapes.size());
+    return mEvaluationTimes[shapeIndex];
+}
+
+template<unsigned DIM>
+double CompositeBoundaryCondition<DIM>::EvaluateShape(unsigned shapeIndex, const c_vector<double, DIM>& rLocation)
+{
+    mNumEvaluations[shapeIndex]++;
+    if (!mRecordTimings)
+    {
+        return mShapes[shapeIndex]->GetSignedDistance(rLocation);
+    }
+
+    std::clock_t start = std::clock();
+    double distance = mShapes[shapeIndex]->GetSignedDistance(rLocation);
+    mEvaluationTimes[shapeIndex] += double(std::clock() - start)/CLOCKS_PER_SEC;
+    return distance;
+}
+
+template<unsigned DIM>
+bool CompositeBoundaryCondition<DIM>::IsSatisfied(Node<DIM>* pNode)
+{
+    double radius = mUseCellRadii ? pNode->GetRadius() : 0.0;
+    for (unsigned shape=0; shape<mShapes.size(); shape++)
+    {
+        if (EvaluateShape(shape, pNode->rGetLocation()) + radius > mMaximumDistance)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*Checks whether each cell lies inside every shape. If not, moves it back inside each shape in turn until it lies inside them all*/
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+{
+    mImposedRecord.Clear();
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
+         cell_iter != this->mpCellPopulation->End();
+         ++cell_iter)
+    {
+        Node<DIM>* p_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+        double radius = mUseCellRadii ? p_node->GetRadius() : 0.0;
+        c_vector<double, DIM>& r_location = p_node->rGetModifiableLocation();
+        bool was_moved = false;
+        bool is_satisfied = false;
+
+        /*
+         * Sweep over the shapes, moving the cell back inside each one it is too far outside of. Moving it into
+         * one shape may move it out of another, so sweep again until a sweep finds it inside them all; the last
+         * sweep allowed only checks.
+         */
+        for (unsigned sweep=0; sweep<=mMaxIterations; sweep++)
+        {
+            is_satisfied = true;
+            for (unsigned shape=0; shape<mShapes.size(); shape++)
+            {
+                double distance = EvaluateShape(shape, r_location);
+                if (distance + radius <= mMaximumDistance)
+                {
+                    continue;
+                }
+                is_satisfied = false;
+                if (sweep == mMaxIterations)
+                {
+                    break;
+                }
+
+                // Estimate the gradient of the distance by central differences, then take a Newton step to the surface
+                c_vector<double, DIM> gradient;
+                for (unsigned d=0; d<DIM; d++)
+                {
+                    c_vector<double, DIM> offset = r_location;
+                    offset[d] += mGradientStep;
+                    double distance_above = EvaluateShape(shape, offset);
+                    offset[d] -= 2.0*mGradientStep;
+                    double distance_below = EvaluateShape(shape, offset);
+                    gradient[d] = (distance_above - distance_below)/(2.0*mGradientStep);
+                }
+                double gradient_squared = inner_prod(gradient, gradient);
+                if (gradient_squared == 0.0)
+                {
+                    // A flat spot in the distance gives no direction to move in
+                    continue;
+                }
+                r_location -= ((distance + radius)/gradient_squared)*gradient;
+                mNumMoves[shape]++;
+                was_moved = true;
+            }
+            if (is_satisfied)
+            {
+                break;
+            }
+        }
+
+        // Record the result for VerifyBoundaryCondition()
+        mImposedRecord.Record(p_node, was_moved, is_satisfied);
+    }
+}
+
+//Check boundary condition is now satisfied
+template<unsigned DIM>
+bool CompositeBoundaryCondition<DIM>::VerifyBoundaryCondition()
+{
+    bool condition_satisfied = true;
+
+    if (mVerifyFromImposedRecord && mImposedRecord.IsValid(this->mpCellPopulation->GetNumRealCells()))
+    {
+        // Only cells that have moved since ImposeBoundaryCondition() checked them need evaluating again
+        for (unsigned i=0; i<mImposedRecord.GetNumRecords(); i++)
+        {
+            bool is_satisfied = mImposedRecord.NeedsChecking(i) ? IsSatisfied(mImposedRecord.GetNode(i))
+                                                                 : mImposedRecord.WasSatisfied(i);
+            if (!is_satisfied)
+            {
+                condition_satisfied = false;
+                break;
+            }
+        }
+    }
+    else
+    {
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
+             cell_iter != this->mpCellPopulation->End();
+             ++cell_iter)
+        {
+            Node<DIM>* p_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+            if (!IsSatisfied(p_node))
+            {
+                condition_satisfied = false;
+                break;
+            }
+        }
+    }
+
+    mImposedRecord.Invalidate();
+    return condition_satisfied;
+}
+
+template<unsigned DIM>
+void CompositeBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<NumberOfShapes>" << mShapes.size() << "</NumberOfShapes>\n";
+    *rParamsFile << "\t\t\t<MaximumDistance>" << mMaximumDistance << "</MaximumDistance>\n";
+    *rParamsFile << "\t\t\t<UseCellRadii>" << mUseCellRadii << "</UseCellRadii>\n";
+    *rParamsFile << "\t\t\t<MaxIterations>" << mMaxIterations << "</MaxIterations>\n";
+    *rParamsFile << "\t\t\t<GradientStep>" << mGradientStep << "</GradientStep>\n";
+    *rParamsFile << "\t\t\t<VerifyFromImposedRecord>" << mVerifyFromImposedRecord << "</VerifyFromImposedRecord>\n";
+
+    // Call method on direct parent class
+    AbstractCellPopulationBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(rParamsFile);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class CompositeBoundaryCondition<1>;
+template class CompositeBoundaryCondition<2>;
+template class CompositeBoundaryCondition<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(CompositeBoundaryCondition)
@@ -0,0 +1,318 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef COMPOSITEBOUNDARYCONDITION_HPP_
+#define COMPOSITEBOUNDARYCONDITION_HPP_
+
+#include "AbstractCellPopulationBoundaryCondition.hpp"
+#include "AbstractSignedDistanceFunction.hpp"
+
+#include "ImposedBoundaryConditionRecord.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+/**
+ * A boundary condition confining cells to the intersection of several shapes, such as an outer tube and an
+ * inner exclusion, or the inside of one ellipsoid and the outside of another. Each shape is given by its signed
+ * distance function (negative where cells may lie), which the analytic boundary conditions and
+ * SignedDistanceField all provide.
+ *
+ * All the shapes are applied to each cell in one pass over the population, rather than one pass per boundary
+ * condition. A cell too far outside a shape is moved back along the (finite difference) gradient of that
+ * shape's distance, and the shapes are swept in turn until the cell satisfies them all or mMaxIterations sweeps
+ * have been made. The number of evaluations and moves for each shape are counted, and optionally the time spent
+ * evaluating it.
+ *
+ * The shapes are not archived, so must be added again after a simulation is loaded.
+ */
+template<unsigned DIM>
+class CompositeBoundaryCondition : public AbstractCellPopulationBoundaryCondition<DIM>
+{
+private:
+
+    /** The shapes, each negative where cells may lie. Not archived. */
+    std::vector<boost::shared_ptr<AbstractSignedDistanceFunction<DIM> > > mShapes;
+
+    /** The maximum distance outside each shape that cells may be. */
+    double mMaximumDistance;
+
+    /** Whether a cell's radius should be kept inside each shape too. Defaults to true. */
+    bool mUseCellRadii;
+
+    /** The maximum number of sweeps over the shapes used to move a cell back inside them all. Defaults to 10. */
+    unsigned mMaxIterations;
+
+    /** The step used to estimate the gradient of each shape's distance by central differences. Defaults to 1e-4. */
+    double mGradientStep;
+
+    /** Whether to time the evaluations of each shape. Defaults to false. Not archived. */
+    bool mRecordTimings;
+
+    /**
+     * Whether VerifyBoundaryCondition() should reuse the results recorded by ImposeBoundaryCondition(), only
+     * repeating the evaluation for nodes that have moved since. Defaults to true. Not archived.
+     */
+    bool mVerifyFromImposedRecord;
+
+    /** The results recorded by the last call to ImposeBoundaryCondition(). Not archived. */
+    ImposedBoundaryConditionRecord<DIM> mImposedRecord;
+
+    /*
+     * For each shape, the number of times its distance has been evaluated, the number of times a cell has been
+     * moved back inside it, and the time in seconds spent evaluating it, since the counters were reset. Not
+     * archived.
+     */
+    std::vector<unsigned> mNumEvaluations;
+    std::vector<unsigned> mNumMoves;
+    std::vector<double> mEvaluationTimes;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellPopulationBoundaryCondition<DIM> >(*this);
+        archive & mUseCellRadii;
+        archive & mMaxIterations;
+        archive & mGradientStep;
+    }
+
+    /**
+     * @return the signed distance from a location to one of the shapes, updating that shape's counters.
+     *
+     * @param shapeIndex the index of the shape
+     * @param rLocation the location
+     */
+    double EvaluateShape(unsigned shapeIndex, const c_vector<double, DIM>& rLocation);
+
+    /**
+     * @return whether a node lies close enough to every shape.
+     *
+     * @param pNode the node
+     */
+    bool IsSatisfied(Node<DIM>* pNode);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param pCellPopulation pointer to the cell population
+     * @param distance the maximum distance outside each shape that cells may be (defaults to 1e-5)
+     */
+    CompositeBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation, double distance=1e-5);
+
+    /**
+     * Add a shape that cells must lie inside.
+     *
+     * @param pShape the shape's signed distance function
+     */
+    void AddShape(boost::shared_ptr<AbstractSignedDistanceFunction<DIM> > pShape);
+
+    /**
+     * @return the number of shapes
+     */
+    unsigned GetNumShapes() const;
+
+    /**
+     * @return mMaximumDistance
+     */
+    double GetMaximumDistance() const;
+
+    /**
+     * Set mUseCellRadii.
+     *
+     * @param useCellRadii whether a cell's radius should be kept inside each shape too
+     */
+    void SetUseCellRadii(bool useCellRadii);
+
+    /**
+     * @return mUseCellRadii
+     */
+    bool GetUseCellRadii() const;
+
+    /**
+     * Set mMaxIterations.
+     *
+     * @param maxIterations the maximum number of sweeps over the shapes (at least 1)
+     */
+    void SetMaxIterations(unsigned maxIterations);
+
+    /**
+     * @return mMaxIterations
+     */
+    unsigned GetMaxIterations() const;
+
+    /**
+     * Set mGradientStep.
+     *
+     * @param gradientStep the step used to estimate gradients (positive)
+     */
+    void SetGradientStep(double gradientStep);
+
+    /**
+     * @return mGradientStep
+     */
+    double GetGradientStep() const;
+
+    /**
+     * Set mRecordTimings.
+     *
+     * @param recordTimings whether to time the evaluations of each shape
+     */
+    void SetRecordTimings(bool recordTimings);
+
+    /**
+     * @return mRecordTimings
+     */
+    bool GetRecordTimings() const;
+
+    /**
+     * Set mVerifyFromImposedRecord.
+     *
+     * @param verifyFromImposedRecord whether VerifyBoundaryCondition() should reuse the results of ImposeBoundaryCondition()
+     */
+    void SetVerifyFromImposedRecord(bool verifyFromImposedRecord);
+
+    /**
+     * @return mVerifyFromImposedRecord
+     */
+    bool GetVerifyFromImposedRecord() const;
+
+    /**
+     * Reset the counters and timings of every shape.
+     */
+    void ResetCounters();
+
+    /**
+     * @return the number of times a shape's distance has been evaluated since the counters were reset
+     *
+     * @param shapeIndex the index of the shape
+     */
+    unsigned GetNumEvaluations(unsigned shapeIndex) const;
+
+    /**
+     * @return the number of times a cell has been moved back inside a shape since the counters were reset
+     *
+     * @param shapeIndex the index of the shape
+     */
+    unsigned GetNumMoves(unsigned shapeIndex) const;
+
+    /**
+     * @return the time in seconds spent evaluating a shape since the counters were reset (zero unless
+     * mRecordTimings is set)
+     *
+     * @param shapeIndex the index of the shape
+     */
+    double GetEvaluationTime(unsigned shapeIndex) const;
+
+    /**
+     * Overridden ImposeBoundaryCondition() method.
+     * Apply the cell population boundary conditions.
+     *
+     * @param rOldLocations the node locations before any boundary conditions are applied
+     */
+    void ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations);
+
+    /**
+     * Overridden VerifyBoundaryCondition() method.
+     * Verify the boundary conditions have been applied.
+     * This is called after ImposeBoundaryCondition() to ensure the condition is still satisfied.
+     *
+     * @return whether the boundary conditions are satisfied.
+     */
+    bool VerifyBoundaryCondition();
+
+    /**
+     * Overridden OutputCellPopulationBoundaryConditionParameters() method.
+     * Output cell population boundary condition parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(CompositeBoundaryCondition)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a CompositeBoundaryCondition.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const CompositeBoundaryCondition<DIM>* t, const BOOST_PFTO unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* const p_cell_population = t->GetCellPopulation();
+    ar << p_cell_population;
+
+    double distance = t->GetMaximumDistance();
+    ar << distance;
+}
+
+/**
+ * De-serialize constructor parameters and initialize a CompositeBoundaryCondition.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, CompositeBoundaryCondition<DIM>* t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    double distance;
+    ar >> distance;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)CompositeBoundaryCondition<DIM>(p_cell_population, distance);
+}
+}
+} // namespace ...
+
+#endif /*COMPOSITEBOUNDARYCONDITION_HPP_*/
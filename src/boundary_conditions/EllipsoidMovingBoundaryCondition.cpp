@@ -49,7 +49,8 @@ EllipsoidMovingBoundaryCondition<DIM>::EllipsoidMovingBoundaryCondition(Abstract
       mA(A),
       mB(B),
       mC(C),
-      mMaximumDistance(distance)
+      mMaximumDistance(distance),
+      mVerifyFromImposedRecord(true)
 {
 	/*Assert all three ellipse Radii are positive*/
     assert(mA > 0.0);
@@ -57,6 +58,9 @@ EllipsoidMovingBoundaryCondition<DIM>::EllipsoidMovingBoundaryCondition(Abstract
     assert(mC > 0.0);
     assert(mMaximumDistance > 0.0);
 
+    double start_time = SimulationTime::Instance()->IsStartTimeSetUp() ? SimulationTime::Instance()->GetTime() : 0.0;
+    mCSchedule.SetLinear(start_time, mC, 0.02);
+
     if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation) == NULL)
     {
         EXCEPTION("A NodeBasedCellPopulation must be used with this boundary condition object.");
@@ -90,14 +94,68 @@ double EllipsoidMovingBoundaryCondition<DIM>::rGetB() const
 template<unsigned DIM>
 double EllipsoidMovingBoundaryCondition<DIM>::rGetC() const
 {
-    return mC;
+    return mCSchedule.GetCurrentValue();
+}
+
+
+template<unsigned DIM>
+void EllipsoidMovingBoundaryCondition<DIM>::SetVerifyFromImposedRecord(bool verifyFromImposedRecord)
+{
+    mVerifyFromImposedRecord = verifyFromImposedRecord;
 }
 
+template<unsigned DIM>
+bool EllipsoidMovingBoundaryCondition<DIM>::GetVerifyFromImposedRecord() const
+{
+    return mVerifyFromImposedRecord;
+}
 
-/*Example update function. The radius C is increased by Dt each timestep.*/
+
+/*Update function. The radius C follows its schedule, so is simply evaluated at the current time.*/
 template<unsigned DIM>
 void EllipsoidMovingBoundaryCondition<DIM>::UpdateBoundaryCondition(){
-	mC=mC+SimulationTime::Instance()->GetTimeStep()*0.02;
+	RefreshGeometry();
+}
+
+template<unsigned DIM>
+void EllipsoidMovingBoundaryCondition<DIM>::RefreshGeometry()
+{
+    mC = mCSchedule.GetCurrentValue();
+}
+
+template<unsigned DIM>
+bool EllipsoidMovingBoundaryCondition<DIM>::IsFrozen() const
+{
+    return mCSchedule.IsFinished();
+}
+
+template<unsigned DIM>
+void EllipsoidMovingBoundaryCondition<DIM>::SetGrowthRate(double growthRate)
+{
+    if (growthRate < 0.0)
+    {
+        EXCEPTION("The growth rate of the ellipsoid must be non-negative");
+    }
+    double start_time = SimulationTime::Instance()->IsStartTimeSetUp() ? SimulationTime::Instance()->GetTime() : 0.0;
+    mCSchedule.SetLinear(start_time, rGetC(), growthRate);
+    RefreshGeometry();
+}
+
+template<unsigned DIM>
+void EllipsoidMovingBoundaryCondition<DIM>::SetCSchedule(const GrowthSchedule& rSchedule)
+{
+    if (rSchedule.GetMinValue() <= 0.0)
+    {
+        EXCEPTION("The radius C of the ellipsoid must stay positive");
+    }
+    mCSchedule = rSchedule;
+    RefreshGeometry();
+}
+
+template<unsigned DIM>
+const GrowthSchedule& EllipsoidMovingBoundaryCondition<DIM>::rGetCSchedule() const
+{
+    return mCSchedule;
 }
 
 
@@ -109,6 +167,9 @@ void EllipsoidMovingBoundaryCondition<DIM>::UpdateBoundaryCondition(){
 template<unsigned DIM>
 void EllipsoidMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
 {
+    RefreshGeometry();
+    mImposedRecord.Clear();
+
     // Iterate over the cell population
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
          cell_iter != this->mpCellPopulation->End();
@@ -121,6 +182,10 @@ void EllipsoidMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::m
                		+pow((cell_location[2]-mCentre[2]),2)/(mC*mC);
         assert(R != 0.0); //Can't project the centre to anywhere sensible
 
+        unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
+        Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
+        bool is_satisfied = true;
+
         // If the cell is too far from the surface of the ellipsoid...
         if (R > 1+mMaximumDistance)
         {
@@ -129,11 +194,12 @@ void EllipsoidMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::m
             c_vector<double, DIM> location_on_Ellipsoid;
             location_on_Ellipsoid=mCentre+(cell_location-mCentre)/sqrt(R);
 
-            unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
-            Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
-
             p_node->rGetModifiableLocation() = location_on_Ellipsoid;
+            is_satisfied = false;
         }
+
+        // Record the result for VerifyBoundaryCondition(); a cell that was not moved was already satisfied
+        mImposedRecord.Record(p_node, !is_satisfied, is_satisfied);
     }
 }
 
@@ -143,8 +209,35 @@ void EllipsoidMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::m
 template<unsigned DIM>
 bool EllipsoidMovingBoundaryCondition<DIM>::VerifyBoundaryCondition()
 {
+    RefreshGeometry();
     bool condition_satisfied = true;
 
+    if (mVerifyFromImposedRecord && mImposedRecord.IsValid(this->mpCellPopulation->GetNumRealCells()))
+    {
+        // Only cells that have moved since ImposeBoundaryCondition() checked them need checking again
+        for (unsigned i=0; i<mImposedRecord.GetNumRecords(); i++)
+        {
+            bool is_satisfied = mImposedRecord.WasSatisfied(i);
+            if (mImposedRecord.NeedsChecking(i))
+            {
+                const c_vector<double,DIM>& r_location = mImposedRecord.GetNode(i)->rGetLocation();
+                double R = pow(r_location[0]-mCentre[0],2)/(mA*mA)
+                        +pow(r_location[1]-mCentre[1],2)/(mB*mB)
+                        +pow(r_location[2]-mCentre[2],2)/(mC*mC);
+                is_satisfied = !(R > 1+mMaximumDistance);
+            }
+
+            if (!is_satisfied)
+            {
+                // ...then the boundary condition is not satisfied. Panic.
+                condition_satisfied = false;
+                break;
+            }
+        }
+        mImposedRecord.Invalidate();
+        return condition_satisfied;
+    }
+
     // Iterate over the cell population
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
          cell_iter != this->mpCellPopulation->End();
@@ -164,10 +257,24 @@ bool EllipsoidMovingBoundaryCondition<DIM>::VerifyBoundaryCondition()
             break;
         }
     }
+    mImposedRecord.Invalidate();
     return condition_satisfied;
 }
 
 
+template<unsigned DIM>
+double EllipsoidMovingBoundaryCondition<DIM>::GetSignedDistance(const c_vector<double, DIM>& rLocation) const
+{
+    double c = rGetC();
+    double R = pow(rLocation[0]-mCentre[0],2)/(mA*mA)
+            +pow(rLocation[1]-mCentre[1],2)/(mB*mB)
+            +pow(rLocation[2]-mCentre[2],2)/(c*c);
+    assert(R != 0.0);
+
+    // The distance to the point the location would be scaled onto
+    return norm_2(rLocation-mCentre)*(1.0 - 1.0/sqrt(R));
+}
+
 template<unsigned DIM>
 void EllipsoidMovingBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile)
 {
@@ -180,9 +287,10 @@ void EllipsoidMovingBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditio
 
     *rParamsFile << "\t\t\t<RadiusA>" << mA << "</RadiusA>\n";
     *rParamsFile << "\t\t\t<RadiusB>" << mB << "</RadiusB>\n";
-    *rParamsFile << "\t\t\t<RadiusC>" << mC << "</RadiusC>\n";
+    *rParamsFile << "\t\t\t<RadiusC>" << rGetC() << "</RadiusC>\n";
 
     *rParamsFile << "\t\t\t<MaximumDistance>" << mMaximumDistance << "</MaximumDistance>\n";
+    *rParamsFile << "\t\t\t<VerifyFromImposedRecord>" << mVerifyFromImposedRecord << "</VerifyFromImposedRecord>\n";
 
     // Call method on direct parent class
     AbstractMovingBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(rParamsFile);
@@ -39,6 +39,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AbstractMovingBoundaryCondition.hpp"
 
+#include "ImposedBoundaryConditionRecord.hpp"
+#include "AbstractSignedDistanceFunction.hpp"
+#include "GrowthSchedule.hpp"
+
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/vector.hpp>
@@ -48,9 +52,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * as determined by the function UpdateBoundaryCondition, which is called at each timestep by a moving
  * boundary modifier. Inherits from AbstractMovingBoundaryCondition. 3D only.
  *
+ * The radius C is given by a GrowthSchedule of absolute simulation time, by default growing linearly at
+ * 0.01 per unit time from the value given to the constructor, and is evaluated whenever the geometry is needed.
+ *
  * */
 template<unsigned DIM>
-class EllipsoidOutsideMovingBoundaryCondition : public AbstractMovingBoundaryCondition<DIM>
+class EllipsoidOutsideMovingBoundaryCondition : public AbstractMovingBoundaryCondition<DIM>, public AbstractSignedDistanceFunction<DIM>
 {
 private:
 
@@ -60,9 +67,21 @@ private:
     double mB;
     double mC;
 
+    /** The radius C as a function of simulation time; mC is its value when the geometry was last needed. */
+    GrowthSchedule mCSchedule;
+
     /** The maximum distance from the surface of the ellipsoid that cells may be. */
     double mMaximumDistance;
 
+    /**
+     * Whether VerifyBoundaryCondition() should reuse the results recorded by ImposeBoundaryCondition(), only
+     * repeating the geometry for nodes that have moved since. Defaults to true. Not archived.
+     */
+    bool mVerifyFromImposedRecord;
+
+    /** The results recorded by the last call to ImposeBoundaryCondition(). Not archived. */
+    ImposedBoundaryConditionRecord<DIM> mImposedRecord;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -76,8 +95,14 @@ private:
     {
         archive & boost::serialization::base_object<AbstractMovingBoundaryCondition<DIM> >(*this);
         archive & mMaximumDistance;
+        archive & mCSchedule;
     }
 
+    /**
+     * Set mC to the value of mCSchedule at the current simulation time.
+     */
+    void RefreshGeometry();
+
 public:
 
     /**
@@ -109,10 +134,36 @@ public:
      double rGetC() const;
 
      /**
-      * @update parameters as desired each timestep.
+      * @update parameters as desired each timestep. Evaluates the schedule for C at the current time.
       */
      void UpdateBoundaryCondition();
 
+    /**
+     * Overridden IsFrozen() method.
+     *
+     * @return whether the schedule for C has finished
+     */
+    bool IsFrozen() const;
+
+    /**
+     * Grow C linearly at a given rate from its current value, replacing its schedule.
+     *
+     * @param growthRate the increase in C per unit time
+     */
+    void SetGrowthRate(double growthRate);
+
+    /**
+     * Replace the schedule for C.
+     *
+     * @param rSchedule the new schedule, whose values must all be positive
+     */
+    void SetCSchedule(const GrowthSchedule& rSchedule);
+
+    /**
+     * @return mCSchedule
+     */
+    const GrowthSchedule& rGetCSchedule() const;
+
     /**
      * Overridden ImposeBoundaryCondition() method.
      * Apply the cell population boundary conditions.
@@ -130,6 +181,28 @@ public:
      */
     bool VerifyBoundaryCondition();
 
+    /**
+     * Set mVerifyFromImposedRecord.
+     *
+     * @param verifyFromImposedRecord whether VerifyBoundaryCondition() should reuse the results of ImposeBoundaryCondition()
+     */
+    void SetVerifyFromImposedRecord(bool verifyFromImposedRecord);
+
+    /**
+     * @return mVerifyFromImposedRecord
+     */
+    bool GetVerifyFromImposedRecord() const;
+
+    /**
+     * Overridden GetSignedDistance() method.
+     *
+     * @return an estimate of the signed distance from a location to the ellipsoid, negative outside, found
+     * by scaling towards the centre as in ImposeBoundaryCondition().
+     *
+     * @param rLocation the location
+     */
+    double GetSignedDistance(const c_vector<double, DIM>& rLocation) const;
+
     /**
      * Overridden OutputCellPopulationBoundaryConditionParameters() method.
      * Output cell population boundary condition parameters to file.
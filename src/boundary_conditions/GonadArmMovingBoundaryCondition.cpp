@@ -35,6 +35,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "GonadArmMovingBoundaryCondition.hpp"
 #include "NodeBasedCellPopulation.hpp"
+#include <algorithm>
 #define PI 3.1415926
 
 template<unsigned DIM>
@@ -58,7 +59,14 @@ GonadArmMovingBoundaryCondition<DIM>::GonadArmMovingBoundaryCondition(AbstractCe
       mFinalTubeRadius(FinalTubeRadius),
       mGrowthRateLinear(GrowthRateLinear),
       mGrowthRateRadial(GrowthRateRadial),
-      mMaximumDistance(distance)
+      mMaximumDistance(distance),
+      mVerifyFromImposedRecord(true),
+      mCentreline(StraightLengthLower, StraightLengthUpper, TurnRadius),
+      mProjectionCache(mCentreline),
+      mCullInteriorCells(true),
+      mNumCellsCulled(0),
+      mNumCellsImposed(0),
+      mNumberOfThreads(1)
 {
 	if(mCurrentLength>mFinalLength){
 		mCurrentLength=mFinalLength;
@@ -74,6 +82,11 @@ GonadArmMovingBoundaryCondition<DIM>::GonadArmMovingBoundaryCondition(AbstractCe
     assert(mTurnRadius > mFinalTubeRadius); //avoid top tube merging with bottom tube
     assert(mStraightLengthUpper <= mStraightLengthLower-mFinalTubeRadius); //avoid distal tip colliding with cell killer
 
+    // Grow at the given rates from now, stopping exactly at the final length and radius
+    double start_time = SimulationTime::Instance()->IsStartTimeSetUp() ? SimulationTime::Instance()->GetTime() : 0.0;
+    mLengthSchedule.SetLinear(start_time, mCurrentLength, mGrowthRateLinear, mFinalLength);
+    mRadiusSchedule.SetLinear(start_time, mCurrentTubeRadius, mGrowthRateRadial, mFinalTubeRadius);
+
     if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation) == NULL)
     {
         EXCEPTION("A NodeBasedCellPopulation must be used with this boundary condition object.");
@@ -89,7 +102,7 @@ GonadArmMovingBoundaryCondition<DIM>::GonadArmMovingBoundaryCondition(AbstractCe
 template<unsigned DIM>
 double GonadArmMovingBoundaryCondition<DIM>::GetCurrentLength() const
 {
-    return mCurrentLength;
+    return std::min(mLengthSchedule.GetCurrentValue(), mFinalLength);
 }
 template<unsigned DIM>
 double GonadArmMovingBoundaryCondition<DIM>::GetFinalLength() const
@@ -114,7 +127,7 @@ double GonadArmMovingBoundaryCondition<DIM>::GetTurnRadius() const
 template<unsigned DIM>
 double GonadArmMovingBoundaryCondition<DIM>::GetCurrentTubeRadius() const
 {
-    return mCurrentTubeRadius;
+    return mRadiusSchedule.GetCurrentValue();
 }
 template<unsigned DIM>
 double GonadArmMovingBoundaryCondition<DIM>::GetFinalTubeRadius() const
@@ -133,90 +146,261 @@ double GonadArmMovingBoundaryCondition<DIM>::GetGrowthRateRadial() const
 }
 
 
-/*Update function. Increases gonad arm length by mGrowthRate each timestep, up to LengthMax*/
+/*Update function. The length and radius follow their schedules, so are simply evaluated at the current time*/
 template<unsigned DIM>
 void GonadArmMovingBoundaryCondition<DIM>::UpdateBoundaryCondition(){
-	if(mCurrentLength<mFinalLength){
-		mCurrentLength=mCurrentLength+SimulationTime::Instance()->GetTimeStep()*mGrowthRateLinear;
-	}
-	if(mCurrentTubeRadius<mFinalTubeRadius){
-		mCurrentTubeRadius=mCurrentTubeRadius+SimulationTime::Instance()->GetTimeStep()*mGrowthRateRadial;
-	}
+	RefreshGeometry();
 }
 
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::RefreshGeometry()
+{
+    mCurrentLength = GetCurrentLength();
+    mCurrentTubeRadius = GetCurrentTubeRadius();
+}
 
-/*Checks whether each cell lies in the gonad arm. If not, places the cell on the closest surface point*/
 template<unsigned DIM>
-void GonadArmMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+bool GonadArmMovingBoundaryCondition<DIM>::IsFrozen() const
+{
+    // Once the length reaches its cap its schedule no longer matters
+    bool length_finished = mLengthSchedule.IsFinished() || GetCurrentLength() >= mFinalLength;
+    return length_finished && mRadiusSchedule.IsFinished();
+}
+
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::SetLengthSchedule(const GrowthSchedule& rSchedule)
 {
+    if (rSchedule.GetMinValue() <= 0.0)
+    {
+        EXCEPTION("The length of the gonad arm must stay positive");
+    }
+    mLengthSchedule = rSchedule;
+    RefreshGeometry();
+}
 
-    // Iterate over the cell population and get cell location
+template<unsigned DIM>
+const GrowthSchedule& GonadArmMovingBoundaryCondition<DIM>::rGetLengthSchedule() const
+{
+    return mLengthSchedule;
+}
+
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::SetRadiusSchedule(const GrowthSchedule& rSchedule)
+{
+    if (rSchedule.GetMinValue() <= 0.0)
+    {
+        EXCEPTION("The radius of the gonad arm must stay positive");
+    }
+    double max_radius = rSchedule.GetMaxValue();
+    if (max_radius >= mTurnRadius || mStraightLengthUpper > mStraightLengthLower-max_radius)
+    {
+        EXCEPTION("The radius of the gonad arm must stay small enough that the tube does not meet itself or the cell killer");
+    }
+    mRadiusSchedule = rSchedule;
+    mFinalTubeRadius = max_radius;
+    RefreshGeometry();
+}
+
+template<unsigned DIM>
+const GrowthSchedule& GonadArmMovingBoundaryCondition<DIM>::rGetRadiusSchedule() const
+{
+    return mRadiusSchedule;
+}
+
+
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::SetVerifyFromImposedRecord(bool verifyFromImposedRecord)
+{
+    mVerifyFromImposedRecord = verifyFromImposedRecord;
+}
+template<unsigned DIM>
+bool GonadArmMovingBoundaryCondition<DIM>::GetVerifyFromImposedRecord() const
+{
+    return mVerifyFromImposedRecord;
+}
+
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::SetProjectionTolerance(double tolerance)
+{
+    if (tolerance < 0.0)
+    {
+        EXCEPTION("The projection tolerance must be non-negative");
+    }
+    mProjectionCache.SetTolerance(tolerance);
+}
+template<unsigned DIM>
+double GonadArmMovingBoundaryCondition<DIM>::GetProjectionTolerance() const
+{
+    return mProjectionCache.GetTolerance();
+}
+template<unsigned DIM>
+const CentrelineProjectionCache<DIM>& GonadArmMovingBoundaryCondition<DIM>::rGetProjectionCache() const
+{
+    return mProjectionCache;
+}
+
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::SetCullInteriorCells(bool cullInteriorCells)
+{
+    mCullInteriorCells = cullInteriorCells;
+}
+template<unsigned DIM>
+bool GonadArmMovingBoundaryCondition<DIM>::GetCullInteriorCells() const
+{
+    return mCullInteriorCells;
+}
+template<unsigned DIM>
+unsigned GonadArmMovingBoundaryCondition<DIM>::GetNumCellsCulled() const
+{
+    return mNumCellsCulled;
+}
+template<unsigned DIM>
+unsigned GonadArmMovingBoundaryCondition<DIM>::GetNumCellsImposed() const
+{
+    return mNumCellsImposed;
+}
+
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::SetNumberOfThreads(unsigned numberOfThreads)
+{
+    assert(numberOfThreads > 0);
+    mNumberOfThreads = numberOfThreads;
+}
+
+template<unsigned DIM>
+unsigned GonadArmMovingBoundaryCondition<DIM>::GetNumberOfThreads() const
+{
+    return mNumberOfThreads;
+}
+
+
+/*Gathers every cell and its node and location*/
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::GatherCells()
+{
+    mCells.clear();
+    mNodes.clear();
+    mLocations.clear();
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
          cell_iter != this->mpCellPopulation->End();
          ++cell_iter)
     {
-    	 c_vector<double,DIM> cell_location = this->mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
-    	 Node<DIM>* cell_centre_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
-    	 double radius = cell_centre_node->GetRadius();
-
-    	 // Find C, the closest point on the growth path for this cell, and R the distance to it.
-        double R=0;
-        c_vector<double, DIM> C= zero_vector<double>(3);
-
-        //If all three parts of the path exist, measure distances to the lower+upper straights and the loop
-        if(mCurrentLength>mStraightLengthLower+PI*mTurnRadius){
-        	//Find min distance to each of the three parts of the path
-        	double R1=0; double R2=0; double R3=0;
-        	c_vector<double, DIM> C1=zero_vector<double>(3);
-        	c_vector<double, DIM> C2=zero_vector<double>(3);
-        	c_vector<double, DIM> C3=zero_vector<double>(3);
-        	GetClosestOnLowerStraight(C1,cell_location,R1);
-        	GetClosestOnLoop(C2,cell_location,R2);
-        	GetClosestOnUpperStraight(C3,cell_location,R3);
-        	//Take min and record closest point
-        	R=std::min(R1,std::min(R2,R3));
-        	if(R==R1){
-        		C=C1;
-        	}else if(R==R2){
-        		C=C2;
-        	}else{
-        		C=C3;
-        	}
-        }else if(mCurrentLength>mStraightLengthLower && mCurrentLength<=mStraightLengthLower+PI*mTurnRadius){
-        	//If only the lower straight and the loop exist, similar process
-        	double R1=0; double R2=0;
-        	c_vector<double, DIM> C1=zero_vector<double>(3);
-        	c_vector<double, DIM> C2=zero_vector<double>(3);
-        	GetClosestOnLowerStraight(C1,cell_location,R1);
-        	GetClosestOnLoop(C2,cell_location,R2);
-        	R=std::min(R1,R2);
-        	if(R==R1){
-        		C=C1;
-        	}else{
-        		C=C2;
-        	}
-        }else if(mCurrentLength<=mStraightLengthLower){
-        	//Distance to the lower straight of the gonad arm
-        	GetClosestOnLowerStraight(C,cell_location,R);
-        }else{
-        	NEVER_REACHED;
+        Node<DIM>* p_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+        mCells.push_back(*cell_iter);
+        mNodes.push_back(p_node);
+        mLocations.push_back(p_node->rGetLocation());
+    }
+}
+
+
+/*Gathers every cell's node and location, then finds the closest point on the part of the growth path grown
+ * so far to each in one batch*/
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::ProjectCells()
+{
+    GatherCells();
+    mCentreline.ProjectAll(mLocations, mClosestPoints, mArcLengths, mDistances, mCurrentLength);
+}
+
+
+/*Checks whether each cell lies in the gonad arm. If not, places the cell on the closest surface point*/
+template<unsigned DIM>
+void GonadArmMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+{
+    RefreshGeometry();
+    mImposedRecord.Clear();
+    mNumCellsCulled = 0;
+    mNumCellsImposed = 0;
+
+    // Gather the nodes first, so that each can be imposed on independently of the others
+    GatherCells();
+    unsigned num_cells = mNodes.size();
+    unsigned num_node_indices = 0;
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        num_node_indices = std::max(num_node_indices, mNodes[i]->GetIndex()+1);
+    }
+    mProjectionCache.Reserve(num_node_indices);
+    mArcLengths.resize(num_cells);
+    mWasMoved.resize(num_cells);
+    mWasCulled.resize(num_cells);
+
+    // Each cell only touches its own node, its own cache entry and its own slots, so the result does not depend on the number of threads
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(mNumberOfThreads)
+#endif
+    for (int i=0; i<(int)num_cells; i++)
+    {
+        bool was_culled;
+        mWasMoved[i] = ImposeOnNode(mNodes[i], mArcLengths[i], was_culled);
+        mWasCulled[i] = was_culled;
+    }
+
+    // Record the results for VerifyBoundaryCondition(), in the order of the cells; a cell that was not moved was already satisfied
+    for (unsigned i=0; i<num_cells; i++)
+    {
+        mImposedRecord.Record(mNodes[i], mWasMoved[i], !mWasMoved[i]);
+        if (mWasCulled[i])
+        {
+            mNumCellsCulled++;
         }
 
-        // If the cell is too far from the growth path, and therefore outside the tube...
-        if (R+radius-mCurrentTubeRadius > mMaximumDistance)
+        // With no GonadArmGeometryModifier to record where each cell is along the arm, record it in cell data
+        if (!this->IsRecordedByModifier())
         {
-        	// ...move the cell back onto the surface of the tube by translating toward C:
-            unsigned node_index = this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter);
-            Node<DIM>* p_node = this->mpCellPopulation->GetNode(node_index);
-            p_node->rGetModifiableLocation() = C+(mCurrentTubeRadius-radius)*(cell_location-C)/norm_2(cell_location-C);
+            double arc_length = mArcLengths[i];
+            if (mWasCulled[i])
+            {
+                c_vector<double, DIM> closest_point;
+                mCentreline.Project(mNodes[i]->rGetLocation(), closest_point, arc_length, mCurrentLength);
+            }
+            this->RecordGeometryInCellData(mCells[i], arc_length);
         }
+    }
+    mNumCellsImposed = num_cells;
+}
+
+
+template<unsigned DIM>
+bool GonadArmMovingBoundaryCondition<DIM>::ImposeOnNode(Node<DIM>* pNode, double& rArcLength, bool& rWasCulled)
+{
+    double radius = pNode->GetRadius();
+    rArcLength = -1.0;
+
+    /*
+     * The tube only grows, so a cell that was far enough inside when last projected, and has not moved far
+     * enough since to reach the wall, is still inside.
+     */
+    rWasCulled = mCullInteriorCells && IsSatisfied(mProjectionCache.GetDistanceUpperBound(pNode, mCurrentLength), radius);
+    if (rWasCulled)
+    {
+        return false;
+    }
 
-        /*Assuming all is now well, update the cell data to record how far along the gonad arm this cell is.
-         * Use the vector C, which stores the closest point on the growth path to this cell.*/
-        double distance;
-        HowFarAlongAreYou(C,distance);
-        cell_iter->GetCellData()->SetItem("DistanceAwayFromDTC", mCurrentLength-distance);
+    // Find C, the closest point on the growth path to the cell, and R the distance to it
+    c_vector<double,DIM> C;
+    double R = mProjectionCache.Project(pNode, C, rArcLength, mCurrentLength);
+
+    // If the cell is too far from the growth path, and therefore outside the tube...
+    if (IsSatisfied(R, radius))
+    {
+        return false;
     }
+
+    // ...as found by searching the whole growth path, since a cached piece may give the wrong closest point...
+    if (!mProjectionCache.IsExact(pNode))
+    {
+        R = mProjectionCache.ProjectExactly(pNode, C, rArcLength, mCurrentLength);
+        if (IsSatisfied(R, radius))
+        {
+            return false;
+        }
+    }
+
+    // ...move the cell back onto the surface of the tube by translating toward C:
+    pNode->rGetModifiableLocation() = C+(mCurrentTubeRadius-radius)*(pNode->rGetLocation()-C)/R;
+    mProjectionCache.RecordMoveTowardsCentreline(pNode, norm_2(pNode->rGetLocation()-C));
+    return true;
 }
 
 
@@ -224,188 +408,114 @@ void GonadArmMovingBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::ma
 template<unsigned DIM>
 bool GonadArmMovingBoundaryCondition<DIM>::VerifyBoundaryCondition()
 {
+    RefreshGeometry();
     bool condition_satisfied = true;
 
-    // Iterate over the cell population
-    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
-         cell_iter != this->mpCellPopulation->End();
-         ++cell_iter)
+    if (mVerifyFromImposedRecord && mImposedRecord.IsValid(this->mpCellPopulation->GetNumRealCells()))
     {
-    	c_vector<double,DIM> cell_location = this->mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
-		 Node<DIM>* cell_centre_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
-		 double radius = cell_centre_node->GetRadius();
-
-
-        // Find R=minimum distance to the growth path for this cell, as in ImposeBoundaryCondition
-        double R=0;
-        c_vector<double, DIM> C=zero_vector<double>(3);
-        if(mCurrentLength>mStraightLengthLower+PI*mTurnRadius){
-        	double R1=0;double R2=0;double R3=0;
-        	GetClosestOnLowerStraight(C,cell_location,R1);
-        	GetClosestOnLoop(C,cell_location,R2);
-        	GetClosestOnUpperStraight(C,cell_location,R3);
-        	R=std::min(R1,std::min(R2,R3));
-        }else if(mCurrentLength>mStraightLengthLower && mCurrentLength<=mStraightLengthLower+PI*mTurnRadius){
-        	double R1=0;double R2=0;
-        	GetClosestOnLowerStraight(C,cell_location,R1);
-        	GetClosestOnLoop(C,cell_location,R2);
-        	R=std::min(R1,R2);
-        }else if(mCurrentLength<=mStraightLengthLower){
-        	double R1=0;
-        	GetClosestOnLowerStraight(C,cell_location,R1);
-        	R=R1;
-        }else{
-        	NEVER_REACHED;
+        // Only cells that have moved since ImposeBoundaryCondition() checked them need the geometry again
+        for (unsigned i=0; i<mImposedRecord.GetNumRecords(); i++)
+        {
+            bool is_satisfied;
+            if (mImposedRecord.NeedsChecking(i))
+            {
+                Node<DIM>* p_node = mImposedRecord.GetNode(i);
+                is_satisfied = IsSatisfied(mProjectionCache.GetDistanceUpperBound(p_node, mCurrentLength), p_node->GetRadius());
+                if (!is_satisfied)
+                {
+                    c_vector<double, DIM> C;
+                    double distance;
+                    double R = mCentreline.Project(p_node->rGetLocation(), C, distance, mCurrentLength);
+                    is_satisfied = IsSatisfied(R, p_node->GetRadius());
+                }
+            }
+            else
+            {
+                is_satisfied = mImposedRecord.WasSatisfied(i);
+            }
+
+            if (!is_satisfied)
+            {
+                // ...then the boundary condition is not satisfied :-(
+                condition_satisfied = false;
+                break;
+            }
         }
-        // If the cell is too far from the surface of the tube...
-        if (R+radius-mCurrentTubeRadius > mMaximumDistance)
+    }
+    else
+    {
+        // Find R=minimum distance to the growth path for each cell, as in ImposeBoundaryCondition
+        ProjectCells();
+
+        for (unsigned i=0; i<mCells.size(); i++)
         {
-            // ...then the boundary condition is not satisfied :-(
-            condition_satisfied = false;
-            break;
+            // If the cell is too far from the surface of the tube...
+            if (!IsSatisfied(mDistances[i], mNodes[i]->GetRadius()))
+            {
+                // ...then the boundary condition is not satisfied :-(
+                condition_satisfied = false;
+                break;
+            }
         }
     }
+
+    mImposedRecord.Invalidate();
     return condition_satisfied;
 }
 
 
-/*Calculate how far along the gonad arm some point on the growth path is*/
+/*Whether a cell, whose centre is a distance R from the growth path, lies inside the tube*/
 template<unsigned DIM>
-void GonadArmMovingBoundaryCondition<DIM>::HowFarAlongAreYou(c_vector<double, DIM> point, double& dist){
-	if(point[0]>=0 && point[1]==-mTurnRadius){
-		//if on the lower straight, look at x coord
-		dist=mStraightLengthLower-point[0];
-	}else if(point[0]>=0 && point[1]==mTurnRadius){
-		//upper straight - also look at the x coord
-		dist=mStraightLengthLower+PI*mTurnRadius+point[0];
-	}else{
-		//loop: use trig.
-		if(point[1]<0){
-			dist=mStraightLengthLower+mTurnRadius*atan(fabs(point[0]/point[1]));
-		}else{
-			dist=mStraightLengthLower+mTurnRadius*(-atan(fabs(point[0]/point[1]))+PI);
-		}
-	}
+bool GonadArmMovingBoundaryCondition<DIM>::IsSatisfied(double R, double radius)
+{
+    return !(R+radius-mCurrentTubeRadius > mMaximumDistance);
 }
 
 
-/*Utility functions for determining the closest point on each section of the growth path to your cell centre.
- * The strategy is always to measure:
- * 1) Mid: The distance along a normal to the path, if that part of the path exists (otherwise set to DBL_MAX)
- * 2) End1: The distance to one end of the path that has grown so far
- * 3) End2: The distance to the other end of the path that has grown so far
- * Then take the minimum and output the closest point on the path to your cell.
- * */
 template<unsigned DIM>
-void GonadArmMovingBoundaryCondition<DIM>::GetClosestOnLowerStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist){
-	c_vector<double, DIM> end1=zero_vector<double>(3);
-	c_vector<double, DIM> end2=zero_vector<double>(3);
-	c_vector<double, DIM> mid=zero_vector<double>(3);
-	if(mCurrentLength<mStraightLengthLower){
-		end1[0]=mStraightLengthLower-mCurrentLength; end1[1]=-mTurnRadius; end1[2]=0;
-	}else{
-		end1[0]=0; end1[1]=-mTurnRadius; end1[2]=0;
-	}
-	end2[0]=mStraightLengthLower; end2[1]=-mTurnRadius; end2[2]=0;
-	if(cell_location[0]<end2[0] && cell_location[0]>end1[0]){
-		mid[0]=cell_location[0]; mid[1]=-mTurnRadius; mid[2]=0;
-	}else{
-		mid[0]=DBL_MAX; mid[1]=DBL_MAX; mid[2]=DBL_MAX;
-	}
-	double R1=norm_2(end1-cell_location);
-	double R2=norm_2(end2-cell_location);
-	double R3=norm_2(mid-cell_location);
-	dist=std::min(R1,std::min(R2,R3));
-	if(dist==R1){
-		point=end1;
-	}else if(dist==R2){
-		point=end2;
-	}else{
-		point=mid;
-	}
+const GonadArmCentreline<DIM>& GonadArmMovingBoundaryCondition<DIM>::rGetCentreline() const
+{
+    return mCentreline;
 }
 
 template<unsigned DIM>
-void GonadArmMovingBoundaryCondition<DIM>::GetClosestOnUpperStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist){
-	c_vector<double, DIM> end1=zero_vector<double>(3);
-	c_vector<double, DIM> end2=zero_vector<double>(3);
-	c_vector<double, DIM> mid=zero_vector<double>(3);
-	if(mCurrentLength<mFinalLength){
-		end1[0]=mStraightLengthUpper+mCurrentLength-mFinalLength; end1[1]=mTurnRadius; end1[2]=0;
-	}else{
-		end1[0]=mStraightLengthUpper; end1[1]=mTurnRadius; end1[2]=0;
-	}
-	end2[0]=0; end2[1]=mTurnRadius; end2[2]=0;
-	if(cell_location[0]<end1[0] && cell_location[0]>end2[0]){
-		mid[0]=cell_location[0]; mid[1]=mTurnRadius; mid[2]=0;
-	}else{
-		mid[0]=DBL_MAX; mid[1]=DBL_MAX; mid[2]=DBL_MAX;
-	}
-	double R1=norm_2(end1-cell_location);
-	double R2=norm_2(end2-cell_location);
-	double R3=norm_2(mid-cell_location);
-	dist=std::min(R1,std::min(R2,R3));
-	if(dist==R1){
-		point=end1;
-	}else if(dist==R2){
-		point=end2;
-	}else{
-		point=mid;
-	}
+double GonadArmMovingBoundaryCondition<DIM>::GetDistalTipArcLength() const
+{
+    return GetCurrentLength();
 }
 
 template<unsigned DIM>
-void GonadArmMovingBoundaryCondition<DIM>::GetClosestOnLoop(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist){
-	c_vector<double, DIM> end1=zero_vector<double>(3);
-	c_vector<double, DIM> end2=zero_vector<double>(3);
-	c_vector<double, DIM> mid=zero_vector<double>(3);
-	if(mCurrentLength<mStraightLengthLower+PI*mTurnRadius){
-		double angleRoundLoop=0.5*PI+PI*((-mStraightLengthLower+mCurrentLength)/(PI*mTurnRadius));
-		end1[0]=mTurnRadius*cos(angleRoundLoop); end1[1]=-mTurnRadius*sin(angleRoundLoop); end1[2]=0;
-	}else{
-		end1[0]=0; end1[1]=mTurnRadius; end1[2]=0;
-	}
-	end2[0]=0; end2[1]=-mTurnRadius; end2[2]=0;
-	mid[0]=-fabs(mTurnRadius*cell_location[0]/pow(pow(cell_location[0],2)+pow(cell_location[1],2),0.5));
-	if(cell_location[1]<0){
-		mid[1]=-fabs(mTurnRadius*cell_location[1]/pow(pow(cell_location[0],2)+pow(cell_location[1],2),0.5));
-	}else{
-		mid[1]=fabs(mTurnRadius*cell_location[1]/pow(pow(cell_location[0],2)+pow(cell_location[1],2),0.5));
-	}
-	mid[2]=0;
-	double d1; double d2;
-	HowFarAlongAreYou(end1,d1);
-	HowFarAlongAreYou(mid,d2);
-	if(d2>d1){mid[0]=DBL_MAX;mid[1]=DBL_MAX;mid[2]=DBL_MAX;}
-	double R1=norm_2(end1-cell_location);
-	double R2=norm_2(end2-cell_location);
-	double R3=norm_2(mid-cell_location);
-	dist=std::min(R1,std::min(R2,R3));
-	if(dist==R1){
-		point=end1;
-	}else if(dist==R2){
-		point=end2;
-	}else{
-		point=mid;
-	}
-
+double GonadArmMovingBoundaryCondition<DIM>::GetMaxCellRadius(double arcLength) const
+{
+    return -1.0;
 }
 
+template<unsigned DIM>
+double GonadArmMovingBoundaryCondition<DIM>::GetSignedDistance(const c_vector<double, DIM>& rLocation) const
+{
+    c_vector<double, DIM> closest_point;
+    double arc_length;
+    double R = mCentreline.Project(rLocation, closest_point, arc_length, GetCurrentLength());
+    return R - GetCurrentTubeRadius();
+}
 
 template<unsigned DIM>
 void GonadArmMovingBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile)
 {
 
     *rParamsFile << "\t\t\t<FinalGonadLength>" << mFinalLength << "</FinalGonadLength>\n";
-    *rParamsFile << "\t\t\t<CurrentGonadLength>" << mCurrentLength << "</CurrentGonadLength>\n";
+    *rParamsFile << "\t\t\t<CurrentGonadLength>" << GetCurrentLength() << "</CurrentGonadLength>\n";
     *rParamsFile << "\t\t\t<LengthOfLowerStraightSection>" << mStraightLengthLower << "</LengthOfLowerStraightSection>\n";
     *rParamsFile << "\t\t\t<LengthOfUpperStraightSection>" << mStraightLengthUpper << "</LengthOfUpperStraightSection>\n";
     *rParamsFile << "\t\t\t<RadiusOfTurn>" << mTurnRadius << "</RadiusOfTurn>\n";
-    *rParamsFile << "\t\t\t<RadiusOfTube>" << mCurrentTubeRadius << "</RadiusOfTube>\n";
+    *rParamsFile << "\t\t\t<RadiusOfTube>" << GetCurrentTubeRadius() << "</RadiusOfTube>\n";
     *rParamsFile << "\t\t\t<FinalRadiusOfTube>" << mFinalTubeRadius << "</FinalRadiusOfTube>\n";
     *rParamsFile << "\t\t\t<GonadLinearGrowthRate>" << mGrowthRateLinear << "</GonadLinearGrowthRate>\n";
     *rParamsFile << "\t\t\t<GonadRadialGrowthRate>" << mGrowthRateRadial << "</GonadRadialGrowthRate>\n";
     *rParamsFile << "\t\t\t<MaximumDistance>" << mMaximumDistance << "</MaximumDistance>\n";
+    *rParamsFile << "\t\t\t<ProjectionTolerance>" << mProjectionCache.GetTolerance() << "</ProjectionTolerance>\n";
+    *rParamsFile << "\t\t\t<CullInteriorCells>" << mCullInteriorCells << "</CullInteriorCells>\n";
+    *rParamsFile << "\t\t\t<VerifyFromImposedRecord>" << mVerifyFromImposedRecord << "</VerifyFromImposedRecord>\n";
 
     // Call method on direct parent class
     AbstractMovingBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(rParamsFile);
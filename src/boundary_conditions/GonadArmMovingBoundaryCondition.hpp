@@ -37,6 +37,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GONADARMMOVINGBOUNDARYCONDITION_HPP_
 
 #include "AbstractMovingBoundaryCondition.hpp"
+#include "GonadArmCentreline.hpp"
+#include "CentrelineProjectionCache.hpp"
+
+#include "ImposedBoundaryConditionRecord.hpp"
+#include "AbstractSignedDistanceFunction.hpp"
+#include "AbstractGonadArmGeometryProvider.hpp"
+#include "GrowthSchedule.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -48,15 +55,20 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * turns through a semicircle of radius "TurnRadius" then grows in the +x direction for "StraightLengthUpper".
  * The private double CurrentLength tracks how far the gonad has grown along its specified path and is updated by
  * UpdateBoundaryCondition. The radius of the tube is "CurrentTubeRadius", and grows up to "FinalRadius".
- * "GrowthRateLinear" specifies how far along the path the arm grows per timestep, and "GrowthRateRadial" gives
+ * "GrowthRateLinear" specifies how far along the path the arm grows per unit time, and "GrowthRateRadial" gives
  * the rate of radial growth.
  *
- * As with many boundary conditions for the C. elegans gonad arm project, this boundary condition automatically
- * calculates the distance a cell is along the tube from the upper end, and records it in cell data as
- * DistanceAwayFromDTC.
+ * The length and radius are given by GrowthSchedules of absolute simulation time, which by default grow
+ * linearly at these rates from the time the condition is constructed, and may be replaced by schedules read from
+ * file. They are evaluated whenever the geometry is needed, so do not depend on the number of timesteps taken.
+ *
+ * The condition only confines cells. It provides its geometry to a GonadArmGeometryModifier, which records how
+ * far along the tube each cell is from the upper end (DistanceAwayFromDTC). If no modifier is registered, the
+ * condition records it in cell data itself while imposing.
  */
 template<unsigned DIM>
-class GonadArmMovingBoundaryCondition : public AbstractMovingBoundaryCondition<DIM>
+class GonadArmMovingBoundaryCondition : public AbstractMovingBoundaryCondition<DIM>,
+    public AbstractSignedDistanceFunction<DIM>, public AbstractGonadArmGeometryProvider<DIM>
 {
 private:
 
@@ -70,9 +82,70 @@ private:
     double mGrowthRateLinear;
     double mGrowthRateRadial;
 
+    /** The length grown along the path as a function of simulation time, capped at mFinalLength. */
+    GrowthSchedule mLengthSchedule;
+
+    /** The radius of the tube as a function of simulation time. */
+    GrowthSchedule mRadiusSchedule;
+
     /** The maximum distance from the surface of the tube that cells may be. */
     double mMaximumDistance;
 
+    /**
+     * Whether VerifyBoundaryCondition() should reuse the results recorded by ImposeBoundaryCondition(), only
+     * repeating the geometry for nodes that have moved since. Defaults to true. Not archived.
+     */
+    bool mVerifyFromImposedRecord;
+
+    /** The results recorded by the last call to ImposeBoundaryCondition(). Not archived. */
+    ImposedBoundaryConditionRecord<DIM> mImposedRecord;
+
+    /** The centreline of the arm, which closest points are found on. */
+    GonadArmCentreline<DIM> mCentreline;
+
+    /**
+     * Each node's projection from previous timesteps, so that nodes certainly still inside the tube can be
+     * skipped and others projected onto their previous piece of the centreline. Not archived.
+     */
+    CentrelineProjectionCache<DIM> mProjectionCache;
+
+    /*
+     * Work space filled in by ProjectCells() for each cell: the cell, its node, its location, the closest point
+     * on the centreline, that point's arc length and the distance to it. ImposeBoundaryCondition() also fills in
+     * the nodes and arc lengths (-1 for skipped cells). Not archived.
+     */
+    std::vector<CellPtr> mCells;
+    std::vector<Node<DIM>*> mNodes;
+    std::vector<c_vector<double, DIM> > mLocations;
+    std::vector<c_vector<double, DIM> > mClosestPoints;
+    std::vector<double> mArcLengths;
+    std::vector<double> mDistances;
+
+    /**
+     * Whether ImposeBoundaryCondition() should skip cells that the projection cache shows are certainly still
+     * satisfied, rather than projecting every cell. Defaults to true. Not archived.
+     */
+    bool mCullInteriorCells;
+
+    /** The number of cells skipped by the last call to ImposeBoundaryCondition(). Not archived. */
+    unsigned mNumCellsCulled;
+
+    /** The number of cells the last call to ImposeBoundaryCondition() was imposed on. Not archived. */
+    unsigned mNumCellsImposed;
+
+    /*
+     * Whether ImposeBoundaryCondition() moved and whether it skipped each cell in mNodes. Not std::vector<bool>,
+     * so that different threads can write different cells. Not archived.
+     */
+    std::vector<unsigned char> mWasMoved;
+    std::vector<unsigned char> mWasCulled;
+
+    /**
+     * The number of threads ImposeBoundaryCondition() shares the cells between. Defaults to 1. Not archived, as
+     * it depends on the machine.
+     */
+    unsigned mNumberOfThreads;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -85,8 +158,15 @@ private:
     {
         archive & boost::serialization::base_object<AbstractMovingBoundaryCondition<DIM> >(*this);
         archive & mMaximumDistance;
+        archive & mLengthSchedule;
+        archive & mRadiusSchedule;
     }
 
+    /**
+     * Set mCurrentLength and mCurrentTubeRadius to the values of their schedules at the current simulation time.
+     */
+    void RefreshGeometry();
+
 public:
 
     /**
@@ -100,8 +180,8 @@ public:
      * @param TurnRadius Radius of the semicircle the gonad arm turns through
      * @param CurrentTubeRadius current radius of the tube
      * @param FinalTubeRadius final radius of the tube
-     * @param GrowthRateLinear Length added = GrowthRateLinear*Dt per timestep
-     * @param GrowthRateRadial Increase in Radius = GrowthRateRadial*Dt per timestep
+     * @param GrowthRateLinear Length added per unit time
+     * @param GrowthRateRadial Increase in Radius per unit time
      * @param distance the maximum distance from the surface that cells may be (defaults to 1e-5)
      */
     GonadArmMovingBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation,
@@ -118,10 +198,42 @@ public:
 
      /**
       *
-      * @update boundary condition at each timestep by increasing the length along the growth path (CurrentLength) and the current radius
+      * @update boundary condition at each timestep by evaluating the length along the growth path (CurrentLength) and the current radius at the current time
       */
      void UpdateBoundaryCondition();
 
+    /**
+     * Overridden IsFrozen() method.
+     *
+     * @return whether the schedules for the length and radius have both finished
+     */
+    bool IsFrozen() const;
+
+    /**
+     * Replace the schedule for the length grown along the path. Values beyond the final length are capped.
+     *
+     * @param rSchedule the new schedule, whose values must all be positive
+     */
+    void SetLengthSchedule(const GrowthSchedule& rSchedule);
+
+    /**
+     * @return mLengthSchedule
+     */
+    const GrowthSchedule& rGetLengthSchedule() const;
+
+    /**
+     * Replace the schedule for the radius of the tube. The largest value becomes the final radius.
+     *
+     * @param rSchedule the new schedule, whose values must all be positive and small enough that the straight
+     *     parts of the tube do not meet
+     */
+    void SetRadiusSchedule(const GrowthSchedule& rSchedule);
+
+    /**
+     * @return mRadiusSchedule
+     */
+    const GrowthSchedule& rGetRadiusSchedule() const;
+
     /**
      * Overridden ImposeBoundaryCondition() method.
      *
@@ -140,6 +252,50 @@ public:
      */
     bool VerifyBoundaryCondition();
 
+    /**
+     * Set mVerifyFromImposedRecord.
+     *
+     * @param verifyFromImposedRecord whether VerifyBoundaryCondition() should reuse the results of ImposeBoundaryCondition()
+     */
+    void SetVerifyFromImposedRecord(bool verifyFromImposedRecord);
+
+    /**
+     * @return mVerifyFromImposedRecord
+     */
+    bool GetVerifyFromImposedRecord() const;
+
+    /**
+     * Overridden GetSignedDistance() method.
+     *
+     * @return the signed distance from a location to the surface of the arm grown so far (negative inside).
+     *
+     * @param rLocation the location
+     */
+    double GetSignedDistance(const c_vector<double, DIM>& rLocation) const;
+
+    /**
+     * Overridden rGetCentreline() method.
+     *
+     * @return the centreline of the arm
+     */
+    const GonadArmCentreline<DIM>& rGetCentreline() const;
+
+    /**
+     * Overridden GetDistalTipArcLength() method.
+     *
+     * @return the arc length grown so far, mCurrentLength
+     */
+    double GetDistalTipArcLength() const;
+
+    /**
+     * Overridden GetMaxCellRadius() method.
+     *
+     * @return -1, as the growing arm does not limit cell radii
+     *
+     * @param arcLength the arc length of the cell's closest point on the centreline
+     */
+    double GetMaxCellRadius(double arcLength) const;
+
     /**
      * Overridden OutputCellPopulationBoundaryConditionParameters() method.
      * Output cell population boundary condition parameters to file.
@@ -148,6 +304,61 @@ public:
      */
     void OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile);
 
+    /**
+     * Set how far a node or the distal tip may move before the node's piece of the centreline is searched for
+     * again. Zero searches every time a node is projected. A node found outside the tube from its cached piece
+     * is projected again onto the whole centreline before it is moved, so the tolerance does not change where
+     * cells are placed.
+     *
+     * @param tolerance the tolerance
+     */
+    void SetProjectionTolerance(double tolerance);
+
+    /**
+     * @return the projection tolerance
+     */
+    double GetProjectionTolerance() const;
+
+    /**
+     * @return the projection cache, e.g. to read how many projections reused a cached piece.
+     */
+    const CentrelineProjectionCache<DIM>& rGetProjectionCache() const;
+
+    /**
+     * Set mCullInteriorCells.
+     *
+     * @param cullInteriorCells whether to skip cells that are certainly still satisfied
+     */
+    void SetCullInteriorCells(bool cullInteriorCells);
+
+    /**
+     * @return mCullInteriorCells
+     */
+    bool GetCullInteriorCells() const;
+
+    /**
+     * @return the number of cells skipped by the last call to ImposeBoundaryCondition()
+     */
+    unsigned GetNumCellsCulled() const;
+
+    /**
+     * @return the number of cells the last call to ImposeBoundaryCondition() was imposed on
+     */
+    unsigned GetNumCellsImposed() const;
+
+    /**
+     * Set mNumberOfThreads. Has no effect on speed unless the code is built with OpenMP (see README.md).
+     *
+     * @param numberOfThreads the new value of mNumberOfThreads
+     */
+    void SetNumberOfThreads(unsigned numberOfThreads);
+
+    /**
+     * @return mNumberOfThreads
+     */
+    unsigned GetNumberOfThreads() const;
+
+
     /*Functions returning the current parameter values*/
     double GetCurrentLength() const;
     double GetFinalLength() const;
@@ -159,12 +370,35 @@ public:
     double GetGrowthRateLinear() const;
     double GetGrowthRateRadial() const;
 
-    /*Utility functions for calculating closest points on different parts of the gonad arm to a cell centre*/
-    void GetClosestOnLowerStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist);
-    void GetClosestOnUpperStraight(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist);
-    void GetClosestOnLoop(c_vector<double, DIM>& point, c_vector<double, DIM> cell_location, double& dist);
-    /*And for calculating how far along the gonad arm a point on the growth path is */
-    void HowFarAlongAreYou(c_vector<double, DIM> point, double& dist);
+    /**
+     * Gather every cell and its node and location.
+     */
+    void GatherCells();
+
+    /**
+     * Gather every cell's node and location, and project the locations onto the centreline in one batch.
+     */
+    void ProjectCells();
+
+    /**
+     * Impose the condition on one node, unless the projection cache shows it is certainly inside the tube.
+     * Only touches the node and its cache entry, so may be called for different nodes at once.
+     *
+     * @param pNode the node
+     * @param rArcLength filled in with the arc length of the node's closest point, or -1 if it was skipped
+     * @param rWasCulled filled in with whether the node was skipped
+     * @return whether the node was moved
+     */
+    bool ImposeOnNode(Node<DIM>* pNode, double& rArcLength, bool& rWasCulled);
+
+    /**
+     * @return whether a cell satisfies the condition
+     *
+     * @param distance the distance from the cell centre to its closest point on the centreline
+     * @param radius the radius of the cell
+     */
+    bool IsSatisfied(double distance, double radius);
+
 
 };
 
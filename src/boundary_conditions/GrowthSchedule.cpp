@@ -0,0 +1,205 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GrowthSchedule.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+GrowthSchedule::GrowthSchedule()
+    : mTimes(1, 0.0),
+      mValues(1, 0.0),
+      mFinalRate(0.0)
+{
+}
+
+GrowthSchedule::GrowthSchedule(const std::vector<double>& rTimes, const std::vector<double>& rValues, double finalRate)
+    : mTimes(rTimes),
+      mValues(rValues),
+      mFinalRate(finalRate)
+{
+    CheckKnots();
+}
+
+void GrowthSchedule::CheckKnots() const
+{
+    if (mTimes.empty() || mTimes.size() != mValues.size())
+    {
+        EXCEPTION("A growth schedule needs the same number of times and values, and at least one of each.");
+    }
+    for (unsigned i=1; i<mTimes.size(); i++)
+    {
+        if (mTimes[i] <= mTimes[i-1])
+        {
+            EXCEPTION("The times of a growth schedule must be increasing.");
+        }
+    }
+}
+
+void GrowthSchedule::SetLinear(double startTime, double startValue, double rate, double finalValue)
+{
+    mTimes.assign(1, startTime);
+    mValues.assign(1, startValue);
+    mFinalRate = 0.0;
+
+    if (rate == 0.0 || finalValue == startValue)
+    {
+        return;
+    }
+    if ((finalValue - startValue)*rate < 0.0)
+    {
+        EXCEPTION("A linear growth schedule must grow towards its final value.");
+    }
+    if (finalValue == DBL_MAX || finalValue == -DBL_MAX)
+    {
+        mFinalRate = rate;
+    }
+    else
+    {
+        // Stop exactly at the final value, rather than overshooting by part of a timestep
+        mTimes.push_back(startTime + (finalValue - startValue)/rate);
+        mValues.push_back(finalValue);
+    }
+}
+
+void GrowthSchedule::LoadFromFile(const std::string& rFileName)
+{
+    std::ifstream file(rFileName.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open growth schedule file " + rFileName + ".");
+    }
+
+    std::vector<double> times;
+    std::vector<double> values;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream line_stream(line);
+        std::string first;
+        if (!(line_stream >> first) || first[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream time_stream(first);
+        double time, value;
+        if (!(time_stream >> time) || !(line_stream >> value))
+        {
+            EXCEPTION("The growth schedule in " + rFileName + " could not be read.");
+        }
+        times.push_back(time);
+        values.push_back(value);
+    }
+
+    mTimes = times;
+    mValues = values;
+    mFinalRate = 0.0;
+    CheckKnots();
+}
+
+double GrowthSchedule::GetValue(double time) const
+{
+    if (time <= mTimes.front())
+    {
+        return mValues.front();
+    }
+    if (time >= mTimes.back())
+    {
+        return mValues.back() + mFinalRate*(time - mTimes.back());
+    }
+
+    // Interpolate along the segment containing the time
+    unsigned upper = std::upper_bound(mTimes.begin(), mTimes.end(), time) - mTimes.begin();
+    unsigned lower = upper - 1;
+    double fraction = (time - mTimes[lower])/(mTimes[upper] - mTimes[lower]);
+    return mValues[lower] + fraction*(mValues[upper] - mValues[lower]);
+}
+
+double GrowthSchedule::GetCurrentValue() const
+{
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    if (!p_simulation_time->IsStartTimeSetUp())
+    {
+        return mValues.front();
+    }
+    return GetValue(p_simulation_time->GetTime());
+}
+
+bool GrowthSchedule::IsFinished() const
+{
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    double time = p_simulation_time->IsStartTimeSetUp() ? p_simulation_time->GetTime() : mTimes.front();
+    return time >= GetFinalTime();
+}
+
+double GrowthSchedule::GetFinalTime() const
+{
+    return (mFinalRate == 0.0) ? mTimes.back() : DBL_MAX;
+}
+
+double GrowthSchedule::GetMaxValue() const
+{
+    if (mFinalRate > 0.0)
+    {
+        return DBL_MAX;
+    }
+    return *std::max_element(mValues.begin(), mValues.end());
+}
+
+double GrowthSchedule::GetMinValue() const
+{
+    if (mFinalRate < 0.0)
+    {
+        return -DBL_MAX;
+    }
+    return *std::min_element(mValues.begin(), mValues.end());
+}
+
+const std::vector<double>& GrowthSchedule::rGetTimes() const
+{
+    return mTimes;
+}
+
+const std::vector<double>& GrowthSchedule::rGetValues() const
+{
+    return mValues;
+}
+
+double GrowthSchedule::GetFinalRate() const
+{
+    return mFinalRate;
+}
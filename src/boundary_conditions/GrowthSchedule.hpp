@@ -0,0 +1,166 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GROWTHSCHEDULE_HPP_
+#define GROWTHSCHEDULE_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/vector.hpp>
+#include <vector>
+#include <string>
+#include <cfloat>
+
+/**
+ * A quantity, such as the length or radius of a growing boundary, given as a function of absolute simulation
+ * time. The function is piecewise linear between a list of knots (time, value), constant before the first knot,
+ * and after the last knot changes at a constant final rate (zero unless set).
+ *
+ * Moving boundary conditions evaluate their schedules at the current simulation time whenever their geometry is
+ * needed, rather than adding rate*dt each timestep, so the geometry does not depend on how many steps were
+ * taken to reach a given time and is the same after a restart.
+ */
+class GrowthSchedule
+{
+private:
+
+    /** The times of the knots, in increasing order. */
+    std::vector<double> mTimes;
+
+    /** The value at each knot. */
+    std::vector<double> mValues;
+
+    /** The rate at which the value changes after the last knot. */
+    double mFinalRate;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mTimes;
+        archive & mValues;
+        archive & mFinalRate;
+    }
+
+    /**
+     * Throw an exception if the knots are empty, of different lengths or not in increasing order of time.
+     */
+    void CheckKnots() const;
+
+public:
+
+    /**
+     * Default constructor. The value is zero at all times.
+     */
+    GrowthSchedule();
+
+    /**
+     * Constructor.
+     *
+     * @param rTimes the times of the knots, in increasing order
+     * @param rValues the value at each knot
+     * @param finalRate the rate at which the value changes after the last knot (defaults to 0)
+     */
+    GrowthSchedule(const std::vector<double>& rTimes, const std::vector<double>& rValues, double finalRate=0.0);
+
+    /**
+     * Replace the schedule by one starting at a given value and changing at a constant rate until it reaches a
+     * final value, after which it stays there.
+     *
+     * @param startTime the time growth starts
+     * @param startValue the value until then
+     * @param rate the rate of change, which must move the value towards finalValue (or be zero)
+     * @param finalValue the value at which growth stops (defaults to DBL_MAX, so growth never stops)
+     */
+    void SetLinear(double startTime, double startValue, double rate, double finalValue=DBL_MAX);
+
+    /**
+     * Replace the schedule by one read from a file. Each line gives a knot as a time and a value separated by
+     * white space; blank lines and lines starting with # are ignored.
+     *
+     * @param rFileName the full path of the file
+     */
+    void LoadFromFile(const std::string& rFileName);
+
+    /**
+     * @return the value at a given time.
+     *
+     * @param time the absolute simulation time
+     */
+    double GetValue(double time) const;
+
+    /**
+     * @return the value at the current simulation time, or at the first knot if simulation time has not
+     * been set up.
+     */
+    double GetCurrentValue() const;
+
+    /**
+     * @return whether the value will not change after the current simulation time.
+     */
+    bool IsFinished() const;
+
+    /**
+     * @return the time after which the value no longer changes (DBL_MAX if the final rate is not zero).
+     */
+    double GetFinalTime() const;
+
+    /**
+     * @return the largest value the schedule ever takes (DBL_MAX if it grows without limit).
+     */
+    double GetMaxValue() const;
+
+    /**
+     * @return the smallest value the schedule ever takes (-DBL_MAX if it shrinks without limit).
+     */
+    double GetMinValue() const;
+
+    /** @return mTimes */
+    const std::vector<double>& rGetTimes() const;
+
+    /** @return mValues */
+    const std::vector<double>& rGetValues() const;
+
+    /** @return mFinalRate */
+    double GetFinalRate() const;
+};
+
+#endif /*GROWTHSCHEDULE_HPP_*/
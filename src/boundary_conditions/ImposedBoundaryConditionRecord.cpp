@@ -0,0 +1,120 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ImposedBoundaryConditionRecord.hpp"
+
+template<unsigned DIM>
+ImposedBoundaryConditionRecord<DIM>::ImposedBoundaryConditionRecord()
+    : mIsValid(false)
+{
+}
+
+template<unsigned DIM>
+void ImposedBoundaryConditionRecord<DIM>::Clear()
+{
+    mNodes.clear();
+    mLocations.clear();
+    mStatuses.clear();
+    mIsValid = true;
+}
+
+template<unsigned DIM>
+void ImposedBoundaryConditionRecord<DIM>::Invalidate()
+{
+    mIsValid = false;
+}
+
+template<unsigned DIM>
+void ImposedBoundaryConditionRecord<DIM>::Record(Node<DIM>* pNode, bool wasMoved, bool isSatisfied)
+{
+    mNodes.push_back(pNode);
+    mLocations.push_back(pNode->rGetLocation());
+    mStatuses.push_back(wasMoved ? 2 : (isSatisfied ? 1 : 0));
+}
+
+template<unsigned DIM>
+bool ImposedBoundaryConditionRecord<DIM>::IsValid(unsigned numNodes) const
+{
+    return mIsValid && (mNodes.size() == numNodes);
+}
+
+template<unsigned DIM>
+unsigned ImposedBoundaryConditionRecord<DIM>::GetNumRecords() const
+{
+    return mNodes.size();
+}
+
+template<unsigned DIM>
+Node<DIM>* ImposedBoundaryConditionRecord<DIM>::GetNode(unsigned i) const
+{
+    assert(i < mNodes.size());
+    return mNodes[i];
+}
+
+template<unsigned DIM>
+bool ImposedBoundaryConditionRecord<DIM>::NeedsChecking(unsigned i) const
+{
+    assert(i < mNodes.size());
+    if (mStatuses[i] == 2)
+    {
+        return true;
+    }
+
+    // Another boundary condition may have moved the node since
+    const c_vector<double, DIM>& r_location = mNodes[i]->rGetLocation();
+    for (unsigned d=0; d<DIM; d++)
+    {
+        if (r_location[d] != mLocations[i][d])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<unsigned DIM>
+bool ImposedBoundaryConditionRecord<DIM>::WasSatisfied(unsigned i) const
+{
+    assert(i < mNodes.size());
+    return (mStatuses[i] == 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class ImposedBoundaryConditionRecord<1>;
+template class ImposedBoundaryConditionRecord<2>;
+template class ImposedBoundaryConditionRecord<3>;
@@ -0,0 +1,127 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef IMPOSEDBOUNDARYCONDITIONRECORD_HPP_
+#define IMPOSEDBOUNDARYCONDITIONRECORD_HPP_
+
+#include "Node.hpp"
+#include <vector>
+
+/**
+ * A record, kept by a boundary condition while it imposes itself, of each node it checked: where the node was
+ * left, and whether it already satisfied the condition there. VerifyBoundaryCondition() can then trust the
+ * recorded result for every node that is still where it was left, and only repeat the geometry for nodes the
+ * condition moved (whose new position has not been checked) or that another boundary condition has since moved.
+ *
+ * The record is only valid between a call to Clear() at the start of ImposeBoundaryCondition() and the next
+ * call to Invalidate(), and only if it covers as many nodes as the population now has.
+ */
+template<unsigned DIM>
+class ImposedBoundaryConditionRecord
+{
+private:
+
+    /** The nodes checked, in the order they were recorded. */
+    std::vector<Node<DIM>*> mNodes;
+
+    /** The location each node was left at. */
+    std::vector<c_vector<double, DIM> > mLocations;
+
+    /** Whether each node satisfied the condition where it was left: 1 if so, 0 if not, 2 if it was moved. */
+    std::vector<char> mStatuses;
+
+    /** Whether the record is complete and up to date. */
+    bool mIsValid;
+
+public:
+
+    /**
+     * Constructor. The record starts out invalid.
+     */
+    ImposedBoundaryConditionRecord();
+
+    /**
+     * Empty the record and mark it valid, ready for ImposeBoundaryCondition() to fill in.
+     */
+    void Clear();
+
+    /**
+     * Mark the record out of date, so the next verification checks every node.
+     */
+    void Invalidate();
+
+    /**
+     * Record a node after the condition has been imposed on it, at its current location.
+     *
+     * @param pNode the node
+     * @param wasMoved whether the condition moved the node
+     * @param isSatisfied whether the node satisfied the condition, if it was not moved
+     */
+    void Record(Node<DIM>* pNode, bool wasMoved, bool isSatisfied);
+
+    /**
+     * @return whether the record is valid and covers the given number of nodes.
+     *
+     * @param numNodes the number of nodes the population has
+     */
+    bool IsValid(unsigned numNodes) const;
+
+    /** @return the number of nodes recorded. */
+    unsigned GetNumRecords() const;
+
+    /**
+     * @return the i-th node recorded.
+     *
+     * @param i the record index
+     */
+    Node<DIM>* GetNode(unsigned i) const;
+
+    /**
+     * @return whether the i-th node must be checked again: it was moved, or is no longer where it was left.
+     *
+     * @param i the record index
+     */
+    bool NeedsChecking(unsigned i) const;
+
+    /**
+     * @return whether the i-th node satisfied the condition where it was left. Only meaningful if
+     * NeedsChecking() is false.
+     *
+     * @param i the record index
+     */
+    bool WasSatisfied(unsigned i) const;
+};
+
+#endif /*IMPOSEDBOUNDARYCONDITIONRECORD_HPP_*/
@@ -38,7 +38,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 template<unsigned DIM>
 MovingBoundaryModifier<DIM>::MovingBoundaryModifier()
-    : AbstractCellBasedSimulationModifier<DIM>()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mNumPopulationUpdatesSkipped(0)
 {
 }
 
@@ -47,19 +48,32 @@ MovingBoundaryModifier<DIM>::~MovingBoundaryModifier()
 {
 }
 
-//At each timestep, loop through all moving boundary conditions the modifier knows about. For each one,
-//call the UpdateBoundaryCondition() method.
+//At each timestep, loop through all moving boundary conditions the modifier knows about. For each one that
+//is still moving, call the UpdateBoundaryCondition() method.
 template<unsigned DIM>
 void MovingBoundaryModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
+    bool boundary_moved = false;
     for (typename std::vector<boost::shared_ptr<AbstractMovingBoundaryCondition<DIM,DIM> > >::iterator bcon_iter = mBoundaryConditions.begin();
     		bcon_iter != mBoundaryConditions.end();
          ++bcon_iter)
     {
-        (*bcon_iter)->UpdateBoundaryCondition();
+        if (!(*bcon_iter)->IsFrozen())
+        {
+            (*bcon_iter)->UpdateBoundaryCondition();
+            boundary_moved = true;
+        }
     }
-    UpdateCellData(rCellPopulation);
 
+    // Once every boundary has stopped moving, the simulation's own update of the population is enough
+    if (boundary_moved)
+    {
+        UpdateCellData(rCellPopulation);
+    }
+    else
+    {
+        mNumPopulationUpdatesSkipped++;
+    }
 }
 
 template<unsigned DIM>
@@ -88,6 +102,13 @@ void MovingBoundaryModifier<DIM>::SpecifyMovingBoundary(boost::shared_ptr<Abstra
 };
 
 
+template<unsigned DIM>
+unsigned MovingBoundaryModifier<DIM>::GetNumPopulationUpdatesSkipped() const
+{
+    return mNumPopulationUpdatesSkipped;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 // Explicit instantiation
 /////////////////////////////////////////////////////////////////////////////
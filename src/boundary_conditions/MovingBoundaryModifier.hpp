@@ -49,6 +49,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * moving boundary conditions should be added both to the simulator and to this modifier using the method
  * SpecifyMovingBoundary. This keeps the handling of moving boundaries somewhat separate from the main Chaste
  * code for the time being.
+ *
+ * Boundaries that report themselves frozen are no longer updated, and the cell population is only updated at
+ * the end of a timestep in which some boundary moved, as the simulation updates it itself anyway.
  */
 template<unsigned DIM>
 class MovingBoundaryModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
@@ -67,6 +70,9 @@ protected:
     /** List of moving boundary conditions. */
     std::vector<boost::shared_ptr<AbstractMovingBoundaryCondition<DIM,DIM> > > mBoundaryConditions;
 
+    /** The number of timesteps at whose end the cell population was not updated, as no boundary moved. Not archived. */
+    unsigned mNumPopulationUpdatesSkipped;
+
 public:
 
     /**
@@ -112,6 +118,11 @@ public:
      */
     void SpecifyMovingBoundary(boost::shared_ptr<AbstractMovingBoundaryCondition<DIM,DIM> >  pBoundaryCondition);
 
+    /**
+     * @return the number of timesteps at whose end the cell population was not updated, as no boundary moved
+     */
+    unsigned GetNumPopulationUpdatesSkipped() const;
+
 };
 
 #include "SerializationExportWrapper.hpp"
@@ -0,0 +1,216 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SignedDistanceFieldBoundaryCondition.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+template<unsigned DIM>
+SignedDistanceFieldBoundaryCondition<DIM>::SignedDistanceFieldBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation,
+                                                                                boost::shared_ptr<SignedDistanceField<DIM> > pField,
+                                                                                double distance)
+    : AbstractCellPopulationBoundaryCondition<DIM>(pCellPopulation),
+      mpField(pField),
+      mMaximumDistance(distance),
+      mUseCellRadii(true),
+      mMaxIterations(5),
+      mVerifyFromImposedRecord(true)
+{
+    assert(mpField);
+    assert(mMaximumDistance > 0.0);
+
+    if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation) == NULL)
+    {
+        EXCEPTION("A NodeBasedCellPopulation must be used with this boundary condition object.");
+    }
+}
+
+template<unsigned DIM>
+boost::shared_ptr<SignedDistanceField<DIM> > SignedDistanceFieldBoundaryCondition<DIM>::GetField() const
+{
+    return mpField;
+}
+
+template<unsigned DIM>
+double SignedDistanceFieldBoundaryCondition<DIM>::GetMaximumDistance() const
+{
+    return mMaximumDistance;
+}
+
+template<unsigned DIM>
+void SignedDistanceFieldBoundaryCondition<DIM>::SetUseCellRadii(bool useCellRadii)
+{
+    mUseCellRadii = useCellRadii;
+}
+
+template<unsigned DIM>
+bool SignedDistanceFieldBoundaryCondition<DIM>::GetUseCellRadii() const
+{
+    return mUseCellRadii;
+}
+
+template<unsigned DIM>
+void SignedDistanceFieldBoundaryCondition<DIM>::SetMaxIterations(unsigned maxIterations)
+{
+    assert(maxIterations > 0);
+    mMaxIterations = maxIterations;
+}
+
+template<unsigned DIM>
+unsigned SignedDistanceFieldBoundaryCondition<DIM>::GetMaxIterations() const
+{
+    return mMaxIterations;
+}
+
+template<unsigned DIM>
+void SignedDistanceFieldBoundaryCondition<DIM>::SetVerifyFromImposedRecord(bool verifyFromImposedRecord)
+{
+    mVerifyFromImposedRecord = verifyFromImposedRecord;
+}
+
+template<unsigned DIM>
+bool SignedDistanceFieldBoundaryCondition<DIM>::GetVerifyFromImposedRecord() const
+{
+    return mVerifyFromImposedRecord;
+}
+
+template<unsigned DIM>
+bool SignedDistanceFieldBoundaryCondition<DIM>::IsSatisfied(Node<DIM>* pNode) const
+{
+    double radius = mUseCellRadii ? pNode->GetRadius() : 0.0;
+    return !(mpField->GetSignedDistance(pNode->rGetLocation()) + radius > mMaximumDistance);
+}
+
+/*Checks whether each cell lies inside the surface. If not, moves the cell back along the gradient of the field*/
+template<unsigned DIM>
+void SignedDistanceFieldBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+{
+    mImposedRecord.Clear();
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
+         cell_iter != this->mpCellPopulation->End();
+         ++cell_iter)
+    {
+        Node<DIM>* p_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+        double radius = mUseCellRadii ? p_node->GetRadius() : 0.0;
+
+        c_vector<double, DIM> gradient;
+        double distance = mpField->GetSignedDistance(p_node->rGetLocation(), gradient);
+        bool was_moved = false;
+
+        /*
+         * Newton steps towards the surface offset inwards by the cell radius. The field is close to a distance
+         * function, so one step usually suffices; more are needed near corners of the surface.
+         */
+        for (unsigned iteration=0; iteration<mMaxIterations && distance + radius > mMaximumDistance; iteration++)
+        {
+            double gradient_squared = inner_prod(gradient, gradient);
+            if (gradient_squared == 0.0)
+            {
+                // A flat spot in the field (e.g. on a medial surface) gives no direction to move in
+                break;
+            }
+            p_node->rGetModifiableLocation() -= ((distance + radius)/gradient_squared)*gradient;
+            distance = mpField->GetSignedDistance(p_node->rGetLocation(), gradient);
+            was_moved = true;
+        }
+
+        // Record the result for VerifyBoundaryCondition()
+        mImposedRecord.Record(p_node, was_moved, !(distance + radius > mMaximumDistance));
+    }
+}
+
+//Check boundary condition is now satisfied
+template<unsigned DIM>
+bool SignedDistanceFieldBoundaryCondition<DIM>::VerifyBoundaryCondition()
+{
+    bool condition_satisfied = true;
+
+    if (mVerifyFromImposedRecord && mImposedRecord.IsValid(this->mpCellPopulation->GetNumRealCells()))
+    {
+        // Only cells that have moved since ImposeBoundaryCondition() checked them need looking up again
+        for (unsigned i=0; i<mImposedRecord.GetNumRecords(); i++)
+        {
+            bool is_satisfied = mImposedRecord.NeedsChecking(i) ? IsSatisfied(mImposedRecord.GetNode(i))
+                                                                 : mImposedRecord.WasSatisfied(i);
+            if (!is_satisfied)
+            {
+                condition_satisfied = false;
+                break;
+            }
+        }
+    }
+    else
+    {
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
+             cell_iter != this->mpCellPopulation->End();
+             ++cell_iter)
+        {
+            Node<DIM>* p_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+            if (!IsSatisfied(p_node))
+            {
+                condition_satisfied = false;
+                break;
+            }
+        }
+    }
+
+    mImposedRecord.Invalidate();
+    return condition_satisfied;
+}
+
+template<unsigned DIM>
+void SignedDistanceFieldBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<FieldSpacing>" << mpField->GetSpacing() << "</FieldSpacing>\n";
+    *rParamsFile << "\t\t\t<MaximumDistance>" << mMaximumDistance << "</MaximumDistance>\n";
+    *rParamsFile << "\t\t\t<UseCellRadii>" << mUseCellRadii << "</UseCellRadii>\n";
+    *rParamsFile << "\t\t\t<MaxIterations>" << mMaxIterations << "</MaxIterations>\n";
+    *rParamsFile << "\t\t\t<VerifyFromImposedRecord>" << mVerifyFromImposedRecord << "</VerifyFromImposedRecord>\n";
+
+    // Call method on direct parent class
+    AbstractCellPopulationBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(rParamsFile);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class SignedDistanceFieldBoundaryCondition<1>;
+template class SignedDistanceFieldBoundaryCondition<2>;
+template class SignedDistanceFieldBoundaryCondition<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SignedDistanceFieldBoundaryCondition)
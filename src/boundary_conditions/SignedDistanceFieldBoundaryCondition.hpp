@@ -0,0 +1,239 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SIGNEDDISTANCEFIELDBOUNDARYCONDITION_HPP_
+#define SIGNEDDISTANCEFIELDBOUNDARYCONDITION_HPP_
+
+#include "AbstractCellPopulationBoundaryCondition.hpp"
+#include "SignedDistanceField.hpp"
+
+#include "ImposedBoundaryConditionRecord.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * A boundary condition confining cells to the region where a SignedDistanceField is negative. The field can
+ * be sampled from one of the analytic boundary conditions or from a surface mesh, or loaded from a file, so
+ * that any shape costs one interpolated lookup per cell.
+ *
+ * A cell too far outside is moved back along the gradient of the field until it is within mMaximumDistance
+ * of the surface (less its own radius, if mUseCellRadii is set).
+ */
+template<unsigned DIM>
+class SignedDistanceFieldBoundaryCondition : public AbstractCellPopulationBoundaryCondition<DIM>
+{
+private:
+
+    /** The signed distance field, negative where cells may lie. */
+    boost::shared_ptr<SignedDistanceField<DIM> > mpField;
+
+    /** The maximum distance outside the surface that cells may be. */
+    double mMaximumDistance;
+
+    /** Whether a cell's radius should be kept inside the surface too. Defaults to true. */
+    bool mUseCellRadii;
+
+    /** The maximum number of steps along the gradient used to move a cell back inside. Defaults to 5. */
+    unsigned mMaxIterations;
+
+    /**
+     * Whether VerifyBoundaryCondition() should reuse the results recorded by ImposeBoundaryCondition(), only
+     * repeating the lookup for nodes that have moved since. Defaults to true. Not archived.
+     */
+    bool mVerifyFromImposedRecord;
+
+    /** The results recorded by the last call to ImposeBoundaryCondition(). Not archived. */
+    ImposedBoundaryConditionRecord<DIM> mImposedRecord;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellPopulationBoundaryCondition<DIM> >(*this);
+        archive & mUseCellRadii;
+        archive & mMaxIterations;
+    }
+
+    /**
+     * @return whether a node lies close enough to the surface.
+     *
+     * @param pNode the node
+     */
+    bool IsSatisfied(Node<DIM>* pNode) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param pCellPopulation pointer to the cell population
+     * @param pField the signed distance field
+     * @param distance the maximum distance outside the surface that cells may be (defaults to 1e-5)
+     */
+    SignedDistanceFieldBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation,
+                                         boost::shared_ptr<SignedDistanceField<DIM> > pField,
+                                         double distance=1e-5);
+
+    /**
+     * @return mpField
+     */
+    boost::shared_ptr<SignedDistanceField<DIM> > GetField() const;
+
+    /**
+     * @return mMaximumDistance
+     */
+    double GetMaximumDistance() const;
+
+    /**
+     * Set mUseCellRadii.
+     *
+     * @param useCellRadii whether a cell's radius should be kept inside the surface too
+     */
+    void SetUseCellRadii(bool useCellRadii);
+
+    /**
+     * @return mUseCellRadii
+     */
+    bool GetUseCellRadii() const;
+
+    /**
+     * Set mMaxIterations.
+     *
+     * @param maxIterations the maximum number of steps used to move a cell back inside (at least 1)
+     */
+    void SetMaxIterations(unsigned maxIterations);
+
+    /**
+     * @return mMaxIterations
+     */
+    unsigned GetMaxIterations() const;
+
+    /**
+     * Set mVerifyFromImposedRecord.
+     *
+     * @param verifyFromImposedRecord whether VerifyBoundaryCondition() should reuse the results of ImposeBoundaryCondition()
+     */
+    void SetVerifyFromImposedRecord(bool verifyFromImposedRecord);
+
+    /**
+     * @return mVerifyFromImposedRecord
+     */
+    bool GetVerifyFromImposedRecord() const;
+
+    /**
+     * Overridden ImposeBoundaryCondition() method.
+     * Apply the cell population boundary conditions.
+     *
+     * @param rOldLocations the node locations before any boundary conditions are applied
+     */
+    void ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations);
+
+    /**
+     * Overridden VerifyBoundaryCondition() method.
+     * Verify the boundary conditions have been applied.
+     * This is called after ImposeBoundaryCondition() to ensure the condition is still satisfied.
+     *
+     * @return whether the boundary conditions are satisfied.
+     */
+    bool VerifyBoundaryCondition();
+
+    /**
+     * Overridden OutputCellPopulationBoundaryConditionParameters() method.
+     * Output cell population boundary condition parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SignedDistanceFieldBoundaryCondition)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a SignedDistanceFieldBoundaryCondition.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const SignedDistanceFieldBoundaryCondition<DIM>* t, const BOOST_PFTO unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* const p_cell_population = t->GetCellPopulation();
+    ar << p_cell_population;
+
+    const boost::shared_ptr<SignedDistanceField<DIM> > p_field = t->GetField();
+    ar << p_field;
+
+    double distance = t->GetMaximumDistance();
+    ar << distance;
+}
+
+/**
+ * De-serialize constructor parameters and initialize a SignedDistanceFieldBoundaryCondition.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, SignedDistanceFieldBoundaryCondition<DIM>* t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    boost::shared_ptr<SignedDistanceField<DIM> > p_field;
+    ar >> p_field;
+
+    double distance;
+    ar >> distance;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)SignedDistanceFieldBoundaryCondition<DIM>(p_cell_population, p_field, distance);
+}
+}
+} // namespace ...
+
+#endif /*SIGNEDDISTANCEFIELDBOUNDARYCONDITION_HPP_*/
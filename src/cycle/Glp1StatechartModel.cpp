@@ -14,15 +14,27 @@ void CellStatechart::SetCell(CellPtr newCell){
      pCell=newCell;
 };
 
-std::vector<double> CellStatechart::GetVariables(){
-    std::vector<double> variables;
-    variables.push_back(TimeInPhase);
-    variables.push_back(GLP1Activity);
-    return variables;
+const unsigned CellStatechart::NUM_VARIABLES;
+const char* const CellStatechart::VARIABLE_NAMES[CellStatechart::NUM_VARIABLES]={"TimeInPhase","GLP1Activity"};
+double CellStatechart::* const CellStatechart::VARIABLE_MEMBERS[CellStatechart::NUM_VARIABLES]={&CellStatechart::TimeInPhase,&CellStatechart::GLP1Activity};
+
+int CellStatechart::GetVariableIndex(const std::string& rName){
+    for(unsigned i=0; i<NUM_VARIABLES; i++){
+        if(rName==VARIABLE_NAMES[i]){
+            return i;
+        }
+    }
+    return -1;
+}
+void CellStatechart::GetVariables(double* pValues){
+    for(unsigned i=0; i<NUM_VARIABLES; i++){
+        pValues[i]=this->*VARIABLE_MEMBERS[i];
+    }
 }
-void CellStatechart::SetVariables(std::vector<double> variables){
-    TimeInPhase=variables.at(0);
-    GLP1Activity=variables.at(1);
+void CellStatechart::SetVariables(const double* pValues){
+    for(unsigned i=0; i<NUM_VARIABLES; i++){
+        this->*VARIABLE_MEMBERS[i]=pValues[i];
+    }
 }
 
 int CellStatechart::GetState(){
@@ -302,10 +314,10 @@ sc::result CellStateChart_GLP1_Active::react( const EvCellStateChart_GLP1Update
     CellPtr myCell=context<CellStatechart>().pCell;
 
     if(GetDistanceFromDTC(myCell)<15 && outermost_context().GLP1Activity<16){
-      outermost_context().GLP1Activity+=0.1*GetTimestep();
+      outermost_context().GLP1Activity+=0.1*GetTimestep(myCell);
       myCell->GetCellData()->SetItem("GLP1Activity",outermost_context().GLP1Activity);
     }else if(GetDistanceFromDTC(myCell)>15){
-      outermost_context().GLP1Activity-=0.5*GetTimestep();
+      outermost_context().GLP1Activity-=0.5*GetTimestep(myCell);
       myCell->GetCellData()->SetItem("GLP1Activity",outermost_context().GLP1Activity);
     }
 
@@ -402,7 +414,7 @@ my_base( ctx ){ context<CellStatechart>().TimeInPhase = 0.0;
 sc::result CellStateChart_CellCycle_Mitosis_G1::react( const EvCellStateChart_CellCycleUpdate & ){
     CellPtr myCell=context<CellStatechart>().pCell;
 
-  context<CellStatechart>().TimeInPhase+=GetTimestep();
+  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         return transit<CellStateChart_CellCycle_Mitosis_S>();
     }
@@ -421,7 +433,7 @@ my_base( ctx ){ context<CellStatechart>().TimeInPhase = 0.0;
 sc::result CellStateChart_CellCycle_Mitosis_G2::react( const EvCellStateChart_CellCycleUpdate & ){
     CellPtr myCell=context<CellStatechart>().pCell;
 
-  context<CellStatechart>().TimeInPhase+=GetTimestep();
+  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         SetReadyToDivide(myCell,true);
         return transit<CellStateChart_CellCycle_Mitosis_M>();
@@ -441,7 +453,7 @@ my_base( ctx ){ context<CellStatechart>().TimeInPhase = 0.0;
 sc::result CellStateChart_CellCycle_Mitosis_S::react( const EvCellStateChart_CellCycleUpdate & ){
     CellPtr myCell=context<CellStatechart>().pCell;
 
-  context<CellStatechart>().TimeInPhase+=GetTimestep();
+  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         return transit<CellStateChart_CellCycle_Mitosis_G2>();
     }
@@ -460,7 +472,7 @@ my_base( ctx ){ context<CellStatechart>().TimeInPhase = 0.0;
 sc::result CellStateChart_CellCycle_Mitosis_M::react( const EvCellStateChart_CellCycleUpdate & ){
     CellPtr myCell=context<CellStatechart>().pCell;
 
-  context<CellStatechart>().TimeInPhase+=GetTimestep();
+  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         return transit<CellStateChart_CellCycle_Mitosis_G1>();
     }
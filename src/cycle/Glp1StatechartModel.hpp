@@ -9,11 +9,14 @@
 #include <boost/statechart/transition.hpp>
 #include <boost/mpl/list.hpp>
 #include <boost/config.hpp>
+#include <boost/pool/pool_alloc.hpp>
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/vector.hpp>
 
+#include "PoolAllocated.hpp"
+
 namespace sc = boost::statechart;
 namespace mpl = boost::mpl;
 
@@ -67,7 +70,7 @@ struct EvGoToCellStateChart_CellCycle_Meiosis : sc::event< EvGoToCellStateChart_
 
 //PARENT STATECHART
 
-struct CellStatechart:  sc::state_machine<CellStatechart,Running>{
+struct CellStatechart:  sc::state_machine<CellStatechart,Running,boost::fast_pool_allocator<int> >, PoolAllocated<CellStatechart>{
   CellStatechart();
 
   CellPtr pCell;
@@ -75,11 +78,16 @@ struct CellStatechart:  sc::state_machine<CellStatechart,Running>{
   boost::shared_ptr<CellStatechart> Copy(boost::shared_ptr<CellStatechart> myNewStatechart);
 
   int GetState();
-  std::vector<double> GetVariables();
+  void GetVariables(double* pValues);
   void SetState(int state);
-  void SetVariables(std::vector<double> variableValues);
+  void SetVariables(const double* pValues);
   void SetCell(CellPtr newCell);
 
+  static const unsigned NUM_VARIABLES=2;
+  static const char* const VARIABLE_NAMES[NUM_VARIABLES];
+  static double CellStatechart::* const VARIABLE_MEMBERS[NUM_VARIABLES];
+  static int GetVariableIndex(const std::string& rName);
+
   double TimeInPhase;
   double GLP1Activity;
 };
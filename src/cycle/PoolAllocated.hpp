@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef POOLALLOCATED_HPP_
+#define POOLALLOCATED_HPP_
+
+#include <cstddef>
+#include <new>
+#include <boost/pool/singleton_pool.hpp>
+
+/**
+ * Mixin giving a class free-list pooled operator new/delete.
+ *
+ * Derive T from PoolAllocated<T> and every `new T` is served from a boost::singleton_pool of
+ * sizeof(T) chunks. Objects released by `delete` (for instance when a cell killed by
+ * TimedPlaneBasedCellKiller or RandomCellKillerInCuboid is removed and its cell cycle model goes
+ * with it) return their chunk to the pool, and the next division reuses it. In a population with
+ * steady births and deaths the pool stops growing and division allocates nothing from the heap.
+ *
+ * Requests of any other size (a class derived from T that adds members) fall through to the global
+ * operator new, as does deleting memory the pool didn't hand out (e.g. objects boost::serialization
+ * allocated with the global operator new when loading an archive).
+ */
+template<class T>
+class PoolAllocated
+{
+private:
+
+    /**
+     * The pool all T's come from. PoolAllocated<T> doubles as the pool's tag. Wrapped in a nested
+     * class so sizeof(T) isn't needed until T is complete.
+     */
+    struct Pool : public boost::singleton_pool<PoolAllocated<T>, sizeof(T)>
+    {
+    };
+
+public:
+
+    /**
+     * Allocate memory for one object.
+     *
+     * @param size  the size of the object being created
+     * @return pointer to the memory
+     */
+    static void* operator new(std::size_t size)
+    {
+        if (size != sizeof(T))
+        {
+            return ::operator new(size);
+        }
+        void* p_memory = Pool::malloc();
+        if (p_memory == NULL)
+        {
+            throw std::bad_alloc();
+        }
+        return p_memory;
+    }
+
+    /**
+     * Release the memory for one object, back to the pool if it came from there.
+     *
+     * @param pMemory  the memory to release
+     * @param size  the size of the object being destroyed
+     */
+    static void operator delete(void* pMemory, std::size_t size)
+    {
+        if (pMemory == NULL)
+        {
+            return;
+        }
+        if (size == sizeof(T) && Pool::is_from(pMemory))
+        {
+            Pool::free(pMemory);
+        }
+        else
+        {
+            ::operator delete(pMemory);
+        }
+    }
+
+    /**
+     * @return whether some memory was handed out by the pool, rather than by the global operator new.
+     *
+     * @param pMemory  the memory
+     */
+    static bool IsFromPool(void* pMemory)
+    {
+        return Pool::is_from(pMemory);
+    }
+
+    /**
+     * Return the pool's unused chunks to the system. Only needed if the population shrinks a lot
+     * and stays small, since the pool otherwise keeps its high-water mark.
+     */
+    static void ReleaseUnusedMemory()
+    {
+        Pool::release_memory();
+    }
+};
+
+#endif /*POOLALLOCATED_HPP_*/
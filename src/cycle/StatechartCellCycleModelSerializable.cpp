@@ -34,13 +34,20 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include"StatechartCellCycleModelSerializable.hpp"
+#include "Exception.hpp"
 
 
 StatechartCellCycleModelSerializable::StatechartCellCycleModelSerializable(bool LoadingFromArchive): AbstractCellCycleModel(){
 	
 	mLoadingFromArchive=LoadingFromArchive;
-	TempVariableStorage=std::vector<double>();
 	TempStateStorage=0;
+	mStatechartUpdateInterval=1;
+	mStepsSinceStatechartUpdate=0;
+	mTimeSinceStatechartUpdate=0.0;
+	mDistanceAwayFromDTC=0.0;
+	mMaxRadius=0.0;
+	mHasDistanceAwayFromDTC=false;
+	mHasMaxRadius=false;
 
 	//Set some sensible C.Elegans germ cell defaults
 	mSDuration=8.33;
@@ -52,10 +59,14 @@ StatechartCellCycleModelSerializable::StatechartCellCycleModelSerializable(bool
     
     MAKE_PTR(CellStatechart,newStatechart);
     pStatechart=newStatechart;
+    //Start the pending variables from the chart's defaults.
+    pStatechart->GetVariables(TempVariableStorage);
 };
 
 
 AbstractCellCycleModel* StatechartCellCycleModelSerializable::CreateCellCycleModel(){
+	//The parent's chart must be live before it can be copied.
+	RestoreStatechartFromArchive();
 	//Create a new cell cycle model
 	StatechartCellCycleModelSerializable* newStatechartCellCycleModelSerializable = new StatechartCellCycleModelSerializable();
 	//Ensure values are inhereted from parent as appropriate
@@ -68,7 +79,16 @@ AbstractCellCycleModel* StatechartCellCycleModelSerializable::CreateCellCycleMod
     newStatechartCellCycleModelSerializable->SetMDuration(mMDuration);
 	newStatechartCellCycleModelSerializable->SetDimension(mDimension);
 	newStatechartCellCycleModelSerializable->mG1Duration=mG1Duration;
-	newStatechartCellCycleModelSerializable->mLoadingFromArchive=mLoadingFromArchive;
+	newStatechartCellCycleModelSerializable->mStatechartUpdateInterval=mStatechartUpdateInterval;
+	//The daughter's chart is a copy of the parent's, which hasn't yet advanced through the accumulated time either
+	newStatechartCellCycleModelSerializable->mStepsSinceStatechartUpdate=mStepsSinceStatechartUpdate;
+	newStatechartCellCycleModelSerializable->mTimeSinceStatechartUpdate=mTimeSinceStatechartUpdate;
+	newStatechartCellCycleModelSerializable->mDistanceAwayFromDTC=mDistanceAwayFromDTC;
+	newStatechartCellCycleModelSerializable->mMaxRadius=mMaxRadius;
+	newStatechartCellCycleModelSerializable->mHasDistanceAwayFromDTC=mHasDistanceAwayFromDTC;
+	newStatechartCellCycleModelSerializable->mHasMaxRadius=mHasMaxRadius;
+	//The daughter gets a copy of an already restored chart, so has nothing pending.
+	newStatechartCellCycleModelSerializable->mLoadingFromArchive=false;
 	//Create a new statechart.
 	MAKE_PTR(CellStatechart, newStatechart);
 	//Set its cell pointer to the parent cell to avoid it being null when constructors are called.
@@ -84,15 +104,38 @@ void StatechartCellCycleModelSerializable::SetCell(CellPtr pCell){
     mpCell = pCell;
 	//Switch the statechart's cell pointer to point to this cell.
  	pStatechart->SetCell(mpCell);
- 	//If we're loading from an archive, now is an appropriate time to initiate the statechart and set the stored state
-	//and variables. 
+ 	//If we're loading from an archive the stored state and variables are left in TempStateStorage and 
+	//TempVariableStorage; the chart is restored the first time it is actually needed.
+ };
+
+
+void StatechartCellCycleModelSerializable::RestoreStatechartFromArchive(){
 	if(mLoadingFromArchive==true){
 		pStatechart->initiate();
 		pStatechart->SetState(TempStateStorage);
 		pStatechart->SetVariables(TempVariableStorage);
 		mLoadingFromArchive=false;
 	}
- };
+};
+
+
+int StatechartCellCycleModelSerializable::GetStatechartState(){
+	if(mLoadingFromArchive==true){
+		return TempStateStorage;
+	}
+	return pStatechart->GetState();
+};
+
+
+void StatechartCellCycleModelSerializable::GetStatechartVariables(double* pValues){
+	if(mLoadingFromArchive==true){
+		for(unsigned i=0; i<CellStatechart::NUM_VARIABLES; i++){
+			pValues[i]=TempVariableStorage[i];
+		}
+	}else{
+		pStatechart->GetVariables(pValues);
+	}
+};
 
 
 void StatechartCellCycleModelSerializable::Initialise(){
@@ -134,8 +177,57 @@ bool StatechartCellCycleModelSerializable::ReadyToDivide(){
 };
 
 void StatechartCellCycleModelSerializable::UpdateCellCyclePhase(){
-	//To update the phase, just update the statechart
+	//If we've just been loaded from an archive, bring the chart back first.
+	RestoreStatechartFromArchive();
+	//Accumulate time until the chart is due for an update
+	mTimeSinceStatechartUpdate+=SimulationTime::Instance()->GetTimeStep();
+	mStepsSinceStatechartUpdate++;
+	if(mStepsSinceStatechartUpdate<mStatechartUpdateInterval){
+		return;
+	}
+	//To update the phase, just update the statechart. It advances through all the accumulated time.
 	pStatechart->process_event(EvCheckCellData());
+	mStepsSinceStatechartUpdate=0;
+	mTimeSinceStatechartUpdate=0.0;
+};
+
+void StatechartCellCycleModelSerializable::SetStatechartUpdateInterval(unsigned interval){
+	if(interval==0){
+		EXCEPTION("The statechart update interval must be at least one timestep");
+	}
+	mStatechartUpdateInterval=interval;
+};
+
+unsigned StatechartCellCycleModelSerializable::GetStatechartUpdateInterval(){
+	return mStatechartUpdateInterval;
+};
+
+double StatechartCellCycleModelSerializable::GetStatechartTimestep(){
+	return mTimeSinceStatechartUpdate;
+};
+
+void StatechartCellCycleModelSerializable::SetDistanceAwayFromDTC(double distance){
+	mDistanceAwayFromDTC=distance;
+	mHasDistanceAwayFromDTC=true;
+};
+
+double StatechartCellCycleModelSerializable::GetDistanceAwayFromDTC(){
+	if(mHasDistanceAwayFromDTC){
+		return mDistanceAwayFromDTC;
+	}
+	return mpCell->GetCellData()->GetItem("DistanceAwayFromDTC");
+};
+
+void StatechartCellCycleModelSerializable::SetMaxRadius(double maxRadius){
+	mMaxRadius=maxRadius;
+	mHasMaxRadius=true;
+};
+
+double StatechartCellCycleModelSerializable::GetMaxRadius(){
+	if(mHasMaxRadius){
+		return mMaxRadius;
+	}
+	return mpCell->GetCellData()->GetItem("MaxRadius");
 };
 
 void StatechartCellCycleModelSerializable::ResetForDivision(){
@@ -152,9 +244,9 @@ void StatechartCellCycleModelSerializable::SetReadyToDivide(bool Ready){
 };
 
 //Standard outputting of parameters associated with the cell cycle model to a params file for storage
-//Haven't added any new parameters in particular.
 void StatechartCellCycleModelSerializable::OutputCellCycleModelParameters(out_stream& rParamsFile)
 {
+	*rParamsFile << "\t\t\t<StatechartUpdateInterval>" << mStatechartUpdateInterval << "</StatechartUpdateInterval>\n";
 	AbstractCellCycleModel::OutputCellCycleModelParameters( rParamsFile);
 }
 
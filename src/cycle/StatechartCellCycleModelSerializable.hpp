@@ -41,7 +41,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/serialization/base_object.hpp>
 #include "SmartPointers.hpp"
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/version.hpp>
 #include "RandomNumberGenerator.hpp"
+#include "PoolAllocated.hpp"
 //At the moment, the statechart model used by this file is changed by altering THIS HEADER.
 //I need to find an easier way to set the statechart model as an input variable...
 #include "BasicStatechart.hpp"
@@ -57,10 +60,14 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 * Because boost statecharts don't support archiving, this wrapper also deals with saving
 * the current state of the statechart and any variables associated with it when required. 
 * The current state is encoded as a single integer for archiving purposes, while statechart associated 
-* variables are stored in an array. 
+* variables are stored by name using the chart's variable schema (CellStatechart::VARIABLE_NAMES), so
+* checkpoints remain loadable when a chart adds or reorders variables.
+*
+* Both the model and its statechart (including the chart's state objects) are pool allocated, so the
+* memory of cells removed by the killers is reused for new daughters.
 */
 
-class StatechartCellCycleModelSerializable : public AbstractCellCycleModel
+class StatechartCellCycleModelSerializable : public AbstractCellCycleModel, public PoolAllocated<StatechartCellCycleModelSerializable>
 {
 
 /** Standard serialization block, doesn't deal with saving the statechart. */
@@ -73,15 +80,38 @@ template<class Archive>
         // Make sure any RandomNumberGenerator singleton gets saved too, to avoid phasing
         SerializableSingleton<RandomNumberGenerator>* p_wrapper = RandomNumberGenerator::Instance()->GetSerializationWrapper();
         archive & p_wrapper;    
+        // Older archives always updated the chart every timestep
+        if(version>1){
+            archive & mStatechartUpdateInterval;
+            archive & mStepsSinceStatechartUpdate;
+            archive & mTimeSinceStatechartUpdate;
+        }
     }
 
+    /*The number of timesteps between statechart updates. Defaults to 1, i.e. every timestep.*/
+    unsigned mStatechartUpdateInterval;
+
+    /*Timesteps and time accumulated since the statechart was last updated. The chart advances through
+    * all of this time at once on its next update.*/
+    unsigned mStepsSinceStatechartUpdate;
+    double mTimeSinceStatechartUpdate;
+
+    /*Where the cell is in the gonad arm, as last recorded by a GonadArmGeometryModifier: how far it is from
+    * the distal tip and the largest radius it may grow to there. Held here, rather than in cell data, so the
+    * statechart can read them without a string lookup. Not archived: the modifier records them again when the
+    * simulation is set up.*/
+    double mDistanceAwayFromDTC;
+    double mMaxRadius;
+    bool mHasDistanceAwayFromDTC;
+    bool mHasMaxRadius;
+
 public:
     
     /*Holds a pointer to this cell's statechart*/
     boost::shared_ptr<CellStatechart> pStatechart;    
     
     bool mLoadingFromArchive;
-    std::vector<double> TempVariableStorage;
+    double TempVariableStorage[CellStatechart::NUM_VARIABLES];
     int TempStateStorage;
 
     /*Constructor. This:
@@ -94,9 +124,25 @@ public:
     /*Because a cell cycle model doesn't have a pointer to its cell until AFTER construction, this is the method
     * where we set the cell pointer for this class AND pass it to the statechart. The method SetCell has been changed 
     * in AbstractCellCycleModel to be virtual, allowing it to be overriden safely. 
+    * When loading from an archive the statechart is NOT restored here; the stored state and variables are held
+    * until the chart is first needed (see RestoreStatechartFromArchive).
     */
     void SetCell(CellPtr pCell); 
 
+    /*If this model was loaded from an archive and its statechart has not yet been restored, initiate the chart
+    * and replay the stored state and variables onto it. Called lazily on the first UpdateCellCyclePhase or
+    * CreateCellCycleModel after loading, so restarting a large population doesn't pay for every chart up front.
+    * Does nothing if the chart is already live.
+    */
+    void RestoreStatechartFromArchive();
+
+    /*Archiving helpers. Return the packed state and variables of the statechart, or the values still waiting
+    * to be restored if the chart hasn't been touched since it was loaded. GetStatechartVariables fills an
+    * array of CellStatechart::NUM_VARIABLES doubles, in schema order.
+    */
+    int GetStatechartState();
+    void GetStatechartVariables(double* pValues);
+
     /**
     * @return whether the cell is ready to divide (enter M phase). Set by the statechart.
     */
@@ -104,9 +150,31 @@ public:
     
     /**
     * This method updates the statechart, and the statechart will in turn update the current phase and
-    * set the flag ReadyToDivide if appropriate
+    * set the flag ReadyToDivide if appropriate. The chart is only updated every mStatechartUpdateInterval
+    * timesteps; in between, the elapsed time is accumulated and the chart is left alone.
     */
     void UpdateCellCyclePhase();    
+
+    /*Multi-rate updating. Cell fate changes over hours, far slower than the mechanics timestep, so the chart
+    * can be updated every few timesteps and advanced by the accumulated time (GetTimestep(CellPtr) in the
+    * statechart interface). Daughters inherit the parent's interval and the time it has accumulated
+    * towards its next update, so both charts update together. Division is noticed up to interval-1
+    * timesteps late.
+    */
+    void SetStatechartUpdateInterval(unsigned interval);
+    unsigned GetStatechartUpdateInterval();
+
+    /*The time the statechart is advancing through in the current update.*/
+    double GetStatechartTimestep();
+
+    /*Gonad arm geometry for the statechart. The getters fall back to the cell data items of the same names
+    * until a value has been set, which the gonad arm boundary conditions keep up to date when there is no
+    * GonadArmGeometryModifier.
+    * Daughters inherit the parent's values until the modifier next records them.*/
+    void SetDistanceAwayFromDTC(double distance);
+    double GetDistanceAwayFromDTC();
+    void SetMaxRadius(double maxRadius);
+    double GetMaxRadius();
     
     /**
     * Builder method to create new instances of the cell-cycle model for daughter cells.
@@ -135,6 +203,10 @@ public:
 
 
 
+// Version 0 archives stored chart variables positionally, version 1 stores them by name,
+// version 2 adds the statechart update interval.
+BOOST_CLASS_VERSION(StatechartCellCycleModelSerializable, 2)
+
 #include "SerializationExportWrapper.hpp"
 // Declare identifier for the serializer
 CHASTE_CLASS_EXPORT(StatechartCellCycleModelSerializable)
@@ -152,13 +224,19 @@ namespace serialization
         Archive & ar, const StatechartCellCycleModelSerializable* t, const BOOST_PFTO unsigned int file_version)
     {
         // Archive other member variables
-        int state = t->pStatechart->GetState();
+        // Use the model's accessors, since the chart itself may not have been restored yet
+        StatechartCellCycleModelSerializable* p_model = const_cast<StatechartCellCycleModelSerializable*>(t);
+        int state = p_model->GetStatechartState();
         ar << state;
-        std::vector<double> v = t->pStatechart->GetVariables();
-        int numberOfVars=v.size();
+        double values[CellStatechart::NUM_VARIABLES];
+        p_model->GetStatechartVariables(values);
+        int numberOfVars=CellStatechart::NUM_VARIABLES;
         ar << numberOfVars;
-        for(int i=0; i<v.size(); i++){
-            ar<<v.at(i);
+        // Each variable is stored as a (name, value) pair
+        for(int i=0; i<numberOfVars; i++){
+            std::string name(CellStatechart::VARIABLE_NAMES[i]);
+            ar << name;
+            ar << values[i];
         }
     }
     
@@ -169,19 +247,29 @@ namespace serialization
     
         int state;
         ar >> state;
+
+        // Construct a new cell cycle model first, so that any variable missing from the archive keeps
+        // the chart's default value, then store the state and variable values until the chart is restored.
+        ::new(t)StatechartCellCycleModelSerializable(true);
+        t->TempStateStorage=state;
+
         int numberOfVars;
         ar >> numberOfVars;
-        std::vector<double> v;
         for(int i=0; i<numberOfVars; i++){
+            // Old archives are positional; newer ones name each variable
+            int index=i;
+            if(file_version>0){
+                std::string name;
+                ar >> name;
+                index=CellStatechart::GetVariableIndex(name);
+            }
             double value;
             ar >> value;
-            v.push_back(value);
+            // Variables the current chart doesn't have are dropped
+            if(index>=0 && index<(int)CellStatechart::NUM_VARIABLES){
+                t->TempVariableStorage[index]=value;
+            }
         }
-        
-        // Construct a new cell cycle model and set the statechart's state and variable values.
-        ::new(t)StatechartCellCycleModelSerializable(true);
-        t->TempStateStorage=state;
-        t->TempVariableStorage=v;
     }
 }
 } // namespace ...
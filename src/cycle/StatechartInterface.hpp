@@ -39,8 +39,11 @@ void SetReadyToDivide(CellPtr pCell, bool Ready){
 bool IsDead(CellPtr pCell){
      return pCell->IsDead();
 };
-double GetTimestep(){
-     return SimulationTime::Instance()->GetTimeStep();
+//The time the statechart is advancing through in this update: one or more simulation timesteps,
+//depending on the cell cycle model's statechart update interval.
+double GetTimestep(CellPtr pCell){
+    AbstractCellCycleModel* model = pCell->GetCellCycleModel();
+    return dynamic_cast<StatechartCellCycleModelSerializable*>(model)->GetStatechartTimestep();
 };
 double GetTime(){
      return SimulationTime::Instance()->GetTime();
@@ -53,18 +56,21 @@ void SetProliferationFlag(CellPtr pCell, double Flag){
 void SetRadius(CellPtr pCell, double radius){
       pCell->GetCellData()->SetItem("Radius",radius);
 };
+//Recorded in the cell cycle model by a GonadArmGeometryModifier, falling back to cell data if it hasn't run
 double GetDistanceFromDTC(CellPtr pCell){
-    return pCell->GetCellData()->GetItem("DistanceAwayFromDTC");
+    AbstractCellCycleModel* model = pCell->GetCellCycleModel();
+    return dynamic_cast<StatechartCellCycleModelSerializable*>(model)->GetDistanceAwayFromDTC();
 };
 double GetMaxRadius(CellPtr pCell){
-    return pCell->GetCellData()->GetItem("MaxRadius");
+    AbstractCellCycleModel* model = pCell->GetCellCycleModel();
+    return dynamic_cast<StatechartCellCycleModelSerializable*>(model)->GetMaxRadius();
 };
 
 void UpdateRadius(CellPtr pCell){
   double MaxRad = GetMaxRadius(pCell);
   double Rad = pCell->GetCellData()->GetItem("Radius");
   if(Rad<MaxRad-0.1){
-    SetRadius(pCell,Rad+=GetTimestep());
+    SetRadius(pCell,Rad+=GetTimestep(pCell));
   }
 };
 #endif
@@ -13,13 +13,27 @@ void CellStatechart::SetCell(CellPtr newCell){
      pCell=newCell;
 };
 
-std::vector<double> CellStatechart::GetVariables(){
-    std::vector<double> variables;
-    variables.push_back(TimeInPhase);
-    return variables;
+const unsigned CellStatechart::NUM_VARIABLES;
+const char* const CellStatechart::VARIABLE_NAMES[CellStatechart::NUM_VARIABLES]={"TimeInPhase"};
+double CellStatechart::* const CellStatechart::VARIABLE_MEMBERS[CellStatechart::NUM_VARIABLES]={&CellStatechart::TimeInPhase};
+
+int CellStatechart::GetVariableIndex(const std::string& rName){
+    for(unsigned i=0; i<NUM_VARIABLES; i++){
+        if(rName==VARIABLE_NAMES[i]){
+            return i;
+        }
+    }
+    return -1;
 }
-void CellStatechart::SetVariables(std::vector<double> variables){
-    TimeInPhase=variables.at(0);
+void CellStatechart::GetVariables(double* pValues){
+    for(unsigned i=0; i<NUM_VARIABLES; i++){
+        pValues[i]=this->*VARIABLE_MEMBERS[i];
+    }
+}
+void CellStatechart::SetVariables(const double* pValues){
+    for(unsigned i=0; i<NUM_VARIABLES; i++){
+        this->*VARIABLE_MEMBERS[i]=pValues[i];
+    }
 }
 
 int CellStatechart::GetState(){
@@ -398,7 +412,7 @@ sc::result CellStateChart_CellCycle_Mitosis_G1::react( const EvCellStateChart_Ce
     }
     double Duration=TotalDuration*0.1665;
 
-    context<CellStatechart>().TimeInPhase+=GetTimestep();
+    context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         return transit<CellStateChart_CellCycle_Mitosis_S>();
     }
@@ -425,7 +439,7 @@ sc::result CellStateChart_CellCycle_Mitosis_G2::react( const EvCellStateChart_Ce
     }
     double Duration=TotalDuration*0.3335;
 
-  context<CellStatechart>().TimeInPhase+=GetTimestep();
+  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         SetReadyToDivide(myCell,true);
         return transit<CellStateChart_CellCycle_Mitosis_M>();
@@ -453,7 +467,7 @@ sc::result CellStateChart_CellCycle_Mitosis_S::react( const EvCellStateChart_Cel
     }
     double Duration=TotalDuration*0.4165;
 
-  context<CellStatechart>().TimeInPhase+=GetTimestep();
+  context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         return transit<CellStateChart_CellCycle_Mitosis_G2>();
     }
@@ -481,7 +495,7 @@ sc::result CellStateChart_CellCycle_Mitosis_M::react( const EvCellStateChart_Cel
     double Duration=TotalDuration*0.0835;
     
 
-    context<CellStatechart>().TimeInPhase+=GetTimestep();
+    context<CellStatechart>().TimeInPhase+=GetTimestep(myCell);
     if(context<CellStatechart>().TimeInPhase>=Duration){
         return transit<CellStateChart_CellCycle_Mitosis_G1>();
     }
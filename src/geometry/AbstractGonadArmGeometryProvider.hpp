@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ABSTRACTGONADARMGEOMETRYPROVIDER_HPP_
+#define ABSTRACTGONADARMGEOMETRYPROVIDER_HPP_
+
+#include "GonadArmCentreline.hpp"
+#include "Cell.hpp"
+
+/**
+ * An interface for boundary conditions that define a gonad arm, so that a GonadArmGeometryModifier can work
+ * out where along the arm each cell is, and how large it may grow there, without the boundary condition
+ * writing anything to the cells itself.
+ *
+ * A boundary condition with no modifier registered (for example one loaded from an archive saved before the
+ * modifier existed) records the geometry in cell data itself while imposing, with RecordGeometryInCellData(),
+ * so the statecharts reading the DistanceAwayFromDTC and MaxRadius items still see them change.
+ */
+template<unsigned DIM>
+class AbstractGonadArmGeometryProvider
+{
+private:
+
+    /**
+     * Whether a GonadArmGeometryModifier records the geometry for this arm. Set by the modifier, and not
+     * archived: the modifier sets it again when the simulation is set up.
+     */
+    bool mIsRecordedByModifier;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    AbstractGonadArmGeometryProvider()
+        : mIsRecordedByModifier(false)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractGonadArmGeometryProvider()
+    {
+    }
+
+    /**
+     * Set mIsRecordedByModifier.
+     *
+     * @param isRecordedByModifier whether a GonadArmGeometryModifier records the geometry for this arm
+     */
+    void SetRecordedByModifier(bool isRecordedByModifier)
+    {
+        mIsRecordedByModifier = isRecordedByModifier;
+    }
+
+    /**
+     * @return mIsRecordedByModifier
+     */
+    bool IsRecordedByModifier() const
+    {
+        return mIsRecordedByModifier;
+    }
+
+    /**
+     * Record how far a cell is from the distal tip (DistanceAwayFromDTC) and, if the arm limits it, the largest
+     * radius it may grow to (MaxRadius) in its cell data.
+     *
+     * @param pCell the cell
+     * @param arcLength the arc length of the cell's closest point on the centreline
+     */
+    void RecordGeometryInCellData(CellPtr pCell, double arcLength) const
+    {
+        pCell->GetCellData()->SetItem("DistanceAwayFromDTC", GetDistalTipArcLength()-arcLength);
+        double max_radius = GetMaxCellRadius(arcLength);
+        if (max_radius >= 0.0)
+        {
+            pCell->GetCellData()->SetItem("MaxRadius", max_radius);
+        }
+    }
+
+    /**
+     * @return the centreline of the arm.
+     */
+    virtual const GonadArmCentreline<DIM>& rGetCentreline() const=0;
+
+    /**
+     * @return the arc length of the distal tip: the end of the part of the centreline grown so far.
+     */
+    virtual double GetDistalTipArcLength() const=0;
+
+    /**
+     * @return the largest radius a cell may grow to at a given arc length along the arm, or a negative value
+     * if the arm does not limit cell radii.
+     *
+     * @param arcLength the arc length of the cell's closest point on the centreline
+     */
+    virtual double GetMaxCellRadius(double arcLength) const=0;
+};
+
+#endif /*ABSTRACTGONADARMGEOMETRYPROVIDER_HPP_*/
@@ -0,0 +1,254 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CentrelineProjectionCache.hpp"
+#include <algorithm>
+
+template<unsigned DIM>
+CentrelineProjectionCache<DIM>::CentrelineProjectionCache(const GonadArmCentreline<DIM>& rCentreline, double tolerance)
+    : mCentreline(rCentreline),
+      mTolerance(tolerance),
+      mNumFullProjections(0),
+      mNumPieceProjections(0)
+{
+    assert(mTolerance >= 0.0);
+}
+
+template<unsigned DIM>
+void CentrelineProjectionCache<DIM>::Clear()
+{
+    mNodes.clear();
+    mLocations.clear();
+    mDistances.clear();
+    mArcLengths.clear();
+    mMaxArcLengths.clear();
+    mPieceIndices.clear();
+    mIsExact.clear();
+}
+
+template<unsigned DIM>
+void CentrelineProjectionCache<DIM>::Reserve(unsigned numNodeIndices)
+{
+    if (numNodeIndices > mNodes.size())
+    {
+        mNodes.resize(numNodeIndices, NULL);
+        mLocations.resize(numNodeIndices);
+        mDistances.resize(numNodeIndices);
+        mArcLengths.resize(numNodeIndices);
+        mMaxArcLengths.resize(numNodeIndices);
+        mPieceIndices.resize(numNodeIndices);
+        mIsExact.resize(numNodeIndices);
+    }
+}
+
+template<unsigned DIM>
+void CentrelineProjectionCache<DIM>::SetTolerance(double tolerance)
+{
+    assert(tolerance >= 0.0);
+    mTolerance = tolerance;
+}
+
+template<unsigned DIM>
+double CentrelineProjectionCache<DIM>::GetTolerance() const
+{
+    return mTolerance;
+}
+
+template<unsigned DIM>
+bool CentrelineProjectionCache<DIM>::HasEntry(Node<DIM>* pNode) const
+{
+    // Node indices are reused after cells die, so check the entry belongs to this node
+    unsigned index = pNode->GetIndex();
+    return (index < mNodes.size()) && (mNodes[index] == pNode);
+}
+
+template<unsigned DIM>
+double CentrelineProjectionCache<DIM>::Project(Node<DIM>* pNode,
+                                               c_vector<double, DIM>& rClosestPoint,
+                                               double& rArcLength,
+                                               double maxArcLength)
+{
+    const c_vector<double, DIM>& r_location = pNode->rGetLocation();
+    unsigned index = pNode->GetIndex();
+
+    if (mTolerance > 0.0
+        && HasEntry(pNode)
+        && norm_2(r_location - mLocations[index]) <= mTolerance
+        && fabs(maxArcLength - mMaxArcLengths[index]) <= mTolerance)
+    {
+        double distance = mCentreline.ProjectOntoPiece(r_location, mPieceIndices[index], rClosestPoint, rArcLength, maxArcLength);
+        mIsExact[index] = false;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        mNumPieceProjections++;
+
+        mLocations[index] = r_location;
+        mDistances[index] = distance;
+        mArcLengths[index] = rArcLength;
+        return distance;
+    }
+    return ProjectExactly(pNode, rClosestPoint, rArcLength, maxArcLength);
+}
+
+template<unsigned DIM>
+double CentrelineProjectionCache<DIM>::ProjectExactly(Node<DIM>* pNode,
+                                                      c_vector<double, DIM>& rClosestPoint,
+                                                      double& rArcLength,
+                                                      double maxArcLength)
+{
+    const c_vector<double, DIM>& r_location = pNode->rGetLocation();
+    unsigned index = pNode->GetIndex();
+
+    double distance = mCentreline.Project(r_location, rClosestPoint, rArcLength, maxArcLength);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    mNumFullProjections++;
+
+    if (index >= mNodes.size())
+    {
+        Reserve(std::max(index + 1, 2*(unsigned)mNodes.size()));
+    }
+    mNodes[index] = pNode;
+    mIsExact[index] = true;
+    mPieceIndices[index] = mCentreline.GetPieceIndex(rArcLength);
+    mMaxArcLengths[index] = maxArcLength;
+    mLocations[index] = r_location;
+    mDistances[index] = distance;
+    mArcLengths[index] = rArcLength;
+    return distance;
+}
+
+template<unsigned DIM>
+bool CentrelineProjectionCache<DIM>::IsExact(Node<DIM>* pNode) const
+{
+    return HasEntry(pNode) && mIsExact[pNode->GetIndex()];
+}
+
+template<unsigned DIM>
+void CentrelineProjectionCache<DIM>::RecordMoveTowardsCentreline(Node<DIM>* pNode, double distance)
+{
+    assert(HasEntry(pNode));
+    unsigned index = pNode->GetIndex();
+    mLocations[index] = pNode->rGetLocation();
+    mDistances[index] = distance;
+}
+
+template<unsigned DIM>
+double CentrelineProjectionCache<DIM>::GetDistanceUpperBound(Node<DIM>* pNode, double maxArcLength) const
+{
+    if (!HasEntry(pNode))
+    {
+        return DBL_MAX;
+    }
+    unsigned index = pNode->GetIndex();
+    if (maxArcLength < mMaxArcLengths[index])
+    {
+        return DBL_MAX;
+    }
+    return mDistances[index] + norm_2(pNode->rGetLocation() - mLocations[index]);
+}
+
+template<unsigned DIM>
+bool CentrelineProjectionCache<DIM>::GetBounds(Node<DIM>* pNode,
+                                               double maxArcLength,
+                                               double& rMinDistance,
+                                               double& rMaxDistance,
+                                               double& rMinArcLength,
+                                               double& rMaxArcLength) const
+{
+    rMinDistance = 0.0;
+    rMaxDistance = DBL_MAX;
+    rMinArcLength = 0.0;
+    rMaxArcLength = std::min(maxArcLength, mCentreline.GetTotalLength());
+
+    if (!HasEntry(pNode))
+    {
+        return false;
+    }
+    unsigned index = pNode->GetIndex();
+    if (maxArcLength < mMaxArcLengths[index])
+    {
+        return false;
+    }
+
+    double displacement = norm_2(pNode->rGetLocation() - mLocations[index]);
+    rMaxDistance = mDistances[index] + displacement;
+
+    // A distance found from a cached piece may be an overestimate, and growth may have brought the centreline closer
+    if (!mIsExact[index] || maxArcLength != mMaxArcLengths[index])
+    {
+        return true;
+    }
+    rMinDistance = std::max(0.0, mDistances[index] - displacement);
+
+    // Within the turn radius the closest point moves smoothly, at most 1/(1-R/TurnRadius) times as fast as the node
+    double turn_radius = mCentreline.GetTurnRadius();
+    if (rMaxDistance < turn_radius)
+    {
+        double arc_length_change = displacement/(1.0 - rMaxDistance/turn_radius);
+        rMinArcLength = std::max(rMinArcLength, mArcLengths[index] - arc_length_change);
+        rMaxArcLength = std::min(rMaxArcLength, mArcLengths[index] + arc_length_change);
+    }
+    return true;
+}
+
+template<unsigned DIM>
+void CentrelineProjectionCache<DIM>::ResetCounters()
+{
+    mNumFullProjections = 0;
+    mNumPieceProjections = 0;
+}
+
+template<unsigned DIM>
+unsigned CentrelineProjectionCache<DIM>::GetNumFullProjections() const
+{
+    return mNumFullProjections;
+}
+
+template<unsigned DIM>
+unsigned CentrelineProjectionCache<DIM>::GetNumPieceProjections() const
+{
+    return mNumPieceProjections;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class CentrelineProjectionCache<1>;
+template class CentrelineProjectionCache<2>;
+template class CentrelineProjectionCache<3>;
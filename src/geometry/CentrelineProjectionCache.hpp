@@ -0,0 +1,235 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef CENTRELINEPROJECTIONCACHE_HPP_
+#define CENTRELINEPROJECTIONCACHE_HPP_
+
+#include "GonadArmCentreline.hpp"
+#include "Node.hpp"
+#include <vector>
+
+/**
+ * A per-node cache of projections onto a GonadArmCentreline, for boundary conditions whose geometry changes
+ * only slightly from one timestep to the next.
+ *
+ * For each node the cache keeps where the node was when it was last projected, the distance to and arc length
+ * of its closest point then, which piece of the centreline that point was on, and how much of the centreline
+ * had grown. A node that has moved less than the tolerance since, on a centreline that has grown less than the
+ * tolerance, is projected onto the cached piece only, skipping the search over the centreline.
+ *
+ * The distance from a point to the centreline changes by no more than the point moves, and growing the
+ * centreline can only bring it closer, so the cached distance plus the node's displacement is an upper bound on
+ * its distance now. Boundary conditions use this bound to skip cells that are certainly still inside. If the
+ * centreline has not grown, the cached distance less the displacement is a lower bound, and within the turn
+ * radius of the centreline (where every point has a unique closest point) the arc length of the closest point
+ * changes by at most the displacement divided by 1 - R/TurnRadius, so the arc length is bounded too.
+ */
+template<unsigned DIM>
+class CentrelineProjectionCache
+{
+private:
+
+    /** The centreline projected onto. */
+    GonadArmCentreline<DIM> mCentreline;
+
+    /** How far a node or the end of the centreline may move before the node's piece is searched for again. */
+    double mTolerance;
+
+    /** The node each entry belongs to, indexed by node index; NULL if there is no entry. */
+    std::vector<Node<DIM>*> mNodes;
+
+    /** Where each node was when it was last projected. */
+    std::vector<c_vector<double, DIM> > mLocations;
+
+    /** The distance from each node to its closest point when it was last projected. */
+    std::vector<double> mDistances;
+
+    /** The arc length of each node's closest point when it was last projected. */
+    std::vector<double> mArcLengths;
+
+    /** The arc length of the end of the centreline when each node was last projected. */
+    std::vector<double> mMaxArcLengths;
+
+    /** The piece of the centreline each node's closest point was on, as returned by GonadArmCentreline::GetPieceIndex(). */
+    std::vector<unsigned> mPieceIndices;
+
+    /**
+     * Whether each entry came from a search of the whole centreline, rather than from a cached piece. Not a
+     * std::vector<bool>, so that entries for different nodes can be written at the same time.
+     */
+    std::vector<unsigned char> mIsExact;
+
+    /** The number of projections that searched the whole centreline since the counters were reset. */
+    unsigned mNumFullProjections;
+
+    /** The number of projections that reused a cached piece since the counters were reset. */
+    unsigned mNumPieceProjections;
+
+    /**
+     * @return whether there is an entry for a node.
+     *
+     * @param pNode the node
+     */
+    bool HasEntry(Node<DIM>* pNode) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCentreline the centreline to project onto
+     * @param tolerance how far a node or the end of the centreline may move before the node's piece is
+     *     searched for again (defaults to 0.5)
+     */
+    CentrelineProjectionCache(const GonadArmCentreline<DIM>& rCentreline, double tolerance=0.5);
+
+    /**
+     * Remove every entry.
+     */
+    void Clear();
+
+    /**
+     * Make room for entries for every node index below numNodeIndices. Project() may then be called for
+     * different nodes with these indices from several threads at once.
+     *
+     * @param numNodeIndices one more than the largest node index that will be projected
+     */
+    void Reserve(unsigned numNodeIndices);
+
+    /**
+     * Set mTolerance. A tolerance of zero searches the whole centreline every time.
+     *
+     * @param tolerance the new tolerance
+     */
+    void SetTolerance(double tolerance);
+
+    /** @return mTolerance */
+    double GetTolerance() const;
+
+    /**
+     * Find the closest point on the centreline to a node, reusing the node's cached piece if neither it nor the
+     * end of the centreline has moved further than the tolerance, and update the node's entry.
+     *
+     * Reusing a piece can only overestimate the distance, and then only for a node that has crossed into
+     * another piece: the closest point is clamped to the end of the cached piece. Near a junction of a straight
+     * section and the turn this may put the closest point, and the distance, well off, so a caller that moves
+     * the node because the distance is too large should first check it with ProjectExactly() if IsExact() is
+     * false.
+     *
+     * @param pNode the node
+     * @param rClosestPoint filled in with the closest point
+     * @param rArcLength filled in with the arc length of the closest point
+     * @param maxArcLength the arc length of the end of the centreline (defaults to the full length)
+     * @return the distance from the node to the closest point
+     */
+    double Project(Node<DIM>* pNode,
+                   c_vector<double, DIM>& rClosestPoint,
+                   double& rArcLength,
+                   double maxArcLength=DBL_MAX);
+
+    /**
+     * Find the closest point on the centreline to a node by searching the whole centreline, whatever its
+     * entry, and update the entry.
+     *
+     * @param pNode the node
+     * @param rClosestPoint filled in with the closest point
+     * @param rArcLength filled in with the arc length of the closest point
+     * @param maxArcLength the arc length of the end of the centreline (defaults to the full length)
+     * @return the distance from the node to the closest point
+     */
+    double ProjectExactly(Node<DIM>* pNode,
+                          c_vector<double, DIM>& rClosestPoint,
+                          double& rArcLength,
+                          double maxArcLength=DBL_MAX);
+
+    /**
+     * @return whether a node's entry came from a search of the whole centreline, rather than from its cached
+     * piece; false if it has no entry.
+     *
+     * @param pNode the node
+     */
+    bool IsExact(Node<DIM>* pNode) const;
+
+    /**
+     * Update a node's entry after it has been moved along the line towards its closest point, which therefore
+     * remains its closest point.
+     *
+     * @param pNode the node
+     * @param distance the node's new distance from its closest point
+     */
+    void RecordMoveTowardsCentreline(Node<DIM>* pNode, double distance);
+
+    /**
+     * @return an upper bound on the distance from a node to the centreline: its cached distance plus how far it
+     * has moved since, or DBL_MAX if it has no entry or the centreline has shrunk since.
+     *
+     * @param pNode the node
+     * @param maxArcLength the arc length of the end of the centreline now (defaults to the full length)
+     */
+    double GetDistanceUpperBound(Node<DIM>* pNode, double maxArcLength=DBL_MAX) const;
+
+    /**
+     * Find bounds on a node's distance from the centreline and on the arc length of its closest point, from its
+     * entry and how far it has moved since. Where nothing better is known, the bounds are 0 and DBL_MAX for the
+     * distance and the whole of the centreline grown so far for the arc length.
+     *
+     * @param pNode the node
+     * @param maxArcLength the arc length of the end of the centreline now
+     * @param rMinDistance filled in with a lower bound on the distance
+     * @param rMaxDistance filled in with an upper bound on the distance
+     * @param rMinArcLength filled in with a lower bound on the arc length
+     * @param rMaxArcLength filled in with an upper bound on the arc length
+     * @return whether the node has an entry that the bounds were found from
+     */
+    bool GetBounds(Node<DIM>* pNode,
+                   double maxArcLength,
+                   double& rMinDistance,
+                   double& rMaxDistance,
+                   double& rMinArcLength,
+                   double& rMaxArcLength) const;
+
+    /**
+     * Reset the projection counters.
+     */
+    void ResetCounters();
+
+    /** @return mNumFullProjections */
+    unsigned GetNumFullProjections() const;
+
+    /** @return mNumPieceProjections */
+    unsigned GetNumPieceProjections() const;
+};
+
+#endif /*CENTRELINEPROJECTIONCACHE_HPP_*/
@@ -0,0 +1,298 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GonadArmCentreline.hpp"
+#include "Exception.hpp"
+#include <cmath>
+#include <algorithm>
+
+template<unsigned DIM>
+GonadArmCentreline<DIM>::GonadArmCentreline(double straightLengthLower,
+                                            double straightLengthUpper,
+                                            double turnRadius)
+    : mStraightLengthLower(straightLengthLower),
+      mStraightLengthUpper(straightLengthUpper),
+      mTurnRadius(turnRadius)
+{
+    assert(mStraightLengthLower > 0.0);
+    assert(mStraightLengthUpper > 0.0);
+    assert(mTurnRadius > 0.0);
+
+    if (DIM == 1)
+    {
+        EXCEPTION("GonadArmCentreline is only defined in 2D and 3D.");
+    }
+}
+
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::GetTotalLength() const
+{
+    return mStraightLengthLower + M_PI*mTurnRadius + mStraightLengthUpper;
+}
+
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::GetTurnStart() const
+{
+    return mStraightLengthLower;
+}
+
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::GetTurnEnd() const
+{
+    return mStraightLengthLower + M_PI*mTurnRadius;
+}
+
+/*Getter method for each parameter*/
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::GetStraightLengthLower() const
+{
+    return mStraightLengthLower;
+}
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::GetStraightLengthUpper() const
+{
+    return mStraightLengthUpper;
+}
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::GetTurnRadius() const
+{
+    return mTurnRadius;
+}
+
+template<unsigned DIM>
+c_vector<double, DIM> GonadArmCentreline<DIM>::GetPointAtArcLength(double arcLength) const
+{
+    double s = std::max(0.0, std::min(arcLength, GetTotalLength()));
+    c_vector<double, DIM> point = zero_vector<double>(DIM);
+
+    if (s <= GetTurnStart())
+    {
+        point[0] = mStraightLengthLower - s;
+        point[1] = -mTurnRadius;
+    }
+    else if (s < GetTurnEnd())
+    {
+        // The angle turned through, measured from the -y axis towards -x
+        double angle = (s - GetTurnStart())/mTurnRadius;
+        point[0] = -mTurnRadius*sin(angle);
+        point[1] = -mTurnRadius*cos(angle);
+    }
+    else
+    {
+        point[0] = s - GetTurnEnd();
+        point[1] = mTurnRadius;
+    }
+    return point;
+}
+
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::Project(const c_vector<double, DIM>& rLocation,
+                                        c_vector<double, DIM>& rClosestPoint,
+                                        double& rArcLength,
+                                        double maxArcLength) const
+{
+    double s_max = std::min(maxArcLength, GetTotalLength());
+    assert(s_max >= 0.0);
+
+    rClosestPoint = zero_vector<double>(DIM);
+
+    // 1) Only the proximal straight, from x=mStraightLengthLower down to x=mStraightLengthLower-s_max
+    if (s_max <= GetTurnStart())
+    {
+        rClosestPoint[0] = std::max(mStraightLengthLower - s_max, std::min(rLocation[0], mStraightLengthLower));
+        rClosestPoint[1] = -mTurnRadius;
+        rArcLength = mStraightLengthLower - rClosestPoint[0];
+        return norm_2(rLocation - rClosestPoint);
+    }
+
+    // 2) The turn is complete, so the half plane x<=0 belongs to the turn and x>0 to the straights. Each end of
+    // the turn is also an end of a straight, so no other part of the centreline can be closer.
+    if (s_max >= GetTurnEnd())
+    {
+        double x_max_upper = std::min(s_max - GetTurnEnd(), mStraightLengthUpper);
+
+        if (rLocation[0] <= 0.0)
+        {
+            // Radial projection onto the circle; the angle from -y towards -x is in [0, pi] in this half plane
+            double planar_radius = sqrt(rLocation[0]*rLocation[0] + rLocation[1]*rLocation[1]);
+            double angle = (planar_radius > 0.0) ? atan2(fabs(rLocation[0]), -rLocation[1]) : 0.0;
+            rClosestPoint[0] = -mTurnRadius*sin(angle);
+            rClosestPoint[1] = -mTurnRadius*cos(angle);
+            rArcLength = GetTurnStart() + mTurnRadius*angle;
+            return norm_2(rLocation - rClosestPoint);
+        }
+
+        // The straight on the same side of the x axis is closer, unless the location is beyond its end
+        bool is_below = (rLocation[1] < 0.0);
+        double x_end = is_below ? mStraightLengthLower : x_max_upper;
+        rClosestPoint[0] = std::min(rLocation[0], x_end);
+        rClosestPoint[1] = is_below ? -mTurnRadius : mTurnRadius;
+        double distance = norm_2(rLocation - rClosestPoint);
+
+        if (rLocation[0] > x_end)
+        {
+            c_vector<double, DIM> other_point = zero_vector<double>(DIM);
+            other_point[0] = std::min(rLocation[0], is_below ? x_max_upper : mStraightLengthLower);
+            other_point[1] = -rClosestPoint[1];
+            double other_distance = norm_2(rLocation - other_point);
+            if (other_distance < distance)
+            {
+                distance = other_distance;
+                rClosestPoint = other_point;
+                is_below = !is_below;
+            }
+        }
+        rArcLength = is_below ? mStraightLengthLower - rClosestPoint[0] : GetTurnEnd() + rClosestPoint[0];
+        return distance;
+    }
+
+    // 3) Part of the turn has grown: compare the proximal straight with the arc grown so far
+    double best_distance = DBL_MAX;
+    c_vector<double, DIM> candidate = zero_vector<double>(DIM);
+    {
+        candidate[0] = std::max(0.0, std::min(rLocation[0], mStraightLengthLower));
+        candidate[1] = -mTurnRadius;
+        best_distance = norm_2(rLocation - candidate);
+        rClosestPoint = candidate;
+        rArcLength = mStraightLengthLower - candidate[0];
+    }
+    {
+        double max_angle = (s_max - GetTurnStart())/mTurnRadius;
+        // The angle of the location about the z axis, measured from -y towards -x, in (-pi, pi]
+        double angle = atan2(-rLocation[0], -rLocation[1]);
+        if (angle < 0.0 || angle > max_angle)
+        {
+            // Outside the arc, so the closest point is one of its ends; take whichever is nearer
+            double angle_to_start = fabs(angle);
+            double angle_to_end = fabs(angle - max_angle);
+            angle = (std::min(angle_to_start, 2.0*M_PI-angle_to_start) <= std::min(angle_to_end, 2.0*M_PI-angle_to_end)) ? 0.0 : max_angle;
+        }
+        candidate[0] = -mTurnRadius*sin(angle);
+        candidate[1] = -mTurnRadius*cos(angle);
+        double distance = norm_2(rLocation - candidate);
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            rClosestPoint = candidate;
+            rArcLength = GetTurnStart() + mTurnRadius*angle;
+        }
+    }
+
+    return best_distance;
+}
+
+template<unsigned DIM>
+unsigned GonadArmCentreline<DIM>::GetPieceIndex(double arcLength) const
+{
+    if (arcLength <= GetTurnStart())
+    {
+        return 0;
+    }
+    return (arcLength < GetTurnEnd()) ? 1 : 2;
+}
+
+template<unsigned DIM>
+double GonadArmCentreline<DIM>::ProjectOntoPiece(const c_vector<double, DIM>& rLocation,
+                                                 unsigned pieceIndex,
+                                                 c_vector<double, DIM>& rClosestPoint,
+                                                 double& rArcLength,
+                                                 double maxArcLength) const
+{
+    assert(pieceIndex < 3);
+    double s_max = std::min(maxArcLength, GetTotalLength());
+    assert(s_max >= 0.0);
+
+    rClosestPoint = zero_vector<double>(DIM);
+
+    if (pieceIndex == 0)
+    {
+        rClosestPoint[0] = std::max(mStraightLengthLower - std::min(s_max, mStraightLengthLower), std::min(rLocation[0], mStraightLengthLower));
+        rClosestPoint[1] = -mTurnRadius;
+        rArcLength = mStraightLengthLower - rClosestPoint[0];
+    }
+    else if (pieceIndex == 1 && s_max > GetTurnStart())
+    {
+        double max_angle = std::min(M_PI, (s_max - GetTurnStart())/mTurnRadius);
+        // The angle of the location about the z axis, measured from -y towards -x, in (-pi, pi]
+        double angle = atan2(-rLocation[0], -rLocation[1]);
+        if (angle < 0.0 || angle > max_angle)
+        {
+            // Outside the arc, so the closest point is whichever end is nearer, as in Project()
+            double angle_to_start = fabs(angle);
+            double angle_to_end = fabs(angle - max_angle);
+            angle = (std::min(angle_to_start, 2.0*M_PI-angle_to_start) <= std::min(angle_to_end, 2.0*M_PI-angle_to_end)) ? 0.0 : max_angle;
+        }
+        rClosestPoint[0] = -mTurnRadius*sin(angle);
+        rClosestPoint[1] = -mTurnRadius*cos(angle);
+        rArcLength = GetTurnStart() + mTurnRadius*angle;
+    }
+    else if (pieceIndex == 2 && s_max >= GetTurnEnd())
+    {
+        rClosestPoint[0] = std::max(0.0, std::min(rLocation[0], std::min(s_max - GetTurnEnd(), mStraightLengthUpper)));
+        rClosestPoint[1] = mTurnRadius;
+        rArcLength = GetTurnEnd() + rClosestPoint[0];
+    }
+    else
+    {
+        // The piece has not grown yet
+        return Project(rLocation, rClosestPoint, rArcLength, maxArcLength);
+    }
+    return norm_2(rLocation - rClosestPoint);
+}
+
+template<unsigned DIM>
+void GonadArmCentreline<DIM>::ProjectAll(const std::vector<c_vector<double, DIM> >& rLocations,
+                                         std::vector<c_vector<double, DIM> >& rClosestPoints,
+                                         std::vector<double>& rArcLengths,
+                                         std::vector<double>& rDistances,
+                                         double maxArcLength) const
+{
+    unsigned num_locations = rLocations.size();
+    rClosestPoints.resize(num_locations);
+    rArcLengths.resize(num_locations);
+    rDistances.resize(num_locations);
+    for (unsigned i=0; i<num_locations; i++)
+    {
+        rDistances[i] = Project(rLocations[i], rClosestPoints[i], rArcLengths[i], maxArcLength);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class GonadArmCentreline<1>;
+template class GonadArmCentreline<2>;
+template class GonadArmCentreline<3>;
@@ -0,0 +1,182 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GONADARMCENTRELINE_HPP_
+#define GONADARMCENTRELINE_HPP_
+
+#include "UblasVectorInclude.hpp"
+#include "ChasteSerialization.hpp"
+#include <cfloat>
+#include <vector>
+
+/**
+ * The centreline (growth path) of the adult gonad arm: a straight of length StraightLengthLower along the x axis
+ * at y=-TurnRadius, running from x=StraightLengthLower back to x=0, a semicircle of radius TurnRadius about the
+ * z axis through negative x, and a straight of length StraightLengthUpper at y=+TurnRadius running from x=0 out
+ * to x=StraightLengthUpper, where the distal tip is.
+ *
+ * Points on the centreline are labelled by their arc length s, measured from the proximal end (s=0) towards
+ * the distal tip (s=GetTotalLength()). The gonad arm boundary conditions find cells' closest points and arc
+ * lengths with Project().
+ *
+ * Only the x and y coordinates of a location are used to find its closest centreline point, so the class works
+ * in 2D and 3D.
+ */
+template<unsigned DIM>
+class GonadArmCentreline
+{
+private:
+
+    /** Length of the proximal straight. */
+    double mStraightLengthLower;
+
+    /** Length of the distal straight. */
+    double mStraightLengthUpper;
+
+    /** Radius of the semicircular turn. */
+    double mTurnRadius;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object.
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mStraightLengthLower;
+        archive & mStraightLengthUpper;
+        archive & mTurnRadius;
+    }
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param straightLengthLower length of the proximal straight (defaults to 176, the adult arm)
+     * @param straightLengthUpper length of the distal straight (defaults to 161)
+     * @param turnRadius radius of the turn (defaults to 20)
+     */
+    GonadArmCentreline(double straightLengthLower=176.0,
+                       double straightLengthUpper=161.0,
+                       double turnRadius=20.0);
+
+    /** @return the total arc length of the centreline. */
+    double GetTotalLength() const;
+
+    /** @return the arc length at which the turn starts. */
+    double GetTurnStart() const;
+
+    /** @return the arc length at which the turn ends and the distal straight starts. */
+    double GetTurnEnd() const;
+
+    /*Functions returning the parameter values*/
+    double GetStraightLengthLower() const;
+    double GetStraightLengthUpper() const;
+    double GetTurnRadius() const;
+
+    /**
+     * @return the point on the centreline at a given arc length. Arc lengths outside [0, GetTotalLength()]
+     * are clamped to the ends.
+     *
+     * @param arcLength the arc length
+     */
+    c_vector<double, DIM> GetPointAtArcLength(double arcLength) const;
+
+    /**
+     * Find the closest point to a location on the part of the centreline with arc length in [0, maxArcLength].
+     * Restricting the arc length lets a growing arm use the centreline grown so far.
+     *
+     * The part of the centreline the closest point lies on is found from the location's quadrant, so that usually
+     * only one distance is calculated. Only while the turn is partly grown are the straight and arc compared.
+     *
+     * @param rLocation the location
+     * @param rClosestPoint filled in with the closest point on the centreline
+     * @param rArcLength filled in with the arc length of the closest point
+     * @param maxArcLength the arc length of the end of the centreline (defaults to the full length)
+     * @return the distance from the location to the closest point
+     */
+    double Project(const c_vector<double, DIM>& rLocation,
+                   c_vector<double, DIM>& rClosestPoint,
+                   double& rArcLength,
+                   double maxArcLength=DBL_MAX) const;
+
+    /**
+     * @return which piece of the centreline a given arc length lies on: 0 for the proximal straight, 1 for the
+     * turn and 2 for the distal straight.
+     *
+     * @param arcLength the arc length
+     */
+    unsigned GetPieceIndex(double arcLength) const;
+
+    /**
+     * Find the closest point to a location on one piece of the centreline, restricted to the arc lengths in
+     * [0, maxArcLength]. The distance returned is never less than that returned by Project(), and equals it
+     * if the piece is the one containing the closest point, so a piece found earlier can be reused for a
+     * location that has not moved far. If none of the piece has grown yet, the whole centreline is used.
+     *
+     * @param rLocation the location
+     * @param pieceIndex the piece, as returned by GetPieceIndex()
+     * @param rClosestPoint filled in with the closest point on the piece
+     * @param rArcLength filled in with the arc length of the closest point
+     * @param maxArcLength the arc length of the end of the centreline (defaults to the full length)
+     * @return the distance from the location to the closest point
+     */
+    double ProjectOntoPiece(const c_vector<double, DIM>& rLocation,
+                            unsigned pieceIndex,
+                            c_vector<double, DIM>& rClosestPoint,
+                            double& rArcLength,
+                            double maxArcLength=DBL_MAX) const;
+
+    /**
+     * Project a batch of locations, as in Project().
+     *
+     * @param rLocations the locations
+     * @param rClosestPoints filled in with the closest point on the centreline to each location
+     * @param rArcLengths filled in with the arc length of each closest point
+     * @param rDistances filled in with the distance from each location to its closest point
+     * @param maxArcLength the arc length of the end of the centreline (defaults to the full length)
+     */
+    void ProjectAll(const std::vector<c_vector<double, DIM> >& rLocations,
+                    std::vector<c_vector<double, DIM> >& rClosestPoints,
+                    std::vector<double>& rArcLengths,
+                    std::vector<double>& rDistances,
+                    double maxArcLength=DBL_MAX) const;
+};
+
+#endif /*GONADARMCENTRELINE_HPP_*/
@@ -0,0 +1,155 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GonadArmSpatialIndex.hpp"
+#include <cmath>
+#include <algorithm>
+
+template<unsigned DIM>
+GonadArmSpatialIndex<DIM>::GonadArmSpatialIndex(const GonadArmCentreline<DIM>& rCentreline, double bucketLength)
+    : mCentreline(rCentreline),
+      mBucketLength(bucketLength)
+{
+    assert(mBucketLength > 0.0);
+
+    mNumBuckets = std::max(1u, (unsigned)ceil(mCentreline.GetTotalLength()/mBucketLength));
+    mBucketCentres.resize(mNumBuckets);
+    for (unsigned bucket=0; bucket<mNumBuckets; bucket++)
+    {
+        mBucketCentres[bucket] = mCentreline.GetPointAtArcLength((bucket+0.5)*mBucketLength);
+    }
+    mBucketContents.resize(mNumBuckets);
+    mBucketRadii.resize(mNumBuckets);
+}
+
+template<unsigned DIM>
+const GonadArmCentreline<DIM>& GonadArmSpatialIndex<DIM>::rGetCentreline() const
+{
+    return mCentreline;
+}
+
+template<unsigned DIM>
+double GonadArmSpatialIndex<DIM>::GetBucketLength() const
+{
+    return mBucketLength;
+}
+
+template<unsigned DIM>
+unsigned GonadArmSpatialIndex<DIM>::GetNumBuckets() const
+{
+    return mNumBuckets;
+}
+
+template<unsigned DIM>
+unsigned GonadArmSpatialIndex<DIM>::CalculateBucketIndex(const c_vector<double, DIM>& rLocation) const
+{
+    c_vector<double, DIM> closest_point;
+    double arc_length;
+    mCentreline.Project(rLocation, closest_point, arc_length);
+
+    unsigned bucket = (unsigned)floor(arc_length/mBucketLength);
+    return std::min(bucket, mNumBuckets-1);
+}
+
+template<unsigned DIM>
+void GonadArmSpatialIndex<DIM>::CalculatePairs(const std::vector<c_vector<double, DIM> >& rLocations,
+                                               double interactionDistance,
+                                               std::vector<std::pair<unsigned, unsigned> >& rPairs)
+{
+    rPairs.clear();
+
+    // Bucket the points and find each bucket's bounding sphere
+    for (unsigned bucket=0; bucket<mNumBuckets; bucket++)
+    {
+        mBucketContents[bucket].clear();
+        mBucketRadii[bucket] = 0.0;
+    }
+    for (unsigned i=0; i<rLocations.size(); i++)
+    {
+        unsigned bucket = CalculateBucketIndex(rLocations[i]);
+        mBucketContents[bucket].push_back(i);
+        mBucketRadii[bucket] = std::max(mBucketRadii[bucket], norm_2(rLocations[i] - mBucketCentres[bucket]));
+    }
+
+    std::vector<unsigned> occupied_buckets;
+    for (unsigned bucket=0; bucket<mNumBuckets; bucket++)
+    {
+        if (!mBucketContents[bucket].empty())
+        {
+            occupied_buckets.push_back(bucket);
+        }
+    }
+
+    // Search each bucket against itself and every later bucket whose sphere is within reach
+    for (unsigned i=0; i<occupied_buckets.size(); i++)
+    {
+        unsigned bucket_a = occupied_buckets[i];
+        const std::vector<unsigned>& r_points_a = mBucketContents[bucket_a];
+
+        for (unsigned j=i; j<occupied_buckets.size(); j++)
+        {
+            unsigned bucket_b = occupied_buckets[j];
+            double reach = mBucketRadii[bucket_a] + mBucketRadii[bucket_b] + interactionDistance;
+            if (norm_2(mBucketCentres[bucket_a] - mBucketCentres[bucket_b]) > reach)
+            {
+                continue;
+            }
+
+            const std::vector<unsigned>& r_points_b = mBucketContents[bucket_b];
+            for (unsigned a=0; a<r_points_a.size(); a++)
+            {
+                // Within a bucket, only look at each pair once
+                unsigned first_b = (bucket_a == bucket_b) ? a+1 : 0;
+                for (unsigned b=first_b; b<r_points_b.size(); b++)
+                {
+                    unsigned index_a = r_points_a[a];
+                    unsigned index_b = r_points_b[b];
+                    if (norm_2(rLocations[index_a] - rLocations[index_b]) < interactionDistance)
+                    {
+                        rPairs.push_back(std::pair<unsigned, unsigned>(std::min(index_a, index_b), std::max(index_a, index_b)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class GonadArmSpatialIndex<1>;
+template class GonadArmSpatialIndex<2>;
+template class GonadArmSpatialIndex<3>;
@@ -0,0 +1,115 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GONADARMSPATIALINDEX_HPP_
+#define GONADARMSPATIALINDEX_HPP_
+
+#include "GonadArmCentreline.hpp"
+#include <vector>
+
+/**
+ * A spatial index for finding pairs of nearby points in the gonad arm, bucketing points by the arc length of
+ * their closest point on the arm's centreline rather than by a 3D grid over the arm's bounding box.
+ *
+ * The arm is a long thin U-shaped tube, so almost all boxes of a bounding-box grid are empty; arc length
+ * buckets are all (nearly) occupied and keep neighbouring points in neighbouring buckets. Each time pairs are
+ * calculated, every non-empty bucket gets a bounding sphere about the centreline point at the middle of its
+ * arc length, just enclosing the points in it. Two buckets are searched against each other only if their
+ * spheres come within the interaction distance. This finds every pair wherever it is, including across the
+ * inside of the turn and between the two straights, without assuming anything about how far points stray from
+ * the centreline.
+ */
+template<unsigned DIM>
+class GonadArmSpatialIndex
+{
+private:
+
+    /** The centreline used to assign arc lengths. */
+    GonadArmCentreline<DIM> mCentreline;
+
+    /** The arc length covered by each bucket. */
+    double mBucketLength;
+
+    /** The number of buckets along the centreline. */
+    unsigned mNumBuckets;
+
+    /** The centre of each bucket's bounding sphere: the centreline point in the middle of its arc length. */
+    std::vector<c_vector<double, DIM> > mBucketCentres;
+
+    /** The indices of the points in each bucket. Work space, refilled by CalculatePairs(). */
+    std::vector<std::vector<unsigned> > mBucketContents;
+
+    /** The radius of each bucket's bounding sphere. Work space, refilled by CalculatePairs(). */
+    std::vector<double> mBucketRadii;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCentreline the gonad arm centreline
+     * @param bucketLength the arc length covered by each bucket, typically around the interaction distance
+     */
+    GonadArmSpatialIndex(const GonadArmCentreline<DIM>& rCentreline, double bucketLength);
+
+    /** @return the centreline. */
+    const GonadArmCentreline<DIM>& rGetCentreline() const;
+
+    /** @return mBucketLength */
+    double GetBucketLength() const;
+
+    /** @return mNumBuckets */
+    unsigned GetNumBuckets() const;
+
+    /**
+     * @return the bucket a location belongs in.
+     *
+     * @param rLocation the location
+     */
+    unsigned CalculateBucketIndex(const c_vector<double, DIM>& rLocation) const;
+
+    /**
+     * Find all pairs of points closer than a given distance.
+     *
+     * @param rLocations the points
+     * @param interactionDistance pairs closer than this are returned
+     * @param rPairs filled in with the pairs, as indices into rLocations, the lower index first
+     */
+    void CalculatePairs(const std::vector<c_vector<double, DIM> >& rLocations,
+                        double interactionDistance,
+                        std::vector<std::pair<unsigned, unsigned> >& rPairs);
+};
+
+#endif /*GONADARMSPATIALINDEX_HPP_*/
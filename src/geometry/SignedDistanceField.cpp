@@ -0,0 +1,275 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SignedDistanceField.hpp"
+#include "Exception.hpp"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+template<unsigned DIM>
+SignedDistanceField<DIM>::SignedDistanceField()
+    : mOrigin(zero_vector<double>(DIM)),
+      mSpacing(1.0),
+      mNumPoints(DIM, 0)
+{
+}
+
+template<unsigned DIM>
+SignedDistanceField<DIM>::SignedDistanceField(const c_vector<double, DIM>& rLowerCorner,
+                                              const c_vector<double, DIM>& rUpperCorner,
+                                              double spacing)
+    : mOrigin(rLowerCorner),
+      mSpacing(spacing),
+      mNumPoints(DIM, 0)
+{
+    if (mSpacing <= 0.0)
+    {
+        EXCEPTION("The grid spacing of a signed distance field must be positive.");
+    }
+
+    unsigned num_values = 1;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        if (rUpperCorner[d] <= rLowerCorner[d])
+        {
+            EXCEPTION("The upper corner of a signed distance field must be above its lower corner.");
+        }
+        // At least two points in each direction, so every location lies in some grid cell
+        mNumPoints[d] = std::max(2u, 1u + (unsigned)ceil((rUpperCorner[d] - rLowerCorner[d])/mSpacing - 1e-9));
+        num_values *= mNumPoints[d];
+    }
+    mValues.assign(num_values, 0.0);
+}
+
+template<unsigned DIM>
+c_vector<double, DIM> SignedDistanceField<DIM>::GetGridPointLocation(unsigned pointIndex) const
+{
+    c_vector<double, DIM> location;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        location[d] = mOrigin[d] + mSpacing*(pointIndex%mNumPoints[d]);
+        pointIndex /= mNumPoints[d];
+    }
+    return location;
+}
+
+template<unsigned DIM>
+void SignedDistanceField<DIM>::Sample(const AbstractSignedDistanceFunction<DIM>& rFunction)
+{
+    for (unsigned i=0; i<mValues.size(); i++)
+    {
+        mValues[i] = rFunction.GetSignedDistance(GetGridPointLocation(i));
+    }
+}
+
+template<unsigned DIM>
+double SignedDistanceField<DIM>::GetSignedDistance(const c_vector<double, DIM>& rLocation, c_vector<double, DIM>& rGradient) const
+{
+    assert(!mValues.empty());
+
+    // Find the grid cell containing the (clamped) location, and the location's fractional position in it
+    unsigned cell_corner_index = 0;
+    unsigned stride = 1;
+    std::vector<unsigned> strides(DIM);
+    c_vector<double, DIM> fractions;
+    c_vector<double, DIM> excess = zero_vector<double>(DIM);
+    for (unsigned d=0; d<DIM; d++)
+    {
+        double max_position = mNumPoints[d] - 1.0;
+        double position = (rLocation[d] - mOrigin[d])/mSpacing;
+        double clamped_position = std::max(0.0, std::min(position, max_position));
+        excess[d] = (position - clamped_position)*mSpacing;
+
+        unsigned cell = std::min((unsigned)clamped_position, mNumPoints[d] - 2);
+        fractions[d] = clamped_position - cell;
+        cell_corner_index += cell*stride;
+        strides[d] = stride;
+        stride *= mNumPoints[d];
+    }
+
+    // Multilinear interpolation over the 2^DIM corners of the cell, differentiating each weight for the gradient
+    double value = 0.0;
+    rGradient = zero_vector<double>(DIM);
+    for (unsigned corner=0; corner<(1u<<DIM); corner++)
+    {
+        unsigned index = cell_corner_index;
+        double weight = 1.0;
+        for (unsigned d=0; d<DIM; d++)
+        {
+            bool is_upper = (corner>>d) & 1u;
+            index += is_upper ? strides[d] : 0;
+            weight *= is_upper ? fractions[d] : 1.0 - fractions[d];
+        }
+        double corner_value = mValues[index];
+        value += weight*corner_value;
+
+        for (unsigned d=0; d<DIM; d++)
+        {
+            bool is_upper = (corner>>d) & 1u;
+            double other_weights = 1.0;
+            for (unsigned k=0; k<DIM; k++)
+            {
+                if (k != d)
+                {
+                    other_weights *= ((corner>>k) & 1u) ? fractions[k] : 1.0 - fractions[k];
+                }
+            }
+            rGradient[d] += (is_upper ? 1.0 : -1.0)*other_weights*corner_value/mSpacing;
+        }
+    }
+
+    // Outside the grid, add the distance to it, which pulls the location back towards the grid
+    double excess_distance = norm_2(excess);
+    if (excess_distance > 0.0)
+    {
+        value += excess_distance;
+        rGradient += excess/excess_distance;
+    }
+    return value;
+}
+
+template<unsigned DIM>
+double SignedDistanceField<DIM>::GetSignedDistance(const c_vector<double, DIM>& rLocation) const
+{
+    c_vector<double, DIM> gradient;
+    return GetSignedDistance(rLocation, gradient);
+}
+
+template<unsigned DIM>
+void SignedDistanceField<DIM>::SaveToFile(const std::string& rFileName) const
+{
+    std::ofstream file(rFileName.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open signed distance field file " + rFileName + " for writing.");
+    }
+
+    file << DIM << "\n";
+    for (unsigned d=0; d<DIM; d++)
+    {
+        file << mNumPoints[d] << (d+1 < DIM ? " " : "\n");
+    }
+    file << std::setprecision(17);
+    for (unsigned d=0; d<DIM; d++)
+    {
+        file << mOrigin[d] << (d+1 < DIM ? " " : "\n");
+    }
+    file << mSpacing << "\n";
+    for (unsigned i=0; i<mValues.size(); i++)
+    {
+        file << mValues[i] << "\n";
+    }
+}
+
+template<unsigned DIM>
+void SignedDistanceField<DIM>::LoadFromFile(const std::string& rFileName)
+{
+    std::ifstream file(rFileName.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open signed distance field file " + rFileName + ".");
+    }
+
+    unsigned dimension = 0;
+    file >> dimension;
+    if (dimension != DIM)
+    {
+        EXCEPTION("The signed distance field in " + rFileName + " has the wrong dimension.");
+    }
+
+    unsigned num_values = 1;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        file >> mNumPoints[d];
+        if (mNumPoints[d] < 2)
+        {
+            EXCEPTION("The signed distance field in " + rFileName + " needs at least two points in each direction.");
+        }
+        num_values *= mNumPoints[d];
+    }
+    for (unsigned d=0; d<DIM; d++)
+    {
+        file >> mOrigin[d];
+    }
+    file >> mSpacing;
+
+    mValues.resize(num_values);
+    for (unsigned i=0; i<num_values; i++)
+    {
+        file >> mValues[i];
+    }
+    if (file.fail() || mSpacing <= 0.0)
+    {
+        EXCEPTION("The signed distance field in " + rFileName + " could not be read.");
+    }
+}
+
+template<unsigned DIM>
+const c_vector<double, DIM>& SignedDistanceField<DIM>::rGetOrigin() const
+{
+    return mOrigin;
+}
+
+template<unsigned DIM>
+double SignedDistanceField<DIM>::GetSpacing() const
+{
+    return mSpacing;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& SignedDistanceField<DIM>::rGetNumPoints() const
+{
+    return mNumPoints;
+}
+
+template<unsigned DIM>
+const std::vector<double>& SignedDistanceField<DIM>::rGetValues() const
+{
+    return mValues;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class SignedDistanceField<1>;
+template class SignedDistanceField<2>;
+template class SignedDistanceField<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SignedDistanceField)
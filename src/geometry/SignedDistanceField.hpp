@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SIGNEDDISTANCEFIELD_HPP_
+#define SIGNEDDISTANCEFIELD_HPP_
+
+#include "AbstractSignedDistanceFunction.hpp"
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/vector.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * A signed distance function sampled on a regular grid with equal spacing in every direction, and evaluated
+ * (with its gradient) by multilinear (in 3D trilinear) interpolation between the grid points, so that a lookup
+ * costs the same whatever the shape.
+ *
+ * The field can be sampled from any AbstractSignedDistanceFunction, such as one of the analytic boundary
+ * conditions or a SurfaceMeshDistanceFunction, or loaded from a file written by SaveToFile() (or by any other
+ * tool writing the same format). Locations outside the grid are clamped to it and their distance from the grid
+ * added to the interpolated value, which is an overestimate of the distance outside the domain.
+ *
+ * The file format is plain text: the dimension, the number of points in each direction, the coordinates of the
+ * first grid point, the spacing, then the values with the first coordinate varying fastest.
+ */
+template<unsigned DIM>
+class SignedDistanceField : public AbstractSignedDistanceFunction<DIM>
+{
+private:
+
+    /** The location of the first grid point (the lower corner of the grid). */
+    c_vector<double, DIM> mOrigin;
+
+    /** The spacing of the grid points. */
+    double mSpacing;
+
+    /** The number of grid points in each direction. */
+    std::vector<unsigned> mNumPoints;
+
+    /** The value at each grid point, with the first coordinate varying fastest. */
+    std::vector<double> mValues;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object.
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mOrigin;
+        archive & mSpacing;
+        archive & mNumPoints;
+        archive & mValues;
+    }
+
+    /**
+     * @return the location of a grid point.
+     *
+     * @param pointIndex the index of the grid point in mValues
+     */
+    c_vector<double, DIM> GetGridPointLocation(unsigned pointIndex) const;
+
+public:
+
+    /**
+     * Default constructor, making an empty field to be loaded from a file or an archive.
+     */
+    SignedDistanceField();
+
+    /**
+     * Constructor. Makes a field of zeros on a grid covering the box between two corners; the upper corner is
+     * rounded up to a whole number of spacings.
+     *
+     * @param rLowerCorner the lower corner of the grid
+     * @param rUpperCorner the upper corner of the grid
+     * @param spacing the spacing of the grid points
+     */
+    SignedDistanceField(const c_vector<double, DIM>& rLowerCorner,
+                        const c_vector<double, DIM>& rUpperCorner,
+                        double spacing);
+
+    /**
+     * Set the value at every grid point from a signed distance function.
+     *
+     * @param rFunction the function to sample
+     */
+    void Sample(const AbstractSignedDistanceFunction<DIM>& rFunction);
+
+    /**
+     * @return the interpolated signed distance at a location.
+     *
+     * @param rLocation the location
+     * @param rGradient filled in with the gradient of the interpolated distance
+     */
+    double GetSignedDistance(const c_vector<double, DIM>& rLocation, c_vector<double, DIM>& rGradient) const;
+
+    /**
+     * Overridden GetSignedDistance() method.
+     *
+     * @return the interpolated signed distance at a location.
+     *
+     * @param rLocation the location
+     */
+    double GetSignedDistance(const c_vector<double, DIM>& rLocation) const;
+
+    /**
+     * Write the field to a file.
+     *
+     * @param rFileName the full path of the file
+     */
+    void SaveToFile(const std::string& rFileName) const;
+
+    /**
+     * Replace the field by one read from a file.
+     *
+     * @param rFileName the full path of the file
+     */
+    void LoadFromFile(const std::string& rFileName);
+
+    /** @return the location of the first grid point. */
+    const c_vector<double, DIM>& rGetOrigin() const;
+
+    /** @return the spacing of the grid points. */
+    double GetSpacing() const;
+
+    /** @return the number of grid points in each direction. */
+    const std::vector<unsigned>& rGetNumPoints() const;
+
+    /** @return the value at each grid point. */
+    const std::vector<double>& rGetValues() const;
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SignedDistanceField)
+
+#endif /*SIGNEDDISTANCEFIELD_HPP_*/
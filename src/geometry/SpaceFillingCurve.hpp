@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SPACEFILLINGCURVE_HPP_
+#define SPACEFILLINGCURVE_HPP_
+
+#include "UblasVectorInclude.hpp"
+#include <boost/cstdint.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Helper functions for ordering points along a Morton (Z-order) space-filling curve, so that points close in
+ * space end up close in memory.
+ *
+ * Space is divided into cubes of a given size starting from an origin, and each point's key is its cube's
+ * integer coordinates with their bits interleaved. Sorting by key visits the cubes in Z order. Each coordinate
+ * gets 63/DIM bits (21 in 3D), and points beyond that range are clamped onto the last cube.
+ */
+class SpaceFillingCurve
+{
+public:
+
+    /**
+     * @return the Morton key of a point.
+     *
+     * @param rLocation the point
+     * @param rOrigin the lower corner of the region being ordered
+     * @param cubeSize the side length of each cube
+     */
+    template<unsigned DIM>
+    static boost::uint64_t CalculateMortonKey(const c_vector<double, DIM>& rLocation,
+                                              const c_vector<double, DIM>& rOrigin,
+                                              double cubeSize)
+    {
+        const unsigned bits_per_coordinate = 63/DIM;
+        const double max_cube = (double)((boost::uint64_t(1) << bits_per_coordinate) - 1);
+
+        boost::uint64_t cubes[DIM];
+        for (unsigned d=0; d<DIM; d++)
+        {
+            double cube = floor((rLocation[d] - rOrigin[d])/cubeSize);
+            cubes[d] = (boost::uint64_t)std::max(0.0, std::min(cube, max_cube));
+        }
+
+        boost::uint64_t key = 0;
+        for (unsigned bit=0; bit<bits_per_coordinate; bit++)
+        {
+            for (unsigned d=0; d<DIM; d++)
+            {
+                key |= ((cubes[d] >> bit) & 1) << (bit*DIM + d);
+            }
+        }
+        return key;
+    }
+
+    /**
+     * Calculate the order in which to visit a set of points along the Morton curve covering their bounding box.
+     * Points sharing a key keep their original relative order.
+     *
+     * @param rLocations the points
+     * @param cubeSize the side length of each cube; around the typical spacing of the points works well
+     * @param rOrder filled in with the indices of the points in curve order
+     */
+    template<unsigned DIM>
+    static void CalculateMortonOrder(const std::vector<c_vector<double, DIM> >& rLocations,
+                                     double cubeSize,
+                                     std::vector<unsigned>& rOrder)
+    {
+        unsigned num_points = rLocations.size();
+        rOrder.resize(num_points);
+        if (num_points == 0)
+        {
+            return;
+        }
+
+        c_vector<double, DIM> origin = rLocations[0];
+        for (unsigned i=1; i<num_points; i++)
+        {
+            for (unsigned d=0; d<DIM; d++)
+            {
+                origin[d] = std::min(origin[d], rLocations[i][d]);
+            }
+        }
+
+        std::vector<std::pair<boost::uint64_t, unsigned> > keys(num_points);
+        for (unsigned i=0; i<num_points; i++)
+        {
+            keys[i] = std::make_pair(CalculateMortonKey<DIM>(rLocations[i], origin, cubeSize), i);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        for (unsigned i=0; i<num_points; i++)
+        {
+            rOrder[i] = keys[i].second;
+        }
+    }
+};
+
+#endif /*SPACEFILLINGCURVE_HPP_*/
@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SurfaceMeshDistanceFunction.hpp"
+#include "Exception.hpp"
+#include "UblasCustomFunctions.hpp"
+#include <cfloat>
+#include <cmath>
+
+SurfaceMeshDistanceFunction::SurfaceMeshDistanceFunction(AbstractTetrahedralMesh<2,3>& rSurfaceMesh)
+{
+    for (AbstractTetrahedralMesh<2,3>::ElementIterator elem_iter = rSurfaceMesh.GetElementIteratorBegin();
+         elem_iter != rSurfaceMesh.GetElementIteratorEnd();
+         ++elem_iter)
+    {
+        for (unsigned i=0; i<3; i++)
+        {
+            mCorners.push_back(elem_iter->GetNode(i)->rGetLocation());
+        }
+    }
+    if (mCorners.empty())
+    {
+        EXCEPTION("The surface mesh has no triangles.");
+    }
+}
+
+unsigned SurfaceMeshDistanceFunction::GetNumTriangles() const
+{
+    return mCorners.size()/3;
+}
+
+c_vector<double, 3> SurfaceMeshDistanceFunction::GetClosestPointOnTriangle(const c_vector<double, 3>& rLocation,
+                                                                           const c_vector<double, 3>& rA,
+                                                                           const c_vector<double, 3>& rB,
+                                                                           const c_vector<double, 3>& rC) const
+{
+    // Find which Voronoi region of the triangle (corner, edge or face) the location projects into
+    c_vector<double, 3> ab = rB - rA;
+    c_vector<double, 3> ac = rC - rA;
+    c_vector<double, 3> ap = rLocation - rA;
+    double d1 = inner_prod(ab, ap);
+    double d2 = inner_prod(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0)
+    {
+        return rA;
+    }
+
+    c_vector<double, 3> bp = rLocation - rB;
+    double d3 = inner_prod(ab, bp);
+    double d4 = inner_prod(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3)
+    {
+        return rB;
+    }
+
+    double vc = d1*d4 - d3*d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+    {
+        return rA + (d1/(d1 - d3))*ab;
+    }
+
+    c_vector<double, 3> cp = rLocation - rC;
+    double d5 = inner_prod(ab, cp);
+    double d6 = inner_prod(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6)
+    {
+        return rC;
+    }
+
+    double vb = d5*d2 - d1*d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+    {
+        return rA + (d2/(d2 - d6))*ac;
+    }
+
+    double va = d3*d6 - d5*d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+    {
+        return rB + ((d4 - d3)/((d4 - d3) + (d5 - d6)))*(rC - rB);
+    }
+
+    double denominator = 1.0/(va + vb + vc);
+    return rA + (vb*denominator)*ab + (vc*denominator)*ac;
+}
+
+bool SurfaceMeshDistanceFunction::DoesRayCrossTriangle(const c_vector<double, 3>& rLocation,
+                                                       const c_vector<double, 3>& rDirection,
+                                                       const c_vector<double, 3>& rA,
+                                                       const c_vector<double, 3>& rB,
+                                                       const c_vector<double, 3>& rC) const
+{
+    // Moller-Trumbore intersection test
+    c_vector<double, 3> edge_1 = rB - rA;
+    c_vector<double, 3> edge_2 = rC - rA;
+    c_vector<double, 3> p = VectorProduct(rDirection, edge_2);
+    double determinant = inner_prod(edge_1, p);
+    if (fabs(determinant) < 1e-14)
+    {
+        return false;
+    }
+    double inverse_determinant = 1.0/determinant;
+    c_vector<double, 3> t = rLocation - rA;
+    double u = inner_prod(t, p)*inverse_determinant;
+    if (u < 0.0 || u > 1.0)
+    {
+        return false;
+    }
+    c_vector<double, 3> q = VectorProduct(t, edge_1);
+    double v = inner_prod(rDirection, q)*inverse_determinant;
+    if (v < 0.0 || u + v > 1.0)
+    {
+        return false;
+    }
+    return (inner_prod(edge_2, q)*inverse_determinant > 0.0);
+}
+
+double SurfaceMeshDistanceFunction::GetSignedDistance(const c_vector<double, 3>& rLocation) const
+{
+    // An irrational-looking direction, so the ray is unlikely to graze an edge or vertex of a regular mesh
+    c_vector<double, 3> direction;
+    direction[0] = 0.8017837;
+    direction[1] = 0.3396152;
+    direction[2] = 0.4918267;
+
+    double min_distance = DBL_MAX;
+    unsigned num_crossings = 0;
+    for (unsigned i=0; i<mCorners.size(); i+=3)
+    {
+        c_vector<double, 3> closest = GetClosestPointOnTriangle(rLocation, mCorners[i], mCorners[i+1], mCorners[i+2]);
+        min_distance = std::min(min_distance, norm_2(rLocation - closest));
+        if (DoesRayCrossTriangle(rLocation, direction, mCorners[i], mCorners[i+1], mCorners[i+2]))
+        {
+            num_crossings++;
+        }
+    }
+
+    // An odd number of crossings means the location is inside the closed surface
+    return (num_crossings%2 == 1) ? -min_distance : min_distance;
+}
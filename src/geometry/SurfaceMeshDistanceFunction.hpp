@@ -0,0 +1,108 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SURFACEMESHDISTANCEFUNCTION_HPP_
+#define SURFACEMESHDISTANCEFUNCTION_HPP_
+
+#include "AbstractSignedDistanceFunction.hpp"
+#include "AbstractTetrahedralMesh.hpp"
+#include <vector>
+
+/**
+ * The signed distance to a closed triangulated surface, such as a segmented gonad loaded with a
+ * TrianglesMeshReader<2,3>. The distance is to the closest triangle, and it is negative if the location is
+ * inside the surface, which is decided by counting the triangles a ray from the location crosses.
+ *
+ * Every query visits every triangle, so this is meant for sampling a SignedDistanceField once rather than for
+ * use every time step.
+ */
+class SurfaceMeshDistanceFunction : public AbstractSignedDistanceFunction<3>
+{
+private:
+
+    /** The corners of each triangle, three per triangle. */
+    std::vector<c_vector<double, 3> > mCorners;
+
+    /**
+     * @return the closest point on a triangle to a location.
+     *
+     * @param rLocation the location
+     * @param rA the first corner of the triangle
+     * @param rB the second corner
+     * @param rC the third corner
+     */
+    c_vector<double, 3> GetClosestPointOnTriangle(const c_vector<double, 3>& rLocation,
+                                                  const c_vector<double, 3>& rA,
+                                                  const c_vector<double, 3>& rB,
+                                                  const c_vector<double, 3>& rC) const;
+
+    /**
+     * @return whether a ray from a location crosses a triangle.
+     *
+     * @param rLocation the start of the ray
+     * @param rDirection the direction of the ray
+     * @param rA the first corner of the triangle
+     * @param rB the second corner
+     * @param rC the third corner
+     */
+    bool DoesRayCrossTriangle(const c_vector<double, 3>& rLocation,
+                              const c_vector<double, 3>& rDirection,
+                              const c_vector<double, 3>& rA,
+                              const c_vector<double, 3>& rB,
+                              const c_vector<double, 3>& rC) const;
+
+public:
+
+    /**
+     * Constructor. Copies the triangles of the surface.
+     *
+     * @param rSurfaceMesh a closed surface mesh
+     */
+    SurfaceMeshDistanceFunction(AbstractTetrahedralMesh<2,3>& rSurfaceMesh);
+
+    /** @return the number of triangles. */
+    unsigned GetNumTriangles() const;
+
+    /**
+     * Overridden GetSignedDistance() method.
+     *
+     * @return the signed distance from a location to the surface (negative inside).
+     *
+     * @param rLocation the location
+     */
+    double GetSignedDistance(const c_vector<double, 3>& rLocation) const;
+};
+
+#endif /*SURFACEMESHDISTANCEFUNCTION_HPP_*/
@@ -0,0 +1,281 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CellRegionQueryService.hpp"
+#include "SimulationTime.hpp"
+#include <algorithm>
+#include <cmath>
+
+template<unsigned DIM>
+CellRegionQueryService<DIM>::CellRegionQueryService(AbstractCellPopulation<DIM>* pCellPopulation, double binWidth)
+    : mpCellPopulation(pCellPopulation),
+      mBinWidth(binWidth),
+      mIsUpToDate(false),
+      mTimeStepsElapsedAtUpdate(0),
+      mNumCellsTested(0)
+{
+    assert(mpCellPopulation != NULL);
+    if (mBinWidth <= 0.0)
+    {
+        EXCEPTION("The bin width of a cell region query service must be positive.");
+    }
+}
+
+template<unsigned DIM>
+void CellRegionQueryService<DIM>::Invalidate()
+{
+    mIsUpToDate = false;
+}
+
+template<unsigned DIM>
+void CellRegionQueryService<DIM>::UpdateIfNeeded()
+{
+    unsigned time_steps_elapsed = SimulationTime::Instance()->GetTimeStepsElapsed();
+    if (mIsUpToDate && time_steps_elapsed == mTimeStepsElapsedAtUpdate)
+    {
+        return;
+    }
+
+    // Gather every cell and its centre, finding the extent of the population as we go
+    mCells.clear();
+    mLocations.clear();
+    c_vector<double, DIM> upper_corner;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        mLowerCorner[d] = DBL_MAX;
+        upper_corner[d] = -DBL_MAX;
+    }
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = mpCellPopulation->Begin();
+         cell_iter != mpCellPopulation->End();
+         ++cell_iter)
+    {
+        c_vector<double, DIM> location = mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
+        mCells.push_back(*cell_iter);
+        mLocations.push_back(location);
+        for (unsigned d=0; d<DIM; d++)
+        {
+            mLowerCorner[d] = std::min(mLowerCorner[d], location[d]);
+            upper_corner[d] = std::max(upper_corner[d], location[d]);
+        }
+    }
+
+    unsigned num_bins = 1;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        mNumBins[d] = mCells.empty() ? 1 : 1 + (unsigned)floor((upper_corner[d] - mLowerCorner[d])/mBinWidth);
+        num_bins *= mNumBins[d];
+    }
+
+    // Sort the cells into bins by counting
+    std::vector<unsigned> cell_bins(mCells.size());
+    mBinStarts.assign(num_bins + 1, 0);
+    for (unsigned i=0; i<mCells.size(); i++)
+    {
+        cell_bins[i] = GetBinIndex(mLocations[i]);
+        mBinStarts[cell_bins[i] + 1]++;
+    }
+    for (unsigned bin=0; bin<num_bins; bin++)
+    {
+        mBinStarts[bin + 1] += mBinStarts[bin];
+    }
+    mBinCells.resize(mCells.size());
+    std::vector<unsigned> next(mBinStarts.begin(), mBinStarts.end() - 1);
+    for (unsigned i=0; i<mCells.size(); i++)
+    {
+        mBinCells[next[cell_bins[i]]++] = i;
+    }
+
+    mIsUpToDate = true;
+    mTimeStepsElapsedAtUpdate = time_steps_elapsed;
+}
+
+template<unsigned DIM>
+unsigned CellRegionQueryService<DIM>::GetBinIndex(const c_vector<double, DIM>& rLocation) const
+{
+    unsigned bin_index = 0;
+    unsigned stride = 1;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        double position = floor((rLocation[d] - mLowerCorner[d])/mBinWidth);
+        unsigned bin = position < 0.0 ? 0 : std::min((unsigned)position, mNumBins[d] - 1);
+        bin_index += bin*stride;
+        stride *= mNumBins[d];
+    }
+    return bin_index;
+}
+
+template<unsigned DIM>
+void CellRegionQueryService<DIM>::CopyFoundCells(std::vector<CellPtr>& rCells)
+{
+    std::sort(mFound.begin(), mFound.end());
+    rCells.clear();
+    for (unsigned i=0; i<mFound.size(); i++)
+    {
+        rCells.push_back(mCells[mFound[i]]);
+    }
+}
+
+template<unsigned DIM>
+void CellRegionQueryService<DIM>::GetCellsInBox(const c_vector<double, DIM>& rLowerCorner,
+                                                const c_vector<double, DIM>& rUpperCorner,
+                                                std::vector<CellPtr>& rCells)
+{
+    UpdateIfNeeded();
+    mFound.clear();
+    mNumCellsTested = 0;
+
+    // The range of bins overlapping the box in each direction, and the number of bins in all
+    c_vector<unsigned, DIM> lower_bin;
+    c_vector<unsigned, DIM> upper_bin;
+    unsigned num_bins_in_box = 1;
+    for (unsigned d=0; d<DIM; d++)
+    {
+        if (rUpperCorner[d] < rLowerCorner[d] || mCells.empty())
+        {
+            rCells.clear();
+            return;
+        }
+        double lower = floor((rLowerCorner[d] - mLowerCorner[d])/mBinWidth);
+        double upper = floor((rUpperCorner[d] - mLowerCorner[d])/mBinWidth);
+        if (upper < 0.0 || lower > (double)(mNumBins[d] - 1))
+        {
+            rCells.clear();
+            return;
+        }
+        lower_bin[d] = lower < 0.0 ? 0 : (unsigned)lower;
+        upper_bin[d] = std::min((unsigned)upper, mNumBins[d] - 1);
+        num_bins_in_box *= upper_bin[d] - lower_bin[d] + 1;
+    }
+
+    // Visit each bin in the range, testing its cells against the box
+    for (unsigned i=0; i<num_bins_in_box; i++)
+    {
+        unsigned remainder = i;
+        unsigned bin_index = 0;
+        unsigned stride = 1;
+        for (unsigned d=0; d<DIM; d++)
+        {
+            unsigned extent = upper_bin[d] - lower_bin[d] + 1;
+            bin_index += (lower_bin[d] + remainder%extent)*stride;
+            remainder /= extent;
+            stride *= mNumBins[d];
+        }
+
+        for (unsigned j=mBinStarts[bin_index]; j<mBinStarts[bin_index + 1]; j++)
+        {
+            unsigned cell_index = mBinCells[j];
+            mNumCellsTested++;
+            const c_vector<double, DIM>& r_location = mLocations[cell_index];
+            bool is_inside = !mCells[cell_index]->IsDead();
+            for (unsigned d=0; d<DIM && is_inside; d++)
+            {
+                is_inside = (r_location[d] >= rLowerCorner[d]) && (r_location[d] <= rUpperCorner[d]);
+            }
+            if (is_inside)
+            {
+                mFound.push_back(cell_index);
+            }
+        }
+    }
+
+    CopyFoundCells(rCells);
+}
+
+template<unsigned DIM>
+void CellRegionQueryService<DIM>::GetCellsInHalfSpace(const c_vector<double, DIM>& rPointOnPlane,
+                                                      const c_vector<double, DIM>& rNormal,
+                                                      std::vector<CellPtr>& rCells)
+{
+    UpdateIfNeeded();
+    mFound.clear();
+    mNumCellsTested = 0;
+
+    unsigned num_bins = mBinStarts.size() - 1;
+    for (unsigned bin_index=0; bin_index<num_bins; bin_index++)
+    {
+        if (mBinStarts[bin_index] == mBinStarts[bin_index + 1])
+        {
+            continue;
+        }
+
+        // Skip the bin if even its corner furthest along the normal is not past the plane
+        unsigned remainder = bin_index;
+        double furthest = 0.0;
+        for (unsigned d=0; d<DIM; d++)
+        {
+            unsigned bin = remainder%mNumBins[d];
+            remainder /= mNumBins[d];
+            double lower = mLowerCorner[d] + bin*mBinWidth;
+            double corner = (rNormal[d] > 0.0) ? lower + mBinWidth : lower;
+            furthest += (corner - rPointOnPlane[d])*rNormal[d];
+        }
+        if (furthest <= 0.0)
+        {
+            continue;
+        }
+
+        for (unsigned j=mBinStarts[bin_index]; j<mBinStarts[bin_index + 1]; j++)
+        {
+            unsigned cell_index = mBinCells[j];
+            mNumCellsTested++;
+            if (!mCells[cell_index]->IsDead() && inner_prod(mLocations[cell_index] - rPointOnPlane, rNormal) > 0.0)
+            {
+                mFound.push_back(cell_index);
+            }
+        }
+    }
+
+    CopyFoundCells(rCells);
+}
+
+template<unsigned DIM>
+unsigned CellRegionQueryService<DIM>::GetNumCellsTested() const
+{
+    return mNumCellsTested;
+}
+
+template<unsigned DIM>
+double CellRegionQueryService<DIM>::GetBinWidth() const
+{
+    return mBinWidth;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class CellRegionQueryService<1>;
+template class CellRegionQueryService<2>;
+template class CellRegionQueryService<3>;
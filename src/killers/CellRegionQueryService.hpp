@@ -0,0 +1,160 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef CELLREGIONQUERYSERVICE_HPP_
+#define CELLREGIONQUERYSERVICE_HPP_
+
+#include "AbstractCellPopulation.hpp"
+#include <vector>
+
+/**
+ * A uniform grid of bins over the cell centres of a population, which cell killers (or anything else) can share
+ * to find the cells in a region without each visiting every cell.
+ *
+ * The grid is rebuilt, in one pass over the population, the first time it is queried in each timestep, so any
+ * number of killers querying it in a timestep cost one pass between them. A query only tests the cells in bins
+ * overlapping the region, and returns the cells it finds in the order the population iterates over them, so a
+ * killer drawing a random number for each cell draws them in the same order as if it had iterated over the
+ * population itself. Dead cells are left out.
+ */
+template<unsigned DIM>
+class CellRegionQueryService
+{
+private:
+
+    /** The cell population. */
+    AbstractCellPopulation<DIM>* mpCellPopulation;
+
+    /** The width of each bin. */
+    double mBinWidth;
+
+    /** Whether the grid has been built since it was last invalidated. */
+    bool mIsUpToDate;
+
+    /** The number of timesteps elapsed when the grid was built. */
+    unsigned mTimeStepsElapsedAtUpdate;
+
+    /** The lower corner of the grid. */
+    c_vector<double, DIM> mLowerCorner;
+
+    /** The number of bins in each direction. */
+    c_vector<unsigned, DIM> mNumBins;
+
+    /** Each cell, in the order the population iterates over them. */
+    std::vector<CellPtr> mCells;
+
+    /** The centre of each cell in mCells. */
+    std::vector<c_vector<double, DIM> > mLocations;
+
+    /** Where each bin's cells start in mBinCells; one more entry than there are bins. */
+    std::vector<unsigned> mBinStarts;
+
+    /** The indices in mCells of the cells in each bin, bin by bin. */
+    std::vector<unsigned> mBinCells;
+
+    /** Work space for queries: the indices in mCells of the cells found. */
+    std::vector<unsigned> mFound;
+
+    /** The number of cells tested by the last query. */
+    unsigned mNumCellsTested;
+
+    /**
+     * Rebuild the grid if it has not been built in this timestep.
+     */
+    void UpdateIfNeeded();
+
+    /**
+     * @return the index of the bin containing a location, clamped to the grid.
+     *
+     * @param rLocation the location
+     */
+    unsigned GetBinIndex(const c_vector<double, DIM>& rLocation) const;
+
+    /**
+     * Sort mFound into population order and copy the cells it refers to.
+     *
+     * @param rCells filled in with the cells found
+     */
+    void CopyFoundCells(std::vector<CellPtr>& rCells);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param pCellPopulation pointer to the cell population
+     * @param binWidth the width of each bin (defaults to 10)
+     */
+    CellRegionQueryService(AbstractCellPopulation<DIM>* pCellPopulation, double binWidth=10.0);
+
+    /**
+     * Force the grid to be rebuilt on the next query, for example after moving cells within a timestep.
+     */
+    void Invalidate();
+
+    /**
+     * Find the live cells whose centres lie in an axis-aligned box, boundary included.
+     *
+     * @param rLowerCorner the lower corner of the box
+     * @param rUpperCorner the upper corner of the box
+     * @param rCells filled in with the cells, in population order
+     */
+    void GetCellsInBox(const c_vector<double, DIM>& rLowerCorner,
+                       const c_vector<double, DIM>& rUpperCorner,
+                       std::vector<CellPtr>& rCells);
+
+    /**
+     * Find the live cells whose centres lie strictly on the side of a plane its normal points to.
+     *
+     * @param rPointOnPlane a point on the plane
+     * @param rNormal the normal to the plane, pointing into the half-space
+     * @param rCells filled in with the cells, in population order
+     */
+    void GetCellsInHalfSpace(const c_vector<double, DIM>& rPointOnPlane,
+                             const c_vector<double, DIM>& rNormal,
+                             std::vector<CellPtr>& rCells);
+
+    /**
+     * @return the number of cells tested by the last query.
+     */
+    unsigned GetNumCellsTested() const;
+
+    /**
+     * @return mBinWidth
+     */
+    double GetBinWidth() const;
+};
+
+#endif /*CELLREGIONQUERYSERVICE_HPP_*/
@@ -72,21 +72,32 @@ c_vector<double,DIM>  RandomCellKillerInCuboid<DIM>::GetBottomLeft() const{
 	return mbottom_left;
 }
 
+template<unsigned DIM>
+void RandomCellKillerInCuboid<DIM>::SetRegionQueryService(boost::shared_ptr<CellRegionQueryService<DIM> > pRegionQueryService)
+{
+    mpRegionQueryService = pRegionQueryService;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<CellRegionQueryService<DIM> > RandomCellKillerInCuboid<DIM>::GetRegionQueryService() const
+{
+    return mpRegionQueryService;
+}
+
 template<unsigned DIM>
 void RandomCellKillerInCuboid<DIM>::CheckAndLabelSingleCellForApoptosis(CellPtr pCell)
 {
     /*
-     * We assume a constant time step and that there are an integer number (n = 1/dt)
-     * of time steps per hour. We also assume that this method is called every time step
-     * and that the probabilities of dying at different times are independent.
-     *
-     * Let q=mProbabilityOfDeathInAnHour and p="probability of death in a given time step".
-     *
-     * Probability of not dying in an hour:
-     * (1-q) = (1-p)^n = (1-p)^(1/dt).
+     * We assume that this method is called every time step and that the probabilities of
+     * dying at different times are independent, so that the probability of surviving is
+     * multiplicative in time: surviving a time t has probability (1-q)^t, where
+     * q=mProbabilityOfDeathInAnHour.
      *
-     * Rearranging for p:
-     * p = 1 - (1-q)^dt.
+     * The probability of dying in a time step of length dt is therefore
+     * p = 1 - (1-q)^dt,
+     * using the current time step. This holds for any sequence of step lengths, so the
+     * hourly death rate is unchanged if the time step varies between steps or does not
+     * divide an hour exactly.
      */
     double death_prob_this_timestep = 1.0 - pow((1.0 - mProbabilityOfDeathInAnHour), SimulationTime::Instance()->GetTimeStep());
 
@@ -101,6 +112,18 @@ void RandomCellKillerInCuboid<DIM>::CheckAndLabelSingleCellForApoptosis(CellPtr
 template<unsigned DIM>
 void RandomCellKillerInCuboid<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+    if (mpRegionQueryService)
+    {
+        // The service returns the cells in population order, so random numbers are drawn as in the loop below
+        std::vector<CellPtr> cells;
+        mpRegionQueryService->GetCellsInBox(mbottom_left, mtop_right, cells);
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            CheckAndLabelSingleCellForApoptosis(cells[i]);
+        }
+        return;
+    }
+
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
          cell_iter != this->mpCellPopulation->End();
          ++cell_iter)
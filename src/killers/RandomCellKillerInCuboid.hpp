@@ -37,6 +37,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define RandomCellKillerInCuboid_HPP_
 
 #include "AbstractCellKiller.hpp"
+#include "CellRegionQueryService.hpp"
 #include "RandomNumberGenerator.hpp"
 
 #include "ChasteSerialization.hpp"
@@ -79,6 +80,12 @@ private:
      c_vector<double,DIM> mtop_right;
      c_vector<double,DIM> mbottom_left;
 
+    /**
+     * An optional service, possibly shared with other killers, used to visit only the cells in the cuboid.
+     * Not archived.
+     */
+    boost::shared_ptr<CellRegionQueryService<DIM> > mpRegionQueryService;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -118,6 +125,18 @@ public:
     c_vector<double,DIM>  GetTopRight() const;
     c_vector<double,DIM>  GetBottomLeft() const;
 
+    /**
+     * Set mpRegionQueryService, so that only the cells in the cuboid are visited.
+     *
+     * @param pRegionQueryService the service
+     */
+    void SetRegionQueryService(boost::shared_ptr<CellRegionQueryService<DIM> > pRegionQueryService);
+
+    /**
+     * @return mpRegionQueryService
+     */
+    boost::shared_ptr<CellRegionQueryService<DIM> > GetRegionQueryService() const;
+
     /**
      * Overridden method to test a given cell for apoptosis.
      *
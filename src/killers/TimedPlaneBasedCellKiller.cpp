@@ -75,18 +75,48 @@ double TimedPlaneBasedCellKiller<DIM>::rGetStart() const
 }
 
 
+template<unsigned DIM>
+void TimedPlaneBasedCellKiller<DIM>::SetRegionQueryService(boost::shared_ptr<CellRegionQueryService<DIM> > pRegionQueryService)
+{
+    mpRegionQueryService = pRegionQueryService;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<CellRegionQueryService<DIM> > TimedPlaneBasedCellKiller<DIM>::GetRegionQueryService() const
+{
+    return mpRegionQueryService;
+}
+
 template<unsigned DIM>
 void TimedPlaneBasedCellKiller<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+    double time = SimulationTime::Instance()->GetTime();
+    if (time < mStartTime)
+    {
+        return;
+    }
+
+    if (mpRegionQueryService)
+    {
+        std::vector<CellPtr> cells;
+        mpRegionQueryService->GetCellsInHalfSpace(mPointOnPlane, mNormalToPlane, cells);
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            OUTPUT<<time<<"	"<<cells[i]->GetCellId()<<std::endl;
+            cells[i]->Kill();
+        }
+        return;
+    }
+
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
          cell_iter != this->mpCellPopulation->End();
          ++cell_iter)
     {
         c_vector<double, DIM> cell_location = this->mpCellPopulation->GetLocationOfCellCentre(*cell_iter);
 
-        if (inner_prod(cell_location - mPointOnPlane, mNormalToPlane) > 0.0 && SimulationTime::Instance()->GetTime()>=mStartTime)
+        if (inner_prod(cell_location - mPointOnPlane, mNormalToPlane) > 0.0)
         {
-        	 OUTPUT<<SimulationTime::Instance()->GetTime()<<"	"<<(*cell_iter)->GetCellId()<<std::endl;
+        	 OUTPUT<<time<<"	"<<(*cell_iter)->GetCellId()<<std::endl;
             cell_iter->Kill();
         }
     }
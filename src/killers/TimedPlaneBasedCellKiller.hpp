@@ -37,6 +37,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define TimedPlaneBasedCellKiller_HPP_
 
 #include "AbstractCellKiller.hpp"
+#include "CellRegionQueryService.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -72,6 +73,12 @@ private:
      */
     double mStartTime;
 
+    /**
+     * An optional service, possibly shared with other killers, used to visit only the cells beyond the plane.
+     * Not archived.
+     */
+    boost::shared_ptr<CellRegionQueryService<DIM> > mpRegionQueryService;
+
     /** Needed for serialization. */
     friend class boost::serialization::access;
     /**
@@ -115,7 +122,19 @@ public:
     double rGetStart() const;
 
     /**
-     * Loops over cells and kills cells outside boundary.
+     * Set mpRegionQueryService, so that only the cells beyond the plane are visited.
+     *
+     * @param pRegionQueryService the service
+     */
+    void SetRegionQueryService(boost::shared_ptr<CellRegionQueryService<DIM> > pRegionQueryService);
+
+    /**
+     * @return mpRegionQueryService
+     */
+    boost::shared_ptr<CellRegionQueryService<DIM> > GetRegionQueryService() const;
+
+    /**
+     * Loops over cells and kills cells outside boundary. Does nothing before mStartTime.
      */
     void CheckAndLabelCellsForApoptosisOrDeath();
 
@@ -0,0 +1,299 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTADAPTIVETIMESTEPOFFLATTICESIMULATION_HPP_
+#define TESTADAPTIVETIMESTEPOFFLATTICESIMULATION_HPP_
+/*Checks the adaptive mechanics timestep, and the boundary conditions that undo moves within a substep.*/
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "FixedDurationGenerationBasedCellCycleModel.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "OffLatticeSimulation.hpp"
+#include "AdaptiveTimestepOffLatticeSimulation.hpp"
+#include "RepulsionForceMassCorrected.hpp"
+#include "CombinedStaticGonadBoundaryCondition.hpp"
+
+class TestAdaptiveTimestepOffLatticeSimulation : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*Relax a 3x3x3 block of cells of radius 1 on a lattice of spacing 1.6 until t=0.1, with the adaptive
+     *simulation or a plain one, and record where the nodes end up. Returns the number of mechanics steps taken.*/
+    unsigned RelaxCluster(bool useAdaptiveTimestep, double dt, double maxDisplacement, unsigned maxRefinementLevel,
+                          std::vector<c_vector<double,3> >& rFinalLocations, unsigned& rNumPairUpdates)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        std::vector<Node<3>*> nodes;
+        unsigned index=0;
+        for(unsigned i=0; i<3; i++){
+            for(unsigned j=0; j<3; j++){
+                for(unsigned k=0; k<3; k++){
+                    // A slight shear, so the cluster isn't symmetric
+                    nodes.push_back(new Node<3>(index, false, 1.6*i+0.1*j, 1.6*j+0.1*k, 1.6*k));
+                    index++;
+                }
+            }
+        }
+        NodesOnlyMesh<3> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 5.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, mesh.GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(mesh, cells);
+        cell_population.SetDampingConstantNormal(0.1);
+        cell_population.SetAbsoluteMovementThreshold(10);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            cell_iter->SetBirthTime(-10.0);
+            cell_iter->GetCellData()->SetItem("Radius",1.0);
+            cell_population.GetNode(cell_population.GetLocationIndexUsingCell(*cell_iter))->SetRadius(1.0);
+        }
+        cell_population.Update();
+
+        MAKE_PTR(RepulsionForceMassCorrected<3>, p_force);
+        p_force->SetMeinekeSpringStiffness(1.5);
+
+        unsigned num_steps;
+        if (useAdaptiveTimestep)
+        {
+            AdaptiveTimestepOffLatticeSimulation<3> simulator(cell_population);
+            simulator.SetOutputDirectory("TestAdaptiveTimestepCluster");
+            simulator.SetDt(dt);
+            simulator.SetEndTime(0.1);
+            simulator.SetMaxDisplacement(maxDisplacement);
+            simulator.SetMaxRefinementLevel(maxRefinementLevel);
+            simulator.AddForce(p_force);
+            simulator.Solve();
+            num_steps = simulator.GetNumSubsteps();
+            rNumPairUpdates = simulator.GetNumPairUpdates();
+        }
+        else
+        {
+            OffLatticeSimulation<3> simulator(cell_population);
+            simulator.SetOutputDirectory("TestAdaptiveTimestepClusterReference");
+            simulator.SetDt(dt);
+            simulator.SetEndTime(0.1);
+            simulator.AddForce(p_force);
+            simulator.Solve();
+            num_steps = SimulationTime::Instance()->GetTimeStepsElapsed();
+            rNumPairUpdates = num_steps;
+        }
+
+        rFinalLocations.resize(mesh.GetNumNodes());
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            rFinalLocations[node_iter->GetIndex()] = node_iter->rGetLocation();
+        }
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+        return num_steps;
+    }
+
+    /*The largest distance between corresponding locations.*/
+    double MaxDifference(std::vector<c_vector<double,3> >& rLocations, std::vector<c_vector<double,3> >& rOtherLocations)
+    {
+        TS_ASSERT_EQUALS(rLocations.size(), rOtherLocations.size());
+        double max_difference=0.0;
+        for (unsigned i=0; i<rLocations.size(); i++)
+        {
+            max_difference = std::max(max_difference, norm_2(rLocations[i]-rOtherLocations[i]));
+        }
+        return max_difference;
+    }
+
+public:
+
+void TestRefinedStepsMatchUniformlyFineSteps() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        // The reference: a plain simulation at dt/64 throughout
+        std::vector<c_vector<double,3> > reference_locations;
+        unsigned num_pair_updates;
+        unsigned num_reference_steps = RelaxCluster(false, 0.01/64, 0.0, 0, reference_locations, num_pair_updates);
+        TS_ASSERT_EQUALS(num_reference_steps, 640u);
+
+        // Forcing every substep down to dt/64 takes exactly the same steps. The cells never move far enough to
+        // leave the mesh's interaction distance, so the node pairs need not be updated part way through a step.
+        std::vector<c_vector<double,3> > forced_locations;
+        unsigned num_forced_steps = RelaxCluster(true, 0.01, 1e-12, 6, forced_locations, num_pair_updates);
+        TS_ASSERT_EQUALS(num_forced_steps, 640u);
+        TS_ASSERT_EQUALS(num_pair_updates, 0u);
+        TS_ASSERT_LESS_THAN(MaxDifference(forced_locations, reference_locations), 1e-10);
+
+        // Refining only as far as the forces need agrees closely, with far fewer steps
+        std::vector<c_vector<double,3> > adaptive_locations;
+        unsigned num_adaptive_steps = RelaxCluster(true, 0.01, 0.01, 6, adaptive_locations, num_pair_updates);
+        TS_ASSERT_LESS_THAN(num_adaptive_steps, num_reference_steps/2);
+        TS_ASSERT_EQUALS(num_pair_updates, 0u);
+        TS_ASSERT_LESS_THAN(MaxDifference(adaptive_locations, reference_locations), 0.01);
+
+        // The cluster did relax (its corners start 5.78 apart)
+        TS_ASSERT_LESS_THAN(5.9, norm_2(reference_locations[26]-reference_locations[0]));
+    }
+
+void TestCellThatDoesNotFitIsHeldAtTurnWithRefinedSubsteps() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        /* Two cells of radius 8 on the centreline of the proximal straight, heavily overlapping. A cell that big
+         * fits nowhere past the start of the turn (x=0), so the repulsion pushing the first cell towards the turn
+         * should leave it held just short of x=0, however finely the step is divided.*/
+        std::vector<Node<3>*> nodes;
+        nodes.push_back(new Node<3>(0, false, 1.0, -20.0, 0.0));
+        nodes.push_back(new Node<3>(1, false, 5.0, -20.0, 0.0));
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            // Old enough to have full rest lengths, too young to divide during the run
+            cell_iter->SetBirthTime(-2.0);
+            cell_iter->GetCellData()->SetItem("Radius",8.0);
+            cell_population.GetNode(cell_population.GetLocationIndexUsingCell(*cell_iter))->SetRadius(8.0);
+        }
+        cell_population.Update();
+
+        AdaptiveTimestepOffLatticeSimulation<3> simulator(cell_population);
+        simulator.SetOutputDirectory("TestAdaptiveTimestepBoundaryUndo");
+        simulator.SetDt(0.01);
+        simulator.SetEndTime(0.1);
+        simulator.SetMaxDisplacement(0.05);
+        simulator.SetMaxRefinementLevel(8);
+        MAKE_PTR(RepulsionForceMassCorrected<3>, p_force);
+        simulator.AddForce(p_force);
+        MAKE_PTR_ARGS(CombinedStaticGonadBoundaryCondition<3>, p_boundary_condition, (&cell_population, 176, 161, 20, 15));
+        simulator.AddCellPopulationBoundaryCondition(p_boundary_condition);
+
+        simulator.Solve();
+
+        // The overlap forced the step to be refined...
+        TS_ASSERT_LESS_THAN(0u, simulator.GetNumRefinedSubsteps());
+
+        // ...and each move past the turn was undone by exactly that substep's move, so the cell got within one
+        // substep's displacement of the turn without passing it. Undoing a whole dt's worth of movement instead
+        // would throw it back well behind where it started.
+        double x = p_mesh->GetNode(0)->rGetLocation()[0];
+        TS_ASSERT_LESS_THAN_EQUALS(0.0, x);
+        TS_ASSERT_LESS_THAN(x, 0.05 + 1e-6);
+        TS_ASSERT_DELTA(p_mesh->GetNode(0)->rGetLocation()[1], -20.0, 1e-6);
+
+        // The other cell was pushed away down the straight
+        TS_ASSERT_LESS_THAN(5.0, p_mesh->GetNode(1)->rGetLocation()[0]);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+        delete p_mesh;
+    }
+
+void TestCellThatDoesNotFitIsUndoneWithoutOldLocation() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 100);
+
+        // A cell of radius 8 that has just been pushed past the start of the turn (x=0), where it doesn't fit
+        std::vector<Node<3>*> nodes;
+        nodes.push_back(new Node<3>(0, false, -0.05, -20.0, 0.0));
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        Node<3>* p_node = p_mesh->GetNode(0);
+        p_node->SetRadius(8.0);
+        c_vector<double,3> force = zero_vector<double>(3);
+        force[0] = -10.0;
+        p_node->ClearAppliedForce();
+        p_node->AddAppliedForceContribution(force);
+
+        CombinedStaticGonadBoundaryCondition<3> boundary_condition(&cell_population, 176, 161, 20, 15);
+
+        // With the location before the move, the move is undone back to it
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        old_locations[p_node] = p_node->rGetLocation();
+        old_locations[p_node][0] = 0.02;
+        boundary_condition.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT_DELTA(p_node->rGetLocation()[0], 0.02, 1e-12);
+
+        // Without it, the move of a whole timestep under the cell's force (damping constant 1) is undone instead,
+        // rather than the cell being projected onto a tube it doesn't fit in
+        p_node->rGetModifiableLocation()[0] = -0.05;
+        old_locations.clear();
+        boundary_condition.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT_DELTA(p_node->rGetLocation()[0], -0.05 + 0.01*10.0, 1e-12);
+        TS_ASSERT_DELTA(p_node->rGetLocation()[1], -20.0, 1e-12);
+        TS_ASSERT_DELTA(p_node->rGetLocation()[2], 0.0, 1e-12);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTADAPTIVETIMESTEPOFFLATTICESIMULATION_HPP_*/
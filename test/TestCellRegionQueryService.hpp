@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTCELLREGIONQUERYSERVICE_HPP_
+#define TESTCELLREGIONQUERYSERVICE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "ElegansStochasticCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "CellRegionQueryService.hpp"
+#include "TimedPlaneBasedCellKiller.hpp"
+
+class TestCellRegionQueryService : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestQueriesAndTimedPlaneKiller() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 10);
+
+        // Scatter cells through a cube
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<500; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 40.0*p_gen->ranf(), 40.0*p_gen->ranf(), 40.0*p_gen->ranf()));
+        }
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        boost::shared_ptr<CellRegionQueryService<3> > p_service(new CellRegionQueryService<3>(&cell_population, 5.0));
+        TS_ASSERT_DELTA(p_service->GetBinWidth(), 5.0, 1e-12);
+
+        // A box query finds the same cells, in the same order, as testing every cell
+        c_vector<double, 3> lower = 10.0*unit_vector<double>(3, 0);
+        c_vector<double, 3> upper = scalar_vector<double>(3, 20.0);
+        std::vector<CellPtr> in_box;
+        p_service->GetCellsInBox(lower, upper, in_box);
+        std::vector<CellPtr> expected;
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            c_vector<double, 3> location = cell_population.GetLocationOfCellCentre(*cell_iter);
+            if (location[0] >= 10.0 && location[0] <= 20.0 && location[1] <= 20.0 && location[2] <= 20.0)
+            {
+                expected.push_back(*cell_iter);
+            }
+        }
+        TS_ASSERT_EQUALS(in_box.size(), expected.size());
+        for (unsigned i=0; i<expected.size() && i<in_box.size(); i++)
+        {
+            TS_ASSERT_EQUALS(in_box[i], expected[i]);
+        }
+        TS_ASSERT_LESS_THAN(p_service->GetNumCellsTested(), cell_population.GetNumRealCells());
+
+        // The same for a half-space
+        c_vector<double, 3> point = scalar_vector<double>(3, 30.0);
+        c_vector<double, 3> normal = unit_vector<double>(3, 2);
+        std::vector<CellPtr> beyond_plane;
+        p_service->GetCellsInHalfSpace(point, normal, beyond_plane);
+        unsigned num_beyond_plane = 0;
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            if (cell_population.GetLocationOfCellCentre(*cell_iter)[2] > 30.0)
+            {
+                num_beyond_plane++;
+            }
+        }
+        TS_ASSERT_EQUALS(beyond_plane.size(), num_beyond_plane);
+        TS_ASSERT_LESS_THAN(p_service->GetNumCellsTested(), cell_population.GetNumRealCells());
+
+        // A timed plane killer using the service does nothing before its start time...
+        TimedPlaneBasedCellKiller<3> killer(&cell_population, point, normal, 1.0);
+        killer.SetRegionQueryService(p_service);
+        TS_ASSERT(killer.GetRegionQueryService() == p_service);
+        killer.CheckAndLabelCellsForApoptosisOrDeath();
+        for (unsigned i=0; i<beyond_plane.size(); i++)
+        {
+            TS_ASSERT(!beyond_plane[i]->IsDead());
+        }
+
+        // ...and kills exactly the cells beyond the plane afterwards
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        killer.CheckAndLabelCellsForApoptosisOrDeath();
+        unsigned num_dead = 0;
+        for (std::list<CellPtr>::iterator cell_iter = cell_population.rGetCells().begin();
+             cell_iter != cell_population.rGetCells().end();
+             ++cell_iter)
+        {
+            if ((*cell_iter)->IsDead())
+            {
+                num_dead++;
+            }
+        }
+        TS_ASSERT_EQUALS(num_dead, num_beyond_plane);
+
+        // Dead cells are no longer found
+        p_service->GetCellsInHalfSpace(point, normal, beyond_plane);
+        TS_ASSERT_EQUALS(beyond_plane.size(), 0u);
+
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTCELLREGIONQUERYSERVICE_HPP_*/
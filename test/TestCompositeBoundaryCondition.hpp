@@ -0,0 +1,134 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTCOMPOSITEBOUNDARYCONDITION_HPP_
+#define TESTCOMPOSITEBOUNDARYCONDITION_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "ElegansStochasticCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "CompositeBoundaryCondition.hpp"
+
+/** The inside (or outside) of a sphere about the origin. */
+class SphereDistanceFunction : public AbstractSignedDistanceFunction<3>
+{
+    double mRadius;
+    bool mInside;
+public:
+    SphereDistanceFunction(double radius, bool inside)
+        : mRadius(radius),
+          mInside(inside)
+    {
+    }
+    double GetSignedDistance(const c_vector<double, 3>& rLocation) const
+    {
+        double distance = norm_2(rLocation) - mRadius;
+        return mInside ? distance : -distance;
+    }
+};
+
+class TestCompositeBoundaryCondition : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestCellsConfinedToShell() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        // Scatter cells through a cube, so that many lie outside the shell between radii 5 and 10
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<100; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 24.0*p_gen->ranf()-12.0, 24.0*p_gen->ranf()-12.0, 24.0*p_gen->ranf()-12.0));
+        }
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            p_mesh->GetNode(i)->SetRadius(1.0);
+        }
+
+        CompositeBoundaryCondition<3> boundary_condition(&cell_population);
+        boost::shared_ptr<AbstractSignedDistanceFunction<3> > p_outer(new SphereDistanceFunction(10.0, true));
+        boost::shared_ptr<AbstractSignedDistanceFunction<3> > p_inner(new SphereDistanceFunction(5.0, false));
+        boundary_condition.AddShape(p_outer);
+        boundary_condition.AddShape(p_inner);
+        boundary_condition.SetRecordTimings(true);
+        TS_ASSERT_EQUALS(boundary_condition.GetNumShapes(), 2u);
+
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        boundary_condition.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT(boundary_condition.VerifyBoundaryCondition());
+
+        // Every cell, with its radius, now lies in the shell
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            double r = norm_2(p_mesh->GetNode(i)->rGetLocation());
+            TS_ASSERT_LESS_THAN_EQUALS(r, 9.0 + 1e-4);
+            TS_ASSERT_LESS_THAN_EQUALS(6.0 - 1e-4, r);
+        }
+
+        // Both shapes were evaluated for every cell in the one pass, and each moved some cells
+        for (unsigned shape=0; shape<2; shape++)
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(100u, boundary_condition.GetNumEvaluations(shape));
+            TS_ASSERT_LESS_THAN(0u, boundary_condition.GetNumMoves(shape));
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, boundary_condition.GetEvaluationTime(shape));
+        }
+        boundary_condition.ResetCounters();
+        TS_ASSERT_EQUALS(boundary_condition.GetNumEvaluations(0), 0u);
+
+        // Tidy up
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTCOMPOSITEBOUNDARYCONDITION_HPP_*/
@@ -0,0 +1,229 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTEGGLAYINGFORCE_HPP_
+#define TESTEGGLAYINGFORCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "FixedDurationGenerationBasedCellCycleModel.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "EggLayingForce.hpp"
+
+#include <cfloat>
+
+class TestEggLayingForce : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*Zero the applied force on every node.*/
+    template<unsigned DIM>
+    void ClearForces(NodesOnlyMesh<DIM>& rMesh)
+    {
+        for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rMesh.GetNodeIteratorBegin();
+             node_iter != rMesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            node_iter->ClearAppliedForce();
+        }
+    }
+
+public:
+
+    void TestForceIn2d() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, false, -1.0, -1.0));
+        nodes.push_back(new Node<2>(1, false,  1.0, -1.0));
+        nodes.push_back(new Node<2>(2, false,  1.0,  1.0));
+        nodes.push_back(new Node<2>(3, false,  2.0, -3.0));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 10.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, mesh.GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        // By default the force is 5 along x for x>0, y<0, sized to the dimension
+        EggLayingForce<2> force;
+        TS_ASSERT_EQUALS(force.rGetForce().size(), 2u);
+        TS_ASSERT_DELTA(force.rGetForce()[0], 5.0, 1e-12);
+        TS_ASSERT_DELTA(force.rGetForce()[1], 0.0, 1e-12);
+
+        ClearForces(mesh);
+        force.AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(force.GetNumNodesInRegion(), 2u);
+        double expected_x[4] = {0.0, 5.0, 0.0, 5.0};
+        for (unsigned i=0; i<4; i++)
+        {
+            TS_ASSERT_DELTA(mesh.GetNode(i)->rGetAppliedForce()[0], expected_x[i], 1e-12);
+            TS_ASSERT_DELTA(mesh.GetNode(i)->rGetAppliedForce()[1], 0.0, 1e-12);
+        }
+
+        // Nodes entering and leaving the region are picked up on the next call
+        c_vector<double,2> new_force;
+        new_force[0] = 0.0;
+        new_force[1] = -2.0;
+        force.SetForce(new_force);
+        mesh.GetNode(0)->rGetModifiableLocation()[0] = 0.5;
+        mesh.GetNode(1)->rGetModifiableLocation()[1] = 1.0;
+
+        ClearForces(mesh);
+        force.AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(force.GetNumNodesInRegion(), 2u);
+        double expected_y[4] = {-2.0, 0.0, 0.0, -2.0};
+        for (unsigned i=0; i<4; i++)
+        {
+            TS_ASSERT_DELTA(mesh.GetNode(i)->rGetAppliedForce()[0], 0.0, 1e-12);
+            TS_ASSERT_DELTA(mesh.GetNode(i)->rGetAppliedForce()[1], expected_y[i], 1e-12);
+        }
+
+        // A removed node no longer receives the force
+        cell_population.GetCellUsingLocationIndex(3)->Kill();
+        cell_population.RemoveDeadCells();
+        cell_population.Update();
+
+        ClearForces(mesh);
+        force.AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(force.GetNumNodesInRegion(), 1u);
+        TS_ASSERT_DELTA(mesh.GetNode(0)->rGetAppliedForce()[1], -2.0, 1e-12);
+
+        // Changing the region applies to every node straight away
+        c_vector<double,2> lower_corner = scalar_vector<double>(2, -5.0);
+        c_vector<double,2> upper_corner = scalar_vector<double>(2, 5.0);
+        force.SetRegion(lower_corner, upper_corner);
+        TS_ASSERT_DELTA(force.rGetRegionLowerCorner()[1], -5.0, 1e-12);
+        TS_ASSERT_DELTA(force.rGetRegionUpperCorner()[1], 5.0, 1e-12);
+
+        ClearForces(mesh);
+        force.AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(force.GetNumNodesInRegion(), 3u);
+        for (AbstractMesh<2,2>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[1], -2.0, 1e-12);
+        }
+
+        // Bad settings
+        upper_corner[0] = -5.0;
+        TS_ASSERT_THROWS_THIS(force.SetRegion(lower_corner, upper_corner),
+                              "The lower corner of the egg laying region must be below the upper corner in every direction.");
+        new_force[0] = 2.0*DBL_MAX;
+        TS_ASSERT_THROWS_THIS(force.SetForce(new_force), "The egg laying force must be finite.");
+    }
+
+    void TestForceIn1d() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        std::vector<Node<1>*> nodes;
+        nodes.push_back(new Node<1>(0, false, -1.0));
+        nodes.push_back(new Node<1>(1, false, 1.0));
+        nodes.push_back(new Node<1>(2, false, 2.0));
+        NodesOnlyMesh<1> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 10.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 1> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, mesh.GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<1> cell_population(mesh, cells);
+
+        // In 1D the default region is just x>0
+        EggLayingForce<1> force;
+        TS_ASSERT_EQUALS(force.rGetForce().size(), 1u);
+
+        ClearForces(mesh);
+        force.AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(force.GetNumNodesInRegion(), 2u);
+        TS_ASSERT_DELTA(mesh.GetNode(0)->rGetAppliedForce()[0], 0.0, 1e-12);
+        TS_ASSERT_DELTA(mesh.GetNode(1)->rGetAppliedForce()[0], 5.0, 1e-12);
+        TS_ASSERT_DELTA(mesh.GetNode(2)->rGetAppliedForce()[0], 5.0, 1e-12);
+    }
+
+    void TestArchiving() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        OutputFileHandler handler("TestEggLayingForce", false);
+        std::string archive_filename = handler.GetOutputDirectoryFullPath() + "EggLayingForce.arch";
+
+        {
+            EggLayingForce<3> force;
+            c_vector<double,3> new_force = zero_vector<double>(3);
+            new_force[2] = 1.5;
+            force.SetForce(new_force);
+            c_vector<double,3> lower_corner = scalar_vector<double>(3, -DBL_MAX);
+            c_vector<double,3> upper_corner = scalar_vector<double>(3, DBL_MAX);
+            lower_corner[0] = 10.0;
+            upper_corner[0] = 20.0;
+            force.SetRegion(lower_corner, upper_corner);
+
+            std::ofstream ofs(archive_filename.c_str());
+            boost::archive::text_oarchive output_arch(ofs);
+            AbstractForce<3>* const p_force = &force;
+            output_arch << p_force;
+        }
+
+        {
+            AbstractForce<3>* p_force;
+            std::ifstream ifs(archive_filename.c_str(), std::ios::binary);
+            boost::archive::text_iarchive input_arch(ifs);
+            input_arch >> p_force;
+
+            EggLayingForce<3>* p_egg_laying_force = dynamic_cast<EggLayingForce<3>*>(p_force);
+            TS_ASSERT(p_egg_laying_force != NULL);
+            TS_ASSERT_DELTA(p_egg_laying_force->rGetForce()[0], 0.0, 1e-12);
+            TS_ASSERT_DELTA(p_egg_laying_force->rGetForce()[2], 1.5, 1e-12);
+            TS_ASSERT_DELTA(p_egg_laying_force->rGetRegionLowerCorner()[0], 10.0, 1e-12);
+            TS_ASSERT_DELTA(p_egg_laying_force->rGetRegionUpperCorner()[0], 20.0, 1e-12);
+            TS_ASSERT_EQUALS(p_egg_laying_force->rGetRegionUpperCorner()[1], DBL_MAX);
+
+            delete p_force;
+        }
+    }
+};
+
+#endif /*TESTEGGLAYINGFORCE_HPP_*/
@@ -80,13 +80,18 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "BuskeCompressionForce.hpp"
 #include "BuskeAdhesiveForce.hpp"
 #include "BuskeElasticForce.hpp"
+#include "CompositePairwiseForce.hpp"
 #include "NodeBasedCellPopulationWithBuskeUpdate.hpp"
 
 //Repulsion force law header. This version has drag scale linearly with cell radius
 #include "RepulsionForceMassCorrected.hpp"
+//Spatial index bucketing cells by arc length along the gonad arm, used by the repulsion force to find neighbours
+#include "GonadArmSpatialIndex.hpp"
 
 //A modifier outputting the positions of all cells on an hourly basis 
 #include "GonadArmPositionTrackerModifier.hpp"
+#include "GonadArmGeometryModifier.hpp"
+#include "SpatialReorderingModifier.hpp"
 
 
 class TestElegansAdult : public AbstractCellBasedTestSuite
@@ -167,6 +172,8 @@ void TestGonadArmAdult() throw(Exception)
 				cell_iter->GetCellData()->SetItem("Proliferating",1.0);
 				cell_iter->GetCellData()->SetItem("Radius",2.95);
 				cell_iter->GetCellData()->SetItem("MaxRadius",2.95);
+                //Cell fate changes over hours: update each statechart every 10 timesteps (0.04h)
+                dynamic_cast<StatechartCellCycleModelSerializable*>(cell_iter->GetCellCycleModel())->SetStatechartUpdateInterval(10);
                 
                 if(useGLP1ActivityVariable==true){
                     cell_iter->GetCellData()->SetItem("GLP1Activity",0.0);
@@ -199,14 +206,22 @@ void TestGonadArmAdult() throw(Exception)
         if(isBuske==false){
             MAKE_PTR(RepulsionForceMassCorrected<3>, p_force1);
             p_force1->SetMeinekeSpringStiffness(1.5);
+            p_force1->SetVerletSkin(2.0);
+            //Find the force's neighbour pairs by arc length along the arm rather than from the mesh's box collection
+            GonadArmCentreline<3> centreline(LengthOfStraightLower,LengthOfStraightUpper,RadiusOfTurn);
+            MAKE_PTR_ARGS(GonadArmSpatialIndex<3>, p_spatial_index, (centreline, 10.0));
+            p_force1->SetSpatialIndex(p_spatial_index);
             simulator.AddForce(p_force1);
         }else{
             MAKE_PTR(BuskeCompressionForce<3>, p_force1);
             MAKE_PTR(BuskeAdhesiveForce<3>, p_force2);
             MAKE_PTR(BuskeElasticForce<3>, p_force3);
             simulator.AddForce(p_force1);
-            simulator.AddForce(p_force2);
-            simulator.AddForce(p_force3);
+            //The adhesive and elastic laws share one pass over the node pairs
+            MAKE_PTR(CompositePairwiseForce<3>, p_pairwise_force);
+            p_pairwise_force->AddForceLaw(p_force2);
+            p_pairwise_force->AddForceLaw(p_force3);
+            simulator.AddForce(p_pairwise_force);
         }
 
 
@@ -214,6 +229,12 @@ void TestGonadArmAdult() throw(Exception)
         MAKE_PTR_ARGS(CombinedStaticGonadBoundaryCondition<3>, p_boundary_condition, (cell_population,LengthOfStraightLower,LengthOfStraightUpper,RadiusOfTurn,RadiusOfTube,1e-5));
         simulator.AddCellPopulationBoundaryCondition(p_boundary_condition);
 
+        //record each cell's position along the arm every 10 timesteps, for the statechart and the output modifier
+        MAKE_PTR(GonadArmGeometryModifier<3>, p_geometry_modifier);
+        p_geometry_modifier->SetBoundaryCondition(p_boundary_condition);
+        p_geometry_modifier->SetUpdateInterval(10);
+        simulator.AddSimulationModifier(p_geometry_modifier);
+
 
         //7) ADD TWO CELL KILLERS
         //Stochastic in loop, narrows the field by apoptosis as the eggs grow
@@ -242,6 +263,10 @@ void TestGonadArmAdult() throw(Exception)
         MAKE_PTR(GonadArmPositionTrackerModifier<3>, mod1);
         simulator.AddSimulationModifier(mod1);
 
+        //keep the cell list in spatial order as the arm fills up
+        MAKE_PTR(SpatialReorderingModifier<3>, p_reordering_modifier);
+        simulator.AddSimulationModifier(p_reordering_modifier);
+
 
         /*8) RUN AND SAVE*/
         simulator.Solve();
@@ -56,6 +56,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "BuskeAdhesiveForce.hpp"
 #include "BuskeCompressionForce.hpp"
 #include "BuskeElasticForce.hpp"
+#include "CompositePairwiseForce.hpp"
+#include "RandomNumberGenerator.hpp"
 
 class TestForceLaws : public AbstractCellBasedTestSuite
 {
@@ -150,6 +152,71 @@ void TestBuske() throw(Exception)
         delete p_mesh;
 
     };
+
+void TestCompositePairwiseForceMatchesSeparateLaws() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        // A random clump of cells, so that some pairs are in contact and some only adhere
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<40; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 15.0*p_gen->ranf(), 15.0*p_gen->ranf(), 15.0*p_gen->ranf()));
+        }
+        NodesOnlyMesh<3> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 10.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, mesh.GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(mesh, cells);
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            node_iter->SetRadius(2.0 + p_gen->ranf());
+        }
+        cell_population.Update();
+
+        MAKE_PTR(BuskeAdhesiveForce<3>, p_force_adh);
+        MAKE_PTR(BuskeElasticForce<3>, p_force_el);
+        p_force_el->SetCutOffLength(6.0);
+
+        // Reference: each law adding its own contribution
+        p_force_adh->AddForceContribution(cell_population);
+        p_force_el->AddForceContribution(cell_population);
+        std::vector<c_vector<double,3> > expected_forces;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            expected_forces.push_back(node_iter->rGetAppliedForce());
+            node_iter->ClearAppliedForce();
+        }
+
+        CompositePairwiseForce<3> composite_force;
+        composite_force.AddForceLaw(p_force_adh);
+        composite_force.AddForceLaw(p_force_el);
+        TS_ASSERT_EQUALS(composite_force.rGetForceLaws().size(), 2u);
+        composite_force.AddForceContribution(cell_population);
+
+        unsigned i = 0;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter, ++i)
+        {
+            for (unsigned d=0; d<3; d++)
+            {
+                TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[d], expected_forces[i][d], 1e-10);
+            }
+        }
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    };
 };
 
 #endif
@@ -0,0 +1,201 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTGONADARMCENTRELINE_HPP_
+#define TESTGONADARMCENTRELINE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "GonadArmCentreline.hpp"
+
+#include <algorithm>
+
+class TestGonadArmCentreline : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*
+     * Check Project() and ProjectOntoPiece() at a location against the closest of many points sampled densely
+     * along the part of the centreline grown so far.
+     */
+    void CheckAgainstDenseSampling(const GonadArmCentreline<3>& rCentreline, const c_vector<double,3>& rLocation, double maxArcLength)
+    {
+        double sampled_distance = DBL_MAX;
+        unsigned num_samples = 20000;
+        for (unsigned k=0; k<=num_samples; k++)
+        {
+            c_vector<double,3> point = rCentreline.GetPointAtArcLength(maxArcLength*k/num_samples);
+            sampled_distance = std::min(sampled_distance, norm_2(rLocation - point));
+        }
+
+        c_vector<double,3> closest_point;
+        double arc_length;
+        double distance = rCentreline.Project(rLocation, closest_point, arc_length, maxArcLength);
+
+        // Never further than any sampled point, and no nearer than the sampling allows
+        TS_ASSERT_LESS_THAN_EQUALS(distance, sampled_distance + 1e-9);
+        TS_ASSERT_LESS_THAN(sampled_distance - distance, 0.01);
+
+        // The closest point is the centreline point at the arc length returned, on the part grown so far
+        TS_ASSERT_LESS_THAN_EQUALS(0.0, arc_length);
+        TS_ASSERT_LESS_THAN_EQUALS(arc_length, maxArcLength + 1e-9);
+        c_vector<double,3> point_at_arc_length = rCentreline.GetPointAtArcLength(arc_length);
+        for (unsigned d=0; d<3; d++)
+        {
+            TS_ASSERT_DELTA(closest_point[d], point_at_arc_length[d], 1e-9);
+        }
+        TS_ASSERT_DELTA(norm_2(rLocation - closest_point), distance, 1e-9);
+
+        // Each piece gives a distance no smaller, and the piece containing the closest point gives the same one
+        for (unsigned piece=0; piece<3; piece++)
+        {
+            c_vector<double,3> piece_point;
+            double piece_arc_length;
+            double piece_distance = rCentreline.ProjectOntoPiece(rLocation, piece, piece_point, piece_arc_length, maxArcLength);
+            TS_ASSERT_LESS_THAN_EQUALS(distance, piece_distance + 1e-9);
+            TS_ASSERT_LESS_THAN_EQUALS(piece_arc_length, maxArcLength + 1e-9);
+            if (piece == rCentreline.GetPieceIndex(arc_length))
+            {
+                TS_ASSERT_DELTA(piece_distance, distance, 1e-9);
+            }
+        }
+    }
+
+public:
+
+    void TestProjectionMatchesDenseSampling() throw(Exception)
+    {
+        GonadArmCentreline<3> centreline(176, 161, 20);
+        TS_ASSERT_DELTA(centreline.GetTotalLength(), 176 + M_PI*20 + 161, 1e-12);
+
+        // Partly grown straight, the whole straight, partly grown turn, nearly all the turn, the whole turn,
+        // partly grown distal straight and the full arm
+        double turn_length = M_PI*20;
+        double lengths[7] = {100.0, 176.0, 176.0 + 0.3*turn_length, 176.0 + 0.7*turn_length, 176.0 + turn_length,
+                             176.0 + turn_length + 50.0, centreline.GetTotalLength()};
+
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        for (unsigned i=0; i<7; i++)
+        {
+            double max_arc_length = lengths[i];
+
+            // Special locations: on the turn's axis, at the centre of each straight's tube, and past each end
+            // of the arm and of the part grown so far
+            std::vector<c_vector<double,3> > locations;
+            c_vector<double,3> location = zero_vector<double>(3);
+            locations.push_back(location);
+            location[2] = 5.0;
+            locations.push_back(location);
+            location[0] = 80.0;
+            location[1] = -20.0;
+            locations.push_back(location);
+            location[0] = 190.0;
+            locations.push_back(location);
+            location[1] = 20.0;
+            locations.push_back(location);
+            location[0] = 175.0;
+            locations.push_back(location);
+            location[0] = -30.0;
+            location[1] = 0.0;
+            locations.push_back(location);
+            c_vector<double,3> tip = centreline.GetPointAtArcLength(max_arc_length);
+            location = tip;
+            location[0] += 3.0;
+            locations.push_back(location);
+            location = tip;
+            location[1] -= 3.0;
+            locations.push_back(location);
+
+            // Random locations around the whole arm, some on the x or y axis
+            for (unsigned j=0; j<300; j++)
+            {
+                location[0] = -60.0 + 260.0*p_gen->ranf();
+                location[1] = -60.0 + 120.0*p_gen->ranf();
+                location[2] = -10.0 + 20.0*p_gen->ranf();
+                if (j%5 == 0)
+                {
+                    location[1] = 0.0;
+                }
+                if (j%7 == 0)
+                {
+                    location[0] = 0.0;
+                }
+                locations.push_back(location);
+            }
+
+            for (unsigned j=0; j<locations.size(); j++)
+            {
+                CheckAgainstDenseSampling(centreline, locations[j], max_arc_length);
+            }
+        }
+    }
+
+    void TestProjectAllMatchesProject() throw(Exception)
+    {
+        GonadArmCentreline<2> centreline(176, 161, 20);
+
+        std::vector<c_vector<double,2> > locations;
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        for (unsigned j=0; j<100; j++)
+        {
+            c_vector<double,2> location;
+            location[0] = -60.0 + 260.0*p_gen->ranf();
+            location[1] = -60.0 + 120.0*p_gen->ranf();
+            locations.push_back(location);
+        }
+
+        double max_arc_length = 176.0 + 10.0;
+        std::vector<c_vector<double,2> > closest_points;
+        std::vector<double> arc_lengths;
+        std::vector<double> distances;
+        centreline.ProjectAll(locations, closest_points, arc_lengths, distances, max_arc_length);
+        TS_ASSERT_EQUALS(distances.size(), locations.size());
+
+        for (unsigned j=0; j<locations.size(); j++)
+        {
+            c_vector<double,2> closest_point;
+            double arc_length;
+            double distance = centreline.Project(locations[j], closest_point, arc_length, max_arc_length);
+            TS_ASSERT_DELTA(distances[j], distance, 1e-12);
+            TS_ASSERT_DELTA(arc_lengths[j], arc_length, 1e-12);
+            TS_ASSERT_DELTA(closest_points[j][0], closest_point[0], 1e-12);
+            TS_ASSERT_DELTA(closest_points[j][1], closest_point[1], 1e-12);
+        }
+    }
+};
+
+#endif /*TESTGONADARMCENTRELINE_HPP_*/
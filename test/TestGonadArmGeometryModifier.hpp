@@ -0,0 +1,299 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTGONADARMGEOMETRYMODIFIER_HPP_
+#define TESTGONADARMGEOMETRYMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "StatechartCellCycleModelSerializable.hpp"
+
+#include "CombinedStaticGonadBoundaryCondition.hpp"
+#include "GonadArmMovingBoundaryCondition.hpp"
+#include "GonadArmGeometryModifier.hpp"
+
+class TestGonadArmGeometryModifier : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*
+     * Make a population of statechart cells along the centre of the proximal straight of the arm, at
+     * x=20, 40, ..., 160, where a cell's arc length along the centreline is 176-x.
+     */
+    NodesOnlyMesh<3>* MakeMesh()
+    {
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<8; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 20.0*(i+1), -20.0, 0.0));
+        }
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            p_mesh->GetNode(i)->SetRadius(2.5);
+        }
+        return p_mesh;
+    }
+
+    void MoveCells(NodesOnlyMesh<3>* pMesh, double dx)
+    {
+        for (unsigned i=0; i<pMesh->GetNumNodes(); i++)
+        {
+            pMesh->GetNode(i)->rGetModifiableLocation()[0] += dx;
+        }
+    }
+
+public:
+
+    void TestBoundaryConditionRecordsGeometryWithoutModifier() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        NodesOnlyMesh<3>* p_mesh = MakeMesh();
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<StatechartCellCycleModelSerializable, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        MAKE_PTR_ARGS(CombinedStaticGonadBoundaryCondition<3>, p_boundary_condition, (&cell_population, 176, 161, 20, 10));
+        TS_ASSERT(!p_boundary_condition->IsRecordedByModifier());
+        double tip_arc_length = p_boundary_condition->GetDistalTipArcLength();
+
+        // With no modifier, each impose records the cells' current positions in cell data, which the statecharts read
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        for (unsigned step=0; step<3; step++)
+        {
+            p_boundary_condition->ImposeBoundaryCondition(old_locations);
+            for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+                 cell_iter != cell_population.End();
+                 ++cell_iter)
+            {
+                double x = cell_population.GetLocationOfCellCentre(*cell_iter)[0];
+                double expected_distance = tip_arc_length - (176.0 - x);
+                TS_ASSERT_DELTA((*cell_iter)->GetCellData()->GetItem("DistanceAwayFromDTC"), expected_distance, 1e-9);
+                TS_ASSERT_DELTA((*cell_iter)->GetCellData()->GetItem("MaxRadius"), 10.0, 1e-9);
+
+                StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>((*cell_iter)->GetCellCycleModel());
+                TS_ASSERT_DELTA(p_model->GetDistanceAwayFromDTC(), expected_distance, 1e-9);
+                TS_ASSERT_DELTA(p_model->GetMaxRadius(), 10.0, 1e-9);
+            }
+            MoveCells(p_mesh, 3.0);
+        }
+
+        // Once a modifier is registered, the boundary condition leaves cell data alone
+        GonadArmGeometryModifier<3> modifier;
+        modifier.SetBoundaryCondition(p_boundary_condition);
+        TS_ASSERT(p_boundary_condition->IsRecordedByModifier());
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            (*cell_iter)->GetCellData()->SetItem("DistanceAwayFromDTC", -1.0);
+        }
+        p_boundary_condition->ImposeBoundaryCondition(old_locations);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            TS_ASSERT_DELTA((*cell_iter)->GetCellData()->GetItem("DistanceAwayFromDTC"), -1.0, 1e-12);
+        }
+
+        // The flag is not archived, so the modifier registers again when set up
+        p_boundary_condition->SetRecordedByModifier(false);
+        modifier.SetupSolve(cell_population, "TestGonadArmGeometryModifier");
+        TS_ASSERT(p_boundary_condition->IsRecordedByModifier());
+
+        // The modifier's values match the centreline projection and are passed to the cell cycle models
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            unsigned node_index = cell_population.GetLocationIndexUsingCell(*cell_iter);
+            double x = cell_population.GetLocationOfCellCentre(*cell_iter)[0];
+            double expected_distance = tip_arc_length - (176.0 - x);
+            TS_ASSERT_DELTA(modifier.GetArcLength(node_index), 176.0 - x, 1e-9);
+            TS_ASSERT_DELTA(modifier.GetDistanceAwayFromDTC(node_index), expected_distance, 1e-9);
+            TS_ASSERT_DELTA(modifier.GetMaxRadius(node_index), 10.0, 1e-9);
+
+            StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>((*cell_iter)->GetCellCycleModel());
+            TS_ASSERT_DELTA(p_model->GetDistanceAwayFromDTC(), expected_distance, 1e-9);
+
+            // Cell data is only written if asked for
+            TS_ASSERT_DELTA((*cell_iter)->GetCellData()->GetItem("DistanceAwayFromDTC"), -1.0, 1e-12);
+        }
+
+        modifier.SetWriteCellData(true);
+        TS_ASSERT(modifier.GetWriteCellData());
+        modifier.UpdateGeometry(cell_population);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            unsigned node_index = cell_population.GetLocationIndexUsingCell(*cell_iter);
+            TS_ASSERT_DELTA((*cell_iter)->GetCellData()->GetItem("DistanceAwayFromDTC"), modifier.GetDistanceAwayFromDTC(node_index), 1e-12);
+            TS_ASSERT_DELTA((*cell_iter)->GetCellData()->GetItem("MaxRadius"), modifier.GetMaxRadius(node_index), 1e-12);
+        }
+
+        // Tidy up
+        delete p_mesh;
+    }
+
+    void TestMovingBoundaryConditionRecordsGeometryWithoutModifier() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        NodesOnlyMesh<3>* p_mesh = MakeMesh();
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<StatechartCellCycleModelSerializable, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        // The arm has only grown as far as arc length 170, just short of the end of the proximal straight
+        GonadArmMovingBoundaryCondition<3> boundary_condition(&cell_population, 170.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+        TS_ASSERT_DELTA(boundary_condition.GetDistalTipArcLength(), 170.0, 1e-12);
+
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        boundary_condition.ImposeBoundaryCondition(old_locations);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            double x = cell_population.GetLocationOfCellCentre(*cell_iter)[0];
+            StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>((*cell_iter)->GetCellCycleModel());
+            TS_ASSERT_DELTA(p_model->GetDistanceAwayFromDTC(), 170.0 - (176.0 - x), 1e-9);
+        }
+
+        // Tidy up
+        delete p_mesh;
+    }
+
+    void TestUpdateInterval() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        NodesOnlyMesh<3>* p_mesh = MakeMesh();
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<StatechartCellCycleModelSerializable, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        MAKE_PTR_ARGS(CombinedStaticGonadBoundaryCondition<3>, p_boundary_condition, (&cell_population, 176, 161, 20, 10));
+        GonadArmGeometryModifier<3> modifier;
+        modifier.SetBoundaryCondition(p_boundary_condition);
+
+        TS_ASSERT_EQUALS(modifier.GetUpdateInterval(), 1u);
+        TS_ASSERT_THROWS_THIS(modifier.SetUpdateInterval(0), "The update interval must be at least one timestep");
+        modifier.SetUpdateInterval(3);
+        TS_ASSERT_EQUALS(modifier.GetUpdateInterval(), 3u);
+
+        modifier.SetupSolve(cell_population, "TestGonadArmGeometryModifier");
+        double recorded_x = p_mesh->GetNode(0)->rGetLocation()[0];
+        TS_ASSERT_DELTA(modifier.GetArcLength(0), 176.0 - recorded_x, 1e-9);
+
+        // The values only change every third timestep, however far the cells have moved in between
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(9.0, 9);
+        for (unsigned step=1; step<=9; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            MoveCells(p_mesh, 1.0);
+            modifier.UpdateAtEndOfTimeStep(cell_population);
+            if (step%3 == 0)
+            {
+                recorded_x = p_mesh->GetNode(0)->rGetLocation()[0];
+            }
+            TS_ASSERT_DELTA(modifier.GetArcLength(0), 176.0 - recorded_x, 1e-9);
+
+            StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>(cell_population.GetCellUsingLocationIndex(0)->GetCellCycleModel());
+            TS_ASSERT_DELTA(p_model->GetDistanceAwayFromDTC(), modifier.GetDistanceAwayFromDTC(0), 1e-12);
+        }
+
+        // Tidy up
+        delete p_mesh;
+    }
+
+    void TestDaughtersInheritParentGeometry() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        NodesOnlyMesh<3>* p_mesh = MakeMesh();
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<StatechartCellCycleModelSerializable, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        MAKE_PTR_ARGS(CombinedStaticGonadBoundaryCondition<3>, p_boundary_condition, (&cell_population, 176, 161, 20, 10));
+        GonadArmGeometryModifier<3> modifier;
+        modifier.SetBoundaryCondition(p_boundary_condition);
+        modifier.UpdateGeometry(cell_population);
+
+        // A cell in the last unit of the proximal straight can only grow to fit beside the syncytium
+        p_mesh->GetNode(7)->rGetModifiableLocation()[0] = 0.5;
+        modifier.UpdateGeometry(cell_population);
+        TS_ASSERT_LESS_THAN(modifier.GetMaxRadius(7), 10.0);
+
+        for (unsigned index=0; index<8; index+=7)
+        {
+            StatechartCellCycleModelSerializable* p_parent_model = static_cast<StatechartCellCycleModelSerializable*>(cell_population.GetCellUsingLocationIndex(index)->GetCellCycleModel());
+            StatechartCellCycleModelSerializable* p_daughter_model = static_cast<StatechartCellCycleModelSerializable*>(p_parent_model->CreateCellCycleModel());
+
+            // The daughter has no cell data of its own yet, so these come from the parent's model
+            TS_ASSERT_DELTA(p_daughter_model->GetDistanceAwayFromDTC(), modifier.GetDistanceAwayFromDTC(index), 1e-12);
+            TS_ASSERT_DELTA(p_daughter_model->GetMaxRadius(), modifier.GetMaxRadius(index), 1e-12);
+            TS_ASSERT_EQUALS(p_daughter_model->GetStatechartUpdateInterval(), p_parent_model->GetStatechartUpdateInterval());
+
+            delete p_daughter_model;
+        }
+
+        // Tidy up
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTGONADARMGEOMETRYMODIFIER_HPP_*/
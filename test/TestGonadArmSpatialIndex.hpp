@@ -0,0 +1,123 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTGONADARMSPATIALINDEX_HPP_
+#define TESTGONADARMSPATIALINDEX_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "GonadArmSpatialIndex.hpp"
+
+#include <algorithm>
+
+class TestGonadArmSpatialIndex : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPairsMatchAllPairsSearch() throw(Exception)
+    {
+        GonadArmCentreline<3> centreline(176, 161, 20);
+
+        /* Scatter points through a tube of radius 12 about the whole centreline, so the population spans the turn
+         * and the inside of the turn, where the two straights' tubes meet. A few strays lie well outside the tube,
+         * between the straights and beyond each end.*/
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<c_vector<double,3> > locations;
+        for (unsigned i=0; i<3000; i++)
+        {
+            double arc_length = centreline.GetTotalLength()*p_gen->ranf();
+            c_vector<double,3> location = centreline.GetPointAtArcLength(arc_length);
+            double r = 12.0*sqrt(p_gen->ranf());
+            double theta = 2.0*M_PI*p_gen->ranf();
+            location[1] += r*cos(theta);
+            location[2] += r*sin(theta);
+            locations.push_back(location);
+        }
+        for (unsigned i=0; i<100; i++)
+        {
+            c_vector<double,3> location;
+            location[0] = -40.0 + 240.0*p_gen->ranf();
+            location[1] = -40.0 + 80.0*p_gen->ranf();
+            location[2] = -20.0 + 40.0*p_gen->ranf();
+            locations.push_back(location);
+        }
+
+        // All pairs, for reference
+        double interaction_distance = 4.0;
+        std::vector<std::pair<unsigned, unsigned> > expected_pairs;
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            for (unsigned j=i+1; j<locations.size(); j++)
+            {
+                if (norm_2(locations[i] - locations[j]) < interaction_distance)
+                {
+                    expected_pairs.push_back(std::pair<unsigned, unsigned>(i, j));
+                }
+            }
+        }
+        TS_ASSERT_LESS_THAN(1000u, expected_pairs.size());
+
+        // Buckets shorter than, about equal to and much longer than the interaction distance, and one bucket for the whole arm
+        double bucket_lengths[4] = {1.0, 4.0, 25.0, 1000.0};
+        for (unsigned k=0; k<4; k++)
+        {
+            GonadArmSpatialIndex<3> index(centreline, bucket_lengths[k]);
+            TS_ASSERT_DELTA(index.GetBucketLength(), bucket_lengths[k], 1e-12);
+            TS_ASSERT_LESS_THAN_EQUALS(centreline.GetTotalLength(), index.GetNumBuckets()*bucket_lengths[k]);
+
+            std::vector<std::pair<unsigned, unsigned> > pairs;
+            index.CalculatePairs(locations, interaction_distance, pairs);
+            for (unsigned i=0; i<pairs.size(); i++)
+            {
+                TS_ASSERT_LESS_THAN(pairs[i].first, pairs[i].second);
+            }
+
+            // The same set of pairs, each found once
+            std::sort(pairs.begin(), pairs.end());
+            TS_ASSERT_EQUALS(pairs.size(), expected_pairs.size());
+            TS_ASSERT(pairs == expected_pairs);
+
+            // Calculating again with the same work space gives the same pairs
+            std::vector<std::pair<unsigned, unsigned> > repeated_pairs;
+            index.CalculatePairs(locations, interaction_distance, repeated_pairs);
+            std::sort(repeated_pairs.begin(), repeated_pairs.end());
+            TS_ASSERT(repeated_pairs == expected_pairs);
+        }
+    }
+};
+
+#endif /*TESTGONADARMSPATIALINDEX_HPP_*/
@@ -45,7 +45,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "CellsGenerator.hpp"
 #include "TransitCellProliferativeType.hpp"
 #include "HoneycombMeshGenerator.hpp"
-#include "OffLatticeSimulation.hpp"
+#include "AdaptiveTimestepOffLatticeSimulation.hpp"
 #include "SmartPointers.hpp"
 #include "NodesOnlyMesh.hpp"
 #include "NodeBasedCellPopulation.hpp"
@@ -125,10 +125,14 @@ void TestGonadArmGrowing() throw(Exception)
 
 
 		//SET SIMULATION PROPERTIES, ADD REPULSION FORCE
-        OffLatticeSimulation<3> simulator(cell_population);
+        //Cells, killers and the growing boundary step every 1/20 h; the mechanics refine this step
+        //(down to 1/5120 h) only while forces would move some node more than 0.05 in one substep.
+        AdaptiveTimestepOffLatticeSimulation<3> simulator(cell_population);
         simulator.SetOutputDirectory("GonadArmGrowing");
-        simulator.SetSamplingTimestepMultiple(12);
-        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(1);
+        simulator.SetDt(1.0/20.0);
+        simulator.SetMaxDisplacement(0.05);
+        simulator.SetMaxRefinementLevel(8);
         simulator.SetEndTime(20);
         MAKE_PTR(RepulsionForceMassCorrected<3>, p_force);
         simulator.AddForce(p_force);
@@ -156,6 +160,15 @@ void TestGonadArmGrowing() throw(Exception)
         /* RUN */
         simulator.Solve();
 
+        // Every one of the 400 cell-level steps takes at least one substep, and at most 2^8, and only the last
+        // substep of a step can be unrefined once the step has been refined
+        unsigned num_substeps = simulator.GetNumSubsteps();
+        unsigned num_refined_substeps = simulator.GetNumRefinedSubsteps();
+        TS_ASSERT_LESS_THAN_EQUALS(400u, num_substeps);
+        TS_ASSERT_LESS_THAN_EQUALS(num_substeps, 400u*256u);
+        TS_ASSERT_LESS_THAN_EQUALS(num_refined_substeps, num_substeps);
+        TS_ASSERT_LESS_THAN_EQUALS(num_substeps - num_refined_substeps, 400u);
+
 
         /* GARBAGE COLLECTION*/
         for (unsigned i=0; i<nodes.size(); i++)
@@ -0,0 +1,231 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTGROWTHSCHEDULE_HPP_
+#define TESTGROWTHSCHEDULE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "ElegansStochasticCellCycleModel.hpp"
+#include "OutputFileHandler.hpp"
+#include <fstream>
+
+#include "GrowthSchedule.hpp"
+#include "GonadArmMovingBoundaryCondition.hpp"
+#include "EllipsoidMovingBoundaryCondition.hpp"
+#include "EllipsoidOutsideMovingBoundaryCondition.hpp"
+#include "MovingBoundaryModifier.hpp"
+
+class TestGrowthSchedule : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPiecewiseLinearSchedule() throw(Exception)
+    {
+        std::vector<double> times;
+        std::vector<double> values;
+        times.push_back(1.0);
+        values.push_back(2.0);
+        times.push_back(3.0);
+        values.push_back(6.0);
+        times.push_back(4.0);
+        values.push_back(5.0);
+        GrowthSchedule schedule(times, values);
+
+        // Constant before the first knot and after the last, linear in between
+        TS_ASSERT_DELTA(schedule.GetValue(0.0), 2.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetValue(2.0), 4.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetValue(3.5), 5.5, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetValue(10.0), 5.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetFinalTime(), 4.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetMaxValue(), 6.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetMinValue(), 2.0, 1e-12);
+
+        // A linear schedule stops exactly at its final value
+        schedule.SetLinear(0.5, 10.0, 2.0, 15.0);
+        TS_ASSERT_DELTA(schedule.GetValue(1.5), 12.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetValue(3.0), 15.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetValue(100.0), 15.0, 1e-12);
+        TS_ASSERT_DELTA(schedule.GetFinalTime(), 3.0, 1e-12);
+
+        // ...or carries on for ever without one
+        schedule.SetLinear(0.0, 1.0, 0.5);
+        TS_ASSERT_DELTA(schedule.GetValue(100.0), 51.0, 1e-12);
+        TS_ASSERT_EQUALS(schedule.GetFinalTime(), DBL_MAX);
+
+        TS_ASSERT_THROWS_THIS(schedule.SetLinear(0.0, 1.0, -0.5, 2.0),
+                              "A linear growth schedule must grow towards its final value.");
+        times[2] = 2.0;
+        TS_ASSERT_THROWS_THIS(GrowthSchedule(times, values), "The times of a growth schedule must be increasing.");
+
+        // Read a schedule from file
+        OutputFileHandler handler("TestGrowthSchedule");
+        std::string file_name = handler.GetOutputDirectoryFullPath() + "schedule.dat";
+        {
+            std::ofstream file(file_name.c_str());
+            file << "# time value\n0.0 1.0\n\n2.0 3.0\n";
+        }
+        schedule.LoadFromFile(file_name);
+        TS_ASSERT_EQUALS(schedule.rGetTimes().size(), 2u);
+        TS_ASSERT_DELTA(schedule.GetValue(1.0), 2.0, 1e-12);
+    }
+
+    void TestGonadArmFollowsScheduleExactly() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        std::vector<Node<3>*> nodes;
+        nodes.push_back(new Node<3>(0, false, 170.0, -20.0, 0.0));
+        nodes.push_back(new Node<3>(1, false, 160.0, -20.0, 1.0));
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        GonadArmMovingBoundaryCondition<3> boundary_condition(&cell_population, 10.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+
+        // Take many small steps; the length is exact rather than accumulated step by step
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 3000);
+        for (unsigned step=0; step<3000; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            boundary_condition.UpdateBoundaryCondition();
+        }
+        TS_ASSERT_DELTA(boundary_condition.GetCurrentLength(), 17.0, 1e-12);
+        TS_ASSERT_DELTA(boundary_condition.GetCurrentTubeRadius(), 6.0, 1e-12);
+        TS_ASSERT_EQUALS(boundary_condition.IsFrozen(), false);
+
+        // Replace the radius schedule by one that has already finished
+        GrowthSchedule radius_schedule;
+        radius_schedule.SetLinear(0.0, 7.0, 0.0);
+        boundary_condition.SetRadiusSchedule(radius_schedule);
+        TS_ASSERT_DELTA(boundary_condition.GetCurrentTubeRadius(), 7.0, 1e-12);
+        TS_ASSERT_DELTA(boundary_condition.GetFinalTubeRadius(), 7.0, 1e-12);
+
+        // Tidy up
+        delete p_mesh;
+    }
+
+    void TestModifierSkipsUpdatesOnceBoundariesStopGrowing() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        std::vector<Node<3>*> nodes;
+        nodes.push_back(new Node<3>(0, false, 170.0, -20.0, 0.0));
+        nodes.push_back(new Node<3>(1, false, 160.0, -20.0, 1.0));
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 10);
+
+        // The arm reaches its final radius of 8 at time 3 and its final length of 176+161+20*pi at time 4.83
+        boost::shared_ptr<GonadArmMovingBoundaryCondition<3> > p_arm(
+            new GonadArmMovingBoundaryCondition<3>(&cell_population, 395.0, 176, 161, 20, 5, 8, 1.0, 1.0));
+        MovingBoundaryModifier<3> arm_modifier;
+        arm_modifier.SpecifyMovingBoundary(p_arm);
+
+        // The inside ellipsoid stops growing at time 3 and the outside one at time 6
+        c_vector<double,3> centre = zero_vector<double>(3);
+        std::vector<double> times;
+        std::vector<double> values;
+        times.push_back(0.0);
+        values.push_back(10.0);
+        times.push_back(3.0);
+        values.push_back(11.0);
+        boost::shared_ptr<EllipsoidMovingBoundaryCondition<3> > p_inside(
+            new EllipsoidMovingBoundaryCondition<3>(&cell_population, centre, 20.0, 20.0, 10.0));
+        p_inside->SetCSchedule(GrowthSchedule(times, values));
+        times[1] = 6.0;
+        boost::shared_ptr<EllipsoidOutsideMovingBoundaryCondition<3> > p_outside(
+            new EllipsoidOutsideMovingBoundaryCondition<3>(&cell_population, centre, 2.0, 2.0, 10.0));
+        p_outside->SetCSchedule(GrowthSchedule(times, values));
+        MovingBoundaryModifier<3> ellipsoid_modifier;
+        ellipsoid_modifier.SpecifyMovingBoundary(p_inside);
+        ellipsoid_modifier.SpecifyMovingBoundary(p_outside);
+
+        // An ellipsoid with the default schedule grows for ever, so keeps the population being updated
+        boost::shared_ptr<EllipsoidMovingBoundaryCondition<3> > p_growing(
+            new EllipsoidMovingBoundaryCondition<3>(&cell_population, centre, 20.0, 20.0, 10.0));
+        MovingBoundaryModifier<3> growing_modifier;
+        growing_modifier.SpecifyMovingBoundary(p_arm);
+        growing_modifier.SpecifyMovingBoundary(p_growing);
+
+        for (unsigned step=1; step<=10; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            arm_modifier.UpdateAtEndOfTimeStep(cell_population);
+            ellipsoid_modifier.UpdateAtEndOfTimeStep(cell_population);
+            growing_modifier.UpdateAtEndOfTimeStep(cell_population);
+
+            TS_ASSERT_EQUALS(p_arm->IsFrozen(), step >= 5);
+            TS_ASSERT_EQUALS(p_inside->IsFrozen(), step >= 3);
+            TS_ASSERT_EQUALS(p_outside->IsFrozen(), step >= 6);
+            TS_ASSERT_EQUALS(p_growing->IsFrozen(), false);
+
+            // No update is skipped while any boundary of a modifier is still growing, and every one is after
+            TS_ASSERT_EQUALS(arm_modifier.GetNumPopulationUpdatesSkipped(), (step >= 5) ? step-4 : 0u);
+            TS_ASSERT_EQUALS(ellipsoid_modifier.GetNumPopulationUpdatesSkipped(), (step >= 6) ? step-5 : 0u);
+            TS_ASSERT_EQUALS(growing_modifier.GetNumPopulationUpdatesSkipped(), 0u);
+        }
+
+        // The frozen boundaries kept their final shapes
+        TS_ASSERT_DELTA(p_arm->GetCurrentLength(), p_arm->GetFinalLength(), 1e-12);
+        TS_ASSERT_DELTA(p_arm->GetCurrentTubeRadius(), 8.0, 1e-12);
+        TS_ASSERT_DELTA(p_inside->rGetC(), 11.0, 1e-12);
+        TS_ASSERT_DELTA(p_outside->rGetC(), 11.0, 1e-12);
+
+        // Tidy up
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTGROWTHSCHEDULE_HPP_*/
@@ -0,0 +1,330 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTIMPOSEDBOUNDARYCONDITIONRECORD_HPP_
+#define TESTIMPOSEDBOUNDARYCONDITIONRECORD_HPP_
+/*Checks that boundary conditions verifying from the record kept while imposing reach the same verdict as a
+ *full check of every cell: when another boundary condition moves nodes after imposing, for each of the gonad
+ *arm, combined static and ellipsoid conditions, and when a cell is added between imposing and verifying.*/
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FixedDurationGenerationBasedCellCycleModel.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "ElegansStochasticCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "ImposedBoundaryConditionRecord.hpp"
+#include "GonadArmMovingBoundaryCondition.hpp"
+#include "CombinedStaticGonadBoundaryCondition.hpp"
+#include "EllipsoidMovingBoundaryCondition.hpp"
+#include "EllipsoidOutsideMovingBoundaryCondition.hpp"
+#include "GonadArmCentreline.hpp"
+
+class TestImposedBoundaryConditionRecord : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*A population of cells of radius 1 at the given locations. The caller deletes the population, then the mesh.*/
+    NodeBasedCellPopulation<3>* MakePopulation(const std::vector<c_vector<double,3> >& rLocations, NodesOnlyMesh<3>*& rpMesh)
+    {
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<rLocations.size(); i++)
+        {
+            nodes.push_back(new Node<3>(i, rLocations[i]));
+        }
+        rpMesh = new NodesOnlyMesh<3>;
+        rpMesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, rpMesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3>* p_population = new NodeBasedCellPopulation<3>(*rpMesh, cells);
+        for (unsigned i=0; i<rpMesh->GetNumNodes(); i++)
+        {
+            rpMesh->GetNode(i)->SetRadius(1.0);
+        }
+        return p_population;
+    }
+
+    /*Random locations within a distance maxOffset of the gonad arm centreline, between the given arc lengths.*/
+    std::vector<c_vector<double,3> > LocationsAlongArm(double minArcLength, double maxArcLength, double maxOffset)
+    {
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        GonadArmCentreline<3> centreline(176, 161, 20);
+        std::vector<c_vector<double,3> > locations;
+        for (unsigned i=0; i<200; i++)
+        {
+            double arc_length = minArcLength + (maxArcLength-minArcLength)*p_gen->ranf();
+            c_vector<double,3> tangent = centreline.GetPointAtArcLength(arc_length+0.01) - centreline.GetPointAtArcLength(arc_length-0.01);
+            tangent /= norm_2(tangent);
+            c_vector<double,3> normal = zero_vector<double>(3);
+            normal[0] = -tangent[1];
+            normal[1] = tangent[0];
+            c_vector<double,3> binormal = zero_vector<double>(3);
+            binormal[2] = 1.0;
+
+            double r = maxOffset*sqrt(p_gen->ranf());
+            double theta = 2.0*M_PI*p_gen->ranf();
+            locations.push_back(centreline.GetPointAtArcLength(arc_length) + r*cos(theta)*normal + r*sin(theta)*binormal);
+        }
+        return locations;
+    }
+
+    /*Random locations in a cube of the given half-width about the origin.*/
+    std::vector<c_vector<double,3> > LocationsInCube(double halfWidth)
+    {
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<c_vector<double,3> > locations;
+        for (unsigned i=0; i<200; i++)
+        {
+            c_vector<double,3> location;
+            for (unsigned d=0; d<3; d++)
+            {
+                location[d] = halfWidth*(2.0*p_gen->ranf() - 1.0);
+            }
+            locations.push_back(location);
+        }
+        return locations;
+    }
+
+    /*
+     * Repeatedly jiggle the cells as the forces would, impose the condition, then move a few nodes as another
+     * boundary condition would, and check that verifying from the record and verifying every cell agree. Counts
+     * how often the condition was found satisfied and not.
+     */
+    template<class BOUNDARY_CONDITION>
+    void CheckRecordAgreesWithFullVerification(BOUNDARY_CONDITION& rCondition, NodesOnlyMesh<3>& rMesh,
+                                               unsigned& rNumSatisfied, unsigned& rNumNotSatisfied)
+    {
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        TS_ASSERT_EQUALS(rCondition.GetVerifyFromImposedRecord(), true);
+
+        for (unsigned trial=0; trial<50; trial++)
+        {
+            std::map<Node<3>*, c_vector<double,3> > old_locations;
+            for (unsigned i=0; i<rMesh.GetNumNodes(); i++)
+            {
+                Node<3>* p_node = rMesh.GetNode(i);
+                old_locations[p_node] = p_node->rGetLocation();
+                for (unsigned d=0; d<3; d++)
+                {
+                    p_node->rGetModifiableLocation()[d] += 0.6*p_gen->ranf() - 0.3;
+                }
+            }
+            rCondition.ImposeBoundaryCondition(old_locations);
+
+            unsigned num_moved = trial%3;
+            for (unsigned k=0; k<num_moved; k++)
+            {
+                Node<3>* p_node = rMesh.GetNode(p_gen->randMod(rMesh.GetNumNodes()));
+                for (unsigned d=0; d<3; d++)
+                {
+                    p_node->rGetModifiableLocation()[d] += 2.0*p_gen->ranf() - 1.0;
+                }
+            }
+
+            bool satisfied_from_record = rCondition.VerifyBoundaryCondition();
+            rCondition.SetVerifyFromImposedRecord(false);
+            bool satisfied = rCondition.VerifyBoundaryCondition();
+            rCondition.SetVerifyFromImposedRecord(true);
+
+            TS_ASSERT_EQUALS(satisfied_from_record, satisfied);
+            if (num_moved == 0)
+            {
+                TS_ASSERT_EQUALS(satisfied, true);
+            }
+            if (satisfied)
+            {
+                rNumSatisfied++;
+            }
+            else
+            {
+                rNumNotSatisfied++;
+            }
+        }
+    }
+
+public:
+
+    void TestRecord() throw(Exception)
+    {
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<3; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 1.0*i, 0.0, 0.0));
+        }
+
+        ImposedBoundaryConditionRecord<3> record;
+        TS_ASSERT_EQUALS(record.IsValid(0), false);
+        record.Clear();
+        TS_ASSERT_EQUALS(record.IsValid(0), true);
+
+        record.Record(nodes[0], false, true);
+        record.Record(nodes[1], false, false);
+        record.Record(nodes[2], true, false);
+        TS_ASSERT_EQUALS(record.GetNumRecords(), 3u);
+        TS_ASSERT_EQUALS(record.IsValid(3), true);
+        TS_ASSERT_EQUALS(record.IsValid(4), false);
+        TS_ASSERT_EQUALS(record.GetNode(1), nodes[1]);
+
+        // Nodes left where they were recorded keep their result; a moved node's new position must be checked
+        TS_ASSERT_EQUALS(record.NeedsChecking(0), false);
+        TS_ASSERT_EQUALS(record.WasSatisfied(0), true);
+        TS_ASSERT_EQUALS(record.NeedsChecking(1), false);
+        TS_ASSERT_EQUALS(record.WasSatisfied(1), false);
+        TS_ASSERT_EQUALS(record.NeedsChecking(2), true);
+
+        // However little another boundary condition moves a node, it is checked again
+        nodes[0]->rGetModifiableLocation()[1] += 1e-12;
+        TS_ASSERT_EQUALS(record.NeedsChecking(0), true);
+
+        record.Invalidate();
+        TS_ASSERT_EQUALS(record.IsValid(3), false);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestRecordAgreesWithFullVerification() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 10);
+        unsigned num_satisfied = 0;
+        unsigned num_not_satisfied = 0;
+
+        // Cells around both ends of the turn of a gonad arm of radius 5
+        {
+            NodesOnlyMesh<3>* p_mesh;
+            NodeBasedCellPopulation<3>* p_population = MakePopulation(LocationsAlongArm(150.0, 260.0, 5.5), p_mesh);
+            GonadArmMovingBoundaryCondition<3> condition(p_population, 300.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+            CheckRecordAgreesWithFullVerification(condition, *p_mesh, num_satisfied, num_not_satisfied);
+            delete p_population;
+            delete p_mesh;
+        }
+
+        // Cells either side of where the syncytium starts in the combined static arm of radius 10
+        {
+            NodesOnlyMesh<3>* p_mesh;
+            NodeBasedCellPopulation<3>* p_population = MakePopulation(LocationsAlongArm(120.0, 300.0, 10.5), p_mesh);
+            CombinedStaticGonadBoundaryCondition<3> condition(p_population, 176, 161, 20, 10);
+            CheckRecordAgreesWithFullVerification(condition, *p_mesh, num_satisfied, num_not_satisfied);
+            delete p_population;
+            delete p_mesh;
+        }
+
+        // Cells inside an ellipsoid, and outside another
+        c_vector<double,3> centre = zero_vector<double>(3);
+        {
+            NodesOnlyMesh<3>* p_mesh;
+            NodeBasedCellPopulation<3>* p_population = MakePopulation(LocationsInCube(12.0), p_mesh);
+            EllipsoidMovingBoundaryCondition<3> condition(p_population, centre, 12.0, 10.0, 8.0);
+            CheckRecordAgreesWithFullVerification(condition, *p_mesh, num_satisfied, num_not_satisfied);
+            delete p_population;
+            delete p_mesh;
+        }
+        {
+            NodesOnlyMesh<3>* p_mesh;
+            NodeBasedCellPopulation<3>* p_population = MakePopulation(LocationsInCube(8.0), p_mesh);
+            EllipsoidOutsideMovingBoundaryCondition<3> condition(p_population, centre, 4.0, 5.0, 6.0);
+            CheckRecordAgreesWithFullVerification(condition, *p_mesh, num_satisfied, num_not_satisfied);
+            delete p_population;
+            delete p_mesh;
+        }
+
+        // Both verdicts were reached, so the comparison means something
+        TS_ASSERT_LESS_THAN(50u, num_satisfied);
+        TS_ASSERT_LESS_THAN(20u, num_not_satisfied);
+    }
+
+    void TestAddedCellFallsBackToFullVerification() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 10);
+        NodesOnlyMesh<3>* p_mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(LocationsInCube(12.0), p_mesh);
+        c_vector<double,3> centre = zero_vector<double>(3);
+        EllipsoidMovingBoundaryCondition<3> ellipsoid(p_population, centre, 12.0, 10.0, 8.0);
+        GonadArmMovingBoundaryCondition<3> arm(p_population, 300.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+
+        // A cell added outside the ellipsoid after imposing has no record, so must be found by the full check
+        ellipsoid.ImposeBoundaryCondition(old_locations);
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellPtr p_new_cell(new Cell(p_state, new FixedDurationGenerationBasedCellCycleModel()));
+        p_new_cell->SetCellProliferativeType(p_transit_type);
+        c_vector<double,3> outside = zero_vector<double>(3);
+        outside[0] = 20.0;
+        p_population->AddCell(p_new_cell, outside, *(p_population->Begin()));
+        TS_ASSERT_EQUALS(p_population->GetNumRealCells(), 201u);
+        TS_ASSERT_EQUALS(ellipsoid.VerifyBoundaryCondition(), false);
+
+        // Imposing again covers the new cell, and moves it inside
+        ellipsoid.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT_EQUALS(ellipsoid.VerifyBoundaryCondition(), true);
+
+        // Likewise for a cell added outside the gonad arm, once the arm has confined every other cell
+        arm.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT_EQUALS(arm.VerifyBoundaryCondition(), true);
+        arm.ImposeBoundaryCondition(old_locations);
+        CellPtr p_other_cell(new Cell(p_state, new FixedDurationGenerationBasedCellCycleModel()));
+        p_other_cell->SetCellProliferativeType(p_transit_type);
+        p_population->AddCell(p_other_cell, outside, *(p_population->Begin()));
+        TS_ASSERT_EQUALS(arm.VerifyBoundaryCondition(), false);
+
+        delete p_population;
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTIMPOSEDBOUNDARYCONDITIONRECORD_HPP_*/
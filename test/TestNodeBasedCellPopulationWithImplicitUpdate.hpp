@@ -0,0 +1,277 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTNODEBASEDCELLPOPULATIONWITHIMPLICITUPDATE_HPP_
+#define TESTNODEBASEDCELLPOPULATIONWITHIMPLICITUPDATE_HPP_
+/*Compares the semi-implicit node update against the explicit one on a tightly packed cluster of small cells,
+ *where the mass-corrected repulsion is stiff: the implicit update should reach the same configuration as a
+ *finely resolved explicit run while taking ten times fewer steps than the explicit scheme needs, with every
+ *update converging. Also checks that the implicit force survives archiving with the population.*/
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "FixedDurationGenerationBasedCellCycleModel.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "Timer.hpp"
+#include "ArchiveOpener.hpp"
+#include "ArchiveLocationInfo.hpp"
+
+#include "RepulsionForceMassCorrected.hpp"
+#include "NodeBasedCellPopulationWithImplicitUpdate.hpp"
+
+class TestNodeBasedCellPopulationWithImplicitUpdate : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*Relax a 3x3x3 block of cells of radius 1 on a lattice of spacing 1.6 for the given time, with the implicit
+     *or explicit update, and record where the nodes end up and, for the implicit update, the total number of
+     *block Jacobi iterations. Checks every implicit update converged. Returns the time taken.*/
+    double RelaxCluster(bool useImplicitUpdate, double dt, double endTime, std::vector<c_vector<double,3> >& rFinalLocations,
+                        unsigned& rNumIterations)
+    {
+        std::vector<Node<3>*> nodes;
+        unsigned index=0;
+        for(unsigned i=0; i<3; i++){
+            for(unsigned j=0; j<3; j++){
+                for(unsigned k=0; k<3; k++){
+                    // A slight shear, so the cluster isn't symmetric
+                    nodes.push_back(new Node<3>(index, false, 1.6*i+0.1*j, 1.6*j+0.1*k, 1.6*k));
+                    index++;
+                }
+            }
+        }
+        NodesOnlyMesh<3> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 5.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, mesh.GetNumNodes(), p_transit_type);
+
+        MAKE_PTR(RepulsionForceMassCorrected<3>, p_force);
+        p_force->SetMeinekeSpringStiffness(1.5);
+
+        NodeBasedCellPopulation<3>* p_population=NULL;
+        NodeBasedCellPopulationWithImplicitUpdate<3>* p_implicit_population=NULL;
+        if(useImplicitUpdate){
+            p_implicit_population = new NodeBasedCellPopulationWithImplicitUpdate<3>(mesh, cells);
+            p_implicit_population->SetImplicitForce(p_force);
+            p_population=p_implicit_population;
+        }else{
+            p_population=new NodeBasedCellPopulation<3>(mesh, cells);
+        }
+        p_population->SetDampingConstantNormal(0.1);
+        p_population->SetAbsoluteMovementThreshold(10);
+
+        // Old cells, so every contact uses the full rest length
+        for (AbstractCellPopulation<3>::Iterator cell_iter = p_population->Begin();
+             cell_iter != p_population->End();
+             ++cell_iter)
+        {
+            cell_iter->SetBirthTime(-10.0);
+            cell_iter->GetCellData()->SetItem("Radius",1.0);
+            p_population->GetNode(p_population->GetLocationIndexUsingCell(*cell_iter))->SetRadius(1.0);
+        }
+        p_population->Update();
+
+        unsigned num_steps = (unsigned)(endTime/dt + 0.5);
+        rNumIterations = 0;
+        Timer::Reset();
+        for (unsigned step=0; step<num_steps; step++)
+        {
+            for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+                 node_iter != mesh.GetNodeIteratorEnd();
+                 ++node_iter)
+            {
+                node_iter->ClearAppliedForce();
+            }
+            p_force->AddForceContribution(*p_population);
+            p_population->UpdateNodeLocations(dt);
+            p_population->Update();
+
+            if(useImplicitUpdate){
+                TS_ASSERT_LESS_THAN(p_implicit_population->GetNumIterationsLastUpdate(), p_implicit_population->GetMaxIterations());
+                rNumIterations += p_implicit_population->GetNumIterationsLastUpdate();
+            }
+        }
+        double elapsed_time = Timer::GetElapsedTime();
+        if(useImplicitUpdate){
+            TS_ASSERT_EQUALS(p_implicit_population->GetNumUpdatesNotConverged(), 0u);
+        }
+
+        rFinalLocations.resize(mesh.GetNumNodes());
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            rFinalLocations[node_iter->GetIndex()] = node_iter->rGetLocation();
+        }
+
+        delete p_population;
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+        return elapsed_time;
+    }
+
+    /*The largest distance between corresponding locations.*/
+    double MaxDifference(std::vector<c_vector<double,3> >& rLocations, std::vector<c_vector<double,3> >& rOtherLocations)
+    {
+        TS_ASSERT_EQUALS(rLocations.size(), rOtherLocations.size());
+        double max_difference=0.0;
+        for (unsigned i=0; i<rLocations.size(); i++)
+        {
+            max_difference = std::max(max_difference, norm_2(rLocations[i]-rOtherLocations[i]));
+        }
+        return max_difference;
+    }
+
+public:
+
+    void TestImplicitUpdateConvergesWithLargerTimestep() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        /* Each contact here is about c*k/damping ~ 10*1.9/0.1 stiff, and a cell has up to six, so the explicit
+         * update is only stable for dt below about 2e-3.*/
+        double end_time=0.5;
+
+        unsigned num_iterations;
+        std::vector<c_vector<double,3> > reference_locations;
+        RelaxCluster(false, 1e-4, end_time, reference_locations, num_iterations);
+
+        std::vector<c_vector<double,3> > explicit_locations;
+        double explicit_time = RelaxCluster(false, 1e-3, end_time, explicit_locations, num_iterations);
+
+        // Every implicit update converges (checked in RelaxCluster()): a few dozen iterations while the cluster is
+        // tightly packed, then only one or two as it comes to rest
+        unsigned implicit_iterations;
+        std::vector<c_vector<double,3> > implicit_locations;
+        double implicit_time = RelaxCluster(true, 1e-2, end_time, implicit_locations, implicit_iterations);
+        TS_ASSERT_LESS_THAN(50u, implicit_iterations);
+
+        // The cluster has spread out from its initial spacing (its corners start 5.78 apart)...
+        TS_ASSERT_LESS_THAN(6.0, norm_2(reference_locations[26]-reference_locations[0]));
+
+        // ...and both schemes agree with the finely resolved run
+        TS_ASSERT_LESS_THAN(MaxDifference(explicit_locations, reference_locations), 0.01);
+        TS_ASSERT_LESS_THAN(MaxDifference(implicit_locations, reference_locations), 0.01);
+
+        // At the implicit timestep the explicit update overshoots and never settles
+        std::vector<c_vector<double,3> > unstable_locations;
+        RelaxCluster(false, 1e-2, end_time, unstable_locations, num_iterations);
+        TS_ASSERT_LESS_THAN(0.1, MaxDifference(unstable_locations, reference_locations));
+
+        /*
+         * The implicit run evaluates the forces 50 times rather than 500, and each block Jacobi iteration is one
+         * loop over the same contacts, cheaper than a force evaluation; in all it takes fewer iterations than the
+         * explicit run takes steps. The wall clock times are too short to compare reliably, so are only reported.
+         */
+        TS_ASSERT_LESS_THAN(implicit_iterations, 500u);
+        std::cout << "Explicit update, dt=1e-3: " << explicit_time << "s; implicit update, dt=1e-2: " << implicit_time << "s" << std::endl;
+    }
+
+    void TestArchivingKeepsImplicitForce() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        FileFinder archive_dir("archive", RelativeTo::ChasteTestOutput);
+        std::string archive_file = "implicit_update_population.arch";
+        ArchiveLocationInfo::SetMeshFilename("implicit_update_population_mesh");
+
+        {
+            SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+            std::vector<Node<3>*> nodes;
+            nodes.push_back(new Node<3>(0, false, 0.0, 0.0, 0.0));
+            nodes.push_back(new Node<3>(1, false, 1.5, 0.0, 0.0));
+            NodesOnlyMesh<3> mesh;
+            mesh.ConstructNodesWithoutMesh(nodes, 5.0);
+
+            std::vector<CellPtr> cells;
+            MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+            CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 3> cells_generator;
+            cells_generator.GenerateBasicRandom(cells, mesh.GetNumNodes(), p_transit_type);
+
+            NodeBasedCellPopulationWithImplicitUpdate<3>* const p_population = new NodeBasedCellPopulationWithImplicitUpdate<3>(mesh, cells);
+            MAKE_PTR(RepulsionForceMassCorrected<3>, p_force);
+            p_force->SetMeinekeSpringStiffness(1.5);
+            p_population->SetImplicitForce(p_force);
+            p_population->SetMaxIterations(30);
+
+            // Archive the force as the simulation's force collection holds it, after the population
+            boost::shared_ptr<AbstractForce<3> > p_abstract_force = p_force;
+            ArchiveOpener<boost::archive::text_oarchive, std::ofstream> arch_opener(archive_dir, archive_file);
+            boost::archive::text_oarchive* p_arch = arch_opener.GetCommonArchive();
+            (*p_arch) << static_cast<const SimulationTime&>(*SimulationTime::Instance());
+            (*p_arch) << p_population;
+            (*p_arch) << p_abstract_force;
+
+            delete p_population;
+            for (unsigned i=0; i<nodes.size(); i++)
+            {
+                delete nodes[i];
+            }
+        }
+
+        {
+            NodeBasedCellPopulationWithImplicitUpdate<3>* p_population;
+            boost::shared_ptr<AbstractForce<3> > p_abstract_force;
+
+            ArchiveOpener<boost::archive::text_iarchive, std::ifstream> arch_opener(archive_dir, archive_file);
+            boost::archive::text_iarchive* p_arch = arch_opener.GetCommonArchive();
+            (*p_arch) >> *SimulationTime::Instance();
+            (*p_arch) >> p_population;
+            (*p_arch) >> p_abstract_force;
+
+            // The population's implicit force is the same object as the archived force, so the update stays implicit
+            TS_ASSERT_EQUALS(p_population->GetMaxIterations(), 30u);
+            TS_ASSERT(p_population->GetImplicitForce());
+            TS_ASSERT_EQUALS(static_cast<AbstractForce<3>*>(p_population->GetImplicitForce().get()), p_abstract_force.get());
+            TS_ASSERT_DELTA(p_population->GetImplicitForce()->GetMeinekeSpringStiffness(), 1.5, 1e-12);
+
+            delete p_population;
+        }
+    }
+};
+
+#endif /*TESTNODEBASEDCELLPOPULATIONWITHIMPLICITUPDATE_HPP_*/
@@ -0,0 +1,663 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTREPULSIONFORCEMASSCORRECTED_HPP_
+#define TESTREPULSIONFORCEMASSCORRECTED_HPP_
+/*Checks the RepulsionForceMassCorrected kernel against the pairwise GeneralisedLinearSpringForce law it
+ *replaces, and reports the kernel's throughput (pairs per second) on a population filling the straight
+ *parts of the adult gonad arm, with and without spatial reordering of the kernel's slots; the forces must
+ *not depend on either ordering, nor on SpatialReorderingModifier sorting the cells, which must keep every
+ *cell on its node. Also checks that reusing a neighbour list within its skin gives the same forces as building
+ *it afresh while cells move, grow, die and are born, the accuracy of the force law lookup table, and that the
+ *force's settings survive archiving.*/
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "FixedDurationGenerationBasedCellCycleModel.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "Timer.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "RepulsionForceMassCorrected.hpp"
+#include "ForceLawTable.hpp"
+#include "SpatialReorderingModifier.hpp"
+
+#include <map>
+#include <set>
+
+class TestRepulsionForceMassCorrected : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*Make a population from the given nodes, with every cell (and node) of the given radius.*/
+    NodeBasedCellPopulation<3>* MakePopulation(std::vector<Node<3>*>& rNodes, NodesOnlyMesh<3>& rMesh, double radius,
+                                               double cutOffLength=35.0)
+    {
+        rMesh.ConstructNodesWithoutMesh(rNodes, cutOffLength);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<FixedDurationGenerationBasedCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, rMesh.GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3>* p_population = new NodeBasedCellPopulation<3>(rMesh, cells);
+
+        for (AbstractCellPopulation<3>::Iterator cell_iter = p_population->Begin();
+             cell_iter != p_population->End();
+             ++cell_iter)
+        {
+            cell_iter->GetCellData()->SetItem("Radius",radius);
+            Node<3>* p_node = p_population->GetNode(p_population->GetLocationIndexUsingCell(*cell_iter));
+            p_node->SetRadius(radius);
+        }
+        p_population->Update();
+        return p_population;
+    }
+
+    /*Zero the applied force on every node, add a force's contribution and return each node's force by index.*/
+    std::map<unsigned, c_vector<double,3> > CalculateForces(RepulsionForceMassCorrected<3>& rForce,
+                                                            NodeBasedCellPopulation<3>& rPopulation)
+    {
+        NodesOnlyMesh<3>& r_mesh = rPopulation.rGetMesh();
+        ClearForces(r_mesh);
+        rForce.AddForceContribution(rPopulation);
+        std::map<unsigned, c_vector<double,3> > forces;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+             node_iter != r_mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            forces[node_iter->GetIndex()] = node_iter->rGetAppliedForce();
+        }
+        return forces;
+    }
+
+    /*Zero the applied force on every node.*/
+    void ClearForces(NodesOnlyMesh<3>& rMesh)
+    {
+        for (AbstractMesh<3,3>::NodeIterator node_iter = rMesh.GetNodeIteratorBegin();
+             node_iter != rMesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            node_iter->ClearAppliedForce();
+        }
+    }
+
+public:
+
+void TestKernelMatchesPairwiseForceLaw() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        // A loose clump of cells of differing sizes, so there are compressed and stretched contacts
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<60; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 20.0*p_gen->ranf(), 20.0*p_gen->ranf(), 20.0*p_gen->ranf()));
+        }
+        NodesOnlyMesh<3> mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(nodes, mesh, 2.5);
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            node_iter->SetRadius(2.0 + 1.5*p_gen->ranf());
+        }
+        // One dying cell, to check the apoptotic rest length
+        p_population->GetCellUsingLocationIndex(0)->StartApoptosis();
+
+        // Reference: the old loop, one CalculateForceBetweenNodes() call per pair in contact
+        GeneralisedLinearSpringForce<3> pairwise_force;
+        pairwise_force.SetMeinekeSpringStiffness(1.5);
+        std::vector<c_vector<double,3> > expected_forces(mesh.GetNumNodes(), zero_vector<double>(3));
+        std::vector< std::pair<Node<3>*, Node<3>* > >& r_node_pairs = p_population->rGetNodePairs();
+        for (unsigned i=0; i<r_node_pairs.size(); i++)
+        {
+            Node<3>* p_node_a = r_node_pairs[i].first;
+            Node<3>* p_node_b = r_node_pairs[i].second;
+            double distance = norm_2(p_node_b->rGetLocation() - p_node_a->rGetLocation());
+            if (distance < p_node_a->GetRadius() + p_node_b->GetRadius())
+            {
+                c_vector<double,3> force = pairwise_force.CalculateForceBetweenNodes(p_node_a->GetIndex(), p_node_b->GetIndex(), *p_population);
+                expected_forces[p_node_a->GetIndex()] += force/(p_node_a->GetRadius()/10);
+                expected_forces[p_node_b->GetIndex()] -= force/(p_node_b->GetRadius()/10);
+            }
+        }
+
+        RepulsionForceMassCorrected<3> force;
+        force.SetMeinekeSpringStiffness(1.5);
+        ClearForces(mesh);
+        force.AddForceContribution(*p_population);
+
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            for (unsigned d=0; d<3; d++)
+            {
+                TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[d], expected_forces[node_iter->GetIndex()][d], 1e-10);
+            }
+        }
+
+        delete p_population;
+    }
+
+void TestThreadedKernelIsDeterministic() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<200; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 30.0*p_gen->ranf(), 30.0*p_gen->ranf(), 30.0*p_gen->ranf()));
+        }
+        NodesOnlyMesh<3> mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(nodes, mesh, 2.5);
+
+        // Forces with a single thread
+        RepulsionForceMassCorrected<3> force;
+        ClearForces(mesh);
+        force.AddForceContribution(*p_population);
+        std::vector<c_vector<double,3> > serial_forces;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            serial_forces.push_back(node_iter->rGetAppliedForce());
+        }
+
+        // Forces split over four chunks agree up to rounding, and repeat exactly
+#ifndef _OPENMP
+        TS_WARN("Built without OpenMP, so the threaded kernel is not being tested; see README.md");
+#endif
+        force.SetNumberOfThreads(4);
+        TS_ASSERT_EQUALS(force.GetNumberOfThreads(), 4u);
+        std::vector<c_vector<double,3> > threaded_forces;
+        for (unsigned run=0; run<2; run++)
+        {
+            ClearForces(mesh);
+            force.AddForceContribution(*p_population);
+            unsigned i=0;
+            for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+                 node_iter != mesh.GetNodeIteratorEnd();
+                 ++node_iter, ++i)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[d], serial_forces[i][d], 1e-10);
+                    if (run==1)
+                    {
+                        TS_ASSERT_EQUALS(node_iter->rGetAppliedForce()[d], threaded_forces[i][d]);
+                    }
+                }
+                if (run==0)
+                {
+                    threaded_forces.push_back(node_iter->rGetAppliedForce());
+                }
+            }
+        }
+
+        delete p_population;
+    }
+
+void TestVerletSkinMatchesRebuildingEveryStep() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<80; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 15.0*p_gen->ranf(), 15.0*p_gen->ranf(), 15.0*p_gen->ranf()));
+        }
+        NodesOnlyMesh<3> mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(nodes, mesh, 2.0);
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+
+        // A list with a skin of 2 is reused until some node has moved, or grown, by more than 1 in total
+        RepulsionForceMassCorrected<3> skin_force;
+        skin_force.SetMeinekeSpringStiffness(1.5);
+        skin_force.SetVerletSkin(2.0);
+
+        unsigned num_steps_with_skin_pairs = 0;
+        for (unsigned step=0; step<40; step++)
+        {
+            if (step > 0)
+            {
+                // Jiggle every node a little, and now and then move one by more than the whole skin
+                for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+                     node_iter != mesh.GetNodeIteratorEnd();
+                     ++node_iter)
+                {
+                    double step_size = (p_gen->ranf() < 0.05) ? 2.5 : 0.3;
+                    for (unsigned d=0; d<3; d++)
+                    {
+                        node_iter->rGetModifiableLocation()[d] += step_size*(2.0*p_gen->ranf() - 1.0);
+                    }
+
+                    // Grow some cells, so pairs can come into contact without moving
+                    if (node_iter->GetIndex()%3 == 0 && node_iter->GetRadius() < 3.0)
+                    {
+                        node_iter->SetRadius(node_iter->GetRadius() + 0.1);
+                    }
+                }
+
+                // A death, a birth, and a death and birth on the same step (which may reuse the node's index)
+                if (step == 10 || step == 25)
+                {
+                    p_population->GetCellUsingLocationIndex(mesh.GetNodeIteratorBegin()->GetIndex())->Kill();
+                    p_population->RemoveDeadCells();
+                }
+                if (step == 18 || step == 25)
+                {
+                    CellPtr p_new_cell(new Cell(p_state, new FixedDurationGenerationBasedCellCycleModel()));
+                    p_new_cell->SetCellProliferativeType(p_transit_type);
+                    p_new_cell->GetCellData()->SetItem("Radius", 2.0);
+                    c_vector<double,3> new_location;
+                    for (unsigned d=0; d<3; d++)
+                    {
+                        new_location[d] = 15.0*p_gen->ranf();
+                    }
+                    p_population->AddCell(p_new_cell, new_location, *(p_population->Begin()));
+                    mesh.GetNode(p_population->GetLocationIndexUsingCell(p_new_cell))->SetRadius(2.0);
+                }
+                p_population->Update();
+            }
+
+            // A force with no skin, made afresh, must build its list from scratch
+            RepulsionForceMassCorrected<3> fresh_force;
+            fresh_force.SetMeinekeSpringStiffness(1.5);
+            fresh_force.SetVerletSkin(0.0);
+
+            std::map<unsigned, c_vector<double,3> > expected_forces = CalculateForces(fresh_force, *p_population);
+            std::map<unsigned, c_vector<double,3> > skin_forces = CalculateForces(skin_force, *p_population);
+            TS_ASSERT_EQUALS(skin_forces.size(), p_population->GetNumRealCells());
+            TS_ASSERT_EQUALS(skin_forces.size(), expected_forces.size());
+            for (std::map<unsigned, c_vector<double,3> >::iterator iter = expected_forces.begin();
+                 iter != expected_forces.end();
+                 ++iter)
+            {
+                TS_ASSERT_EQUALS(skin_forces.count(iter->first), 1u);
+                for (unsigned d=0; d<3; d++)
+                {
+                    TS_ASSERT_DELTA(skin_forces[iter->first][d], iter->second[d], 1e-10);
+                }
+            }
+
+            if (skin_force.GetNumNeighbourPairs() > fresh_force.GetNumNeighbourPairs())
+            {
+                num_steps_with_skin_pairs++;
+            }
+        }
+        TS_ASSERT_EQUALS(p_population->GetNumRealCells(), 80u);
+
+        // The skinned list holds pairs that aren't yet in contact, so it is doing more than the fresh one
+        TS_ASSERT_LESS_THAN(30u, num_steps_with_skin_pairs);
+
+        delete p_population;
+    }
+
+void TestForceLawTableAccuracy() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        // Interpolation errors stay within the table's bound, including either side of the kink at zero overlap,
+        // and overlaps outside the table are evaluated exactly
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        for (unsigned cubic=0; cubic<2; cubic++)
+        {
+            ForceLawTable table(cubic ? 100 : 1000, cubic==1);
+            TS_ASSERT_DELTA(table.GetMinOverlap(), -0.9, 1e-12);
+            TS_ASSERT_DELTA(table.GetMaxOverlap(), 1.0, 1e-12);
+            TS_ASSERT_LESS_THAN(table.GetErrorBound(), 2e-5);
+            TS_ASSERT_DELTA(table.Calculate(0.0), 0.0, 1e-15);
+
+            double max_error = 0.0;
+            for (unsigned i=0; i<100000; i++)
+            {
+                double x = -0.98 + 2.1*p_gen->ranf();
+                max_error = std::max(max_error, fabs(table.Calculate(x) - ForceLawTable::CalculateExactly(x, 5.0)));
+            }
+            TS_ASSERT_LESS_THAN_EQUALS(max_error, table.GetErrorBound());
+        }
+        TS_ASSERT_THROWS_THIS(ForceLawTable(100, true, 5.0, -1.0), "The force law table range must lie above -1 and include 0.");
+
+        // The kernel with a table agrees with the exact kernel on a clump with compressed and stretched contacts
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<60; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 20.0*p_gen->ranf(), 20.0*p_gen->ranf(), 20.0*p_gen->ranf()));
+        }
+        NodesOnlyMesh<3> mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(nodes, mesh, 2.5);
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            node_iter->SetRadius(2.95 + 1.5*p_gen->ranf());
+        }
+        p_population->GetCellUsingLocationIndex(0)->StartApoptosis();
+
+        RepulsionForceMassCorrected<3> force;
+        force.SetMeinekeSpringStiffness(1.5);
+        ClearForces(mesh);
+        force.AddForceContribution(*p_population);
+        std::vector<c_vector<double,3> > exact_forces;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            exact_forces.push_back(node_iter->rGetAppliedForce());
+        }
+
+        force.SetForceLawTable(1000);
+        TS_ASSERT_EQUALS(force.GetForceLawTableResolution(), 1000u);
+        TS_ASSERT_EQUALS(force.GetUseCubicForceLawTable(), true);
+        ClearForces(mesh);
+        force.AddForceContribution(*p_population);
+        unsigned i=0;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter, ++i)
+        {
+            for (unsigned d=0; d<3; d++)
+            {
+                TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[d], exact_forces[i][d], 1e-6);
+            }
+        }
+
+        // Switching the table off goes back to the exact law
+        force.SetForceLawTable(0);
+        TS_ASSERT(!force.GetForceLawTable());
+
+        delete p_population;
+    }
+
+void TestKernelThroughputInGonadArm() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        /* Fill the lower and upper straight parts of the adult gonad arm (as in TestElegansAdult) with cells of
+         * radius 3 on a lattice of spacing 5, so each cell overlaps its lattice neighbours.*/
+        double LengthOfStraightLower=176;
+        double LengthOfStraightUpper=161;
+        double RadiusOfTurn=20;
+        double RadiusOfTube=15;
+        double spacing=5;
+
+        std::vector<Node<3>*> nodes;
+        unsigned index=0;
+        for(double y_centre=-RadiusOfTurn; y_centre<=RadiusOfTurn; y_centre+=2*RadiusOfTurn){
+            double length = (y_centre<0) ? LengthOfStraightLower : LengthOfStraightUpper;
+            for(double x=0; x<length; x+=spacing){
+                for(double y=-RadiusOfTube; y<=RadiusOfTube; y+=spacing){
+                    for(double z=-RadiusOfTube; z<=RadiusOfTube; z+=spacing){
+                        if(y*y+z*z < (RadiusOfTube-2.5)*(RadiusOfTube-2.5)){
+                            nodes.push_back(new Node<3>(index, false, x, y_centre+y, z));
+                            index++;
+                        }
+                    }
+                }
+            }
+        }
+        NodesOnlyMesh<3> mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(nodes, mesh, 3.0);
+
+        RepulsionForceMassCorrected<3> force;
+        force.SetMeinekeSpringStiffness(1.5);
+        force.SetVerletSkin(2.0);
+
+        // The first call builds the neighbour list; the nodes don't move, so later calls reuse it
+        ClearForces(mesh);
+        force.AddForceContribution(*p_population);
+
+        unsigned num_repeats = 200;
+        Timer::Reset();
+        for (unsigned i=0; i<num_repeats; i++)
+        {
+            ClearForces(mesh);
+            force.AddForceContribution(*p_population);
+        }
+        double elapsed_time = Timer::GetElapsedTime();
+
+        unsigned num_pairs = force.GetNumNeighbourPairs();
+        TS_ASSERT_LESS_THAN(0u, num_pairs);
+        TS_ASSERT_LESS_THAN(num_pairs, p_population->rGetNodePairs().size());
+
+        std::cout << "RepulsionForceMassCorrected: " << mesh.GetNumNodes() << " cells, " << num_pairs
+                  << " neighbour pairs, " << p_population->rGetNodePairs().size() << " mesh pairs" << std::endl;
+        if (elapsed_time > 0.0)
+        {
+            std::cout << "RepulsionForceMassCorrected: " << num_repeats*num_pairs/elapsed_time << " pairs per second" << std::endl;
+        }
+
+        delete p_population;
+    }
+
+void TestSpatialReorderingOnShuffledGonadArm() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        /* Fill the straight parts of the gonad arm with about 20,000 cells of radius 1.2 on a lattice of spacing 2,
+         * then shuffle the node order so that neighbouring cells end up far apart in the mesh, as they do after
+         * many divisions and deaths.*/
+        double LengthOfStraightLower=176;
+        double LengthOfStraightUpper=161;
+        double RadiusOfTurn=20;
+        double RadiusOfTube=15;
+        double spacing=2;
+
+        std::vector<c_vector<double,3> > locations;
+        for(double y_centre=-RadiusOfTurn; y_centre<=RadiusOfTurn; y_centre+=2*RadiusOfTurn){
+            double length = (y_centre<0) ? LengthOfStraightLower : LengthOfStraightUpper;
+            for(double x=0; x<length; x+=spacing){
+                for(double y=-RadiusOfTube; y<=RadiusOfTube; y+=spacing){
+                    for(double z=-RadiusOfTube; z<=RadiusOfTube; z+=spacing){
+                        if(y*y+z*z < (RadiusOfTube-2.5)*(RadiusOfTube-2.5)){
+                            c_vector<double,3> location;
+                            location[0]=x;
+                            location[1]=y_centre+y;
+                            location[2]=z;
+                            locations.push_back(location);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<unsigned> shuffled;
+        RandomNumberGenerator::Instance()->Shuffle(locations.size(), shuffled);
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            nodes.push_back(new Node<3>(i, locations[shuffled[i]]));
+        }
+        NodesOnlyMesh<3> mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(nodes, mesh, 1.2, 5.0);
+
+        RepulsionForceMassCorrected<3> unordered_force;
+        unordered_force.SetMeinekeSpringStiffness(1.5);
+        unordered_force.SetVerletSkin(1.0);
+        unordered_force.SetUseSpatialReordering(false);
+
+        RepulsionForceMassCorrected<3> ordered_force;
+        ordered_force.SetMeinekeSpringStiffness(1.5);
+        ordered_force.SetVerletSkin(1.0);
+        TS_ASSERT_EQUALS(ordered_force.GetUseSpatialReordering(), true);
+
+        // Both orderings must give the same forces, up to rounding from the order of summation
+        ClearForces(mesh);
+        unordered_force.AddForceContribution(*p_population);
+        std::vector<c_vector<double,3> > unordered_forces;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            unordered_forces.push_back(node_iter->rGetAppliedForce());
+        }
+
+        ClearForces(mesh);
+        ordered_force.AddForceContribution(*p_population);
+        TS_ASSERT_EQUALS(ordered_force.GetNumNeighbourPairs(), unordered_force.GetNumNeighbourPairs());
+        unsigned i=0;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter, ++i)
+        {
+            for (unsigned d=0; d<3; d++)
+            {
+                TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[d], unordered_forces[i][d], 1e-9);
+            }
+        }
+
+        // Sorting the population's cells into Morton order must keep the same cells, each on the same node
+        std::map<Cell*, unsigned> node_index_of_cell;
+        for (std::list<CellPtr>::iterator cell_iter = p_population->rGetCells().begin();
+             cell_iter != p_population->rGetCells().end();
+             ++cell_iter)
+        {
+            node_index_of_cell[cell_iter->get()] = p_population->GetLocationIndexUsingCell(*cell_iter);
+        }
+        std::list<CellPtr> cells_before = p_population->rGetCells();
+
+        SpatialReorderingModifier<3> reordering_modifier;
+        reordering_modifier.SetupSolve(*p_population, "TestRepulsionForceMassCorrected");
+
+        TS_ASSERT_EQUALS(p_population->rGetCells().size(), cells_before.size());
+        TS_ASSERT_EQUALS(p_population->GetNumRealCells(), locations.size());
+        TS_ASSERT(p_population->rGetCells() != cells_before);
+        std::set<Cell*> cells_seen;
+        for (std::list<CellPtr>::iterator cell_iter = p_population->rGetCells().begin();
+             cell_iter != p_population->rGetCells().end();
+             ++cell_iter)
+        {
+            TS_ASSERT_EQUALS(node_index_of_cell.count(cell_iter->get()), 1u);
+            TS_ASSERT_EQUALS(cells_seen.count(cell_iter->get()), 0u);
+            cells_seen.insert(cell_iter->get());
+            TS_ASSERT_EQUALS(p_population->GetLocationIndexUsingCell(*cell_iter), node_index_of_cell[cell_iter->get()]);
+        }
+        TS_ASSERT_EQUALS(cells_seen.size(), node_index_of_cell.size());
+
+        // The forces on the nodes don't depend on the order of the list of cells
+        ClearForces(mesh);
+        ordered_force.AddForceContribution(*p_population);
+        i=0;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter, ++i)
+        {
+            for (unsigned d=0; d<3; d++)
+            {
+                TS_ASSERT_DELTA(node_iter->rGetAppliedForce()[d], unordered_forces[i][d], 1e-9);
+            }
+        }
+
+        // Time the kernel with each ordering; the nodes don't move, so the lists are reused
+        unsigned num_repeats = 50;
+        Timer::Reset();
+        for (unsigned repeat=0; repeat<num_repeats; repeat++)
+        {
+            ClearForces(mesh);
+            unordered_force.AddForceContribution(*p_population);
+        }
+        double unordered_time = Timer::GetElapsedTime();
+
+        Timer::Reset();
+        for (unsigned repeat=0; repeat<num_repeats; repeat++)
+        {
+            ClearForces(mesh);
+            ordered_force.AddForceContribution(*p_population);
+        }
+        double ordered_time = Timer::GetElapsedTime();
+
+        std::cout << "RepulsionForceMassCorrected: " << mesh.GetNumNodes() << " shuffled cells, "
+                  << ordered_force.GetNumNeighbourPairs() << " neighbour pairs" << std::endl;
+        std::cout << "RepulsionForceMassCorrected: " << unordered_time << "s in mesh order, "
+                  << ordered_time << "s in Morton order" << std::endl;
+
+        delete p_population;
+    }
+
+void TestArchiving() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        OutputFileHandler handler("TestRepulsionForceMassCorrected", false);
+        std::string archive_filename = handler.GetOutputDirectoryFullPath() + "RepulsionForceMassCorrected.arch";
+
+        {
+            RepulsionForceMassCorrected<3> force;
+            force.SetMeinekeSpringStiffness(1.5);
+            force.SetVerletSkin(0.75);
+            force.SetUseSpatialReordering(false);
+            force.SetForceLawTable(64, false);
+            force.SetNumberOfThreads(2);
+
+            std::ofstream ofs(archive_filename.c_str());
+            boost::archive::text_oarchive output_arch(ofs);
+            AbstractForce<3>* const p_force = &force;
+            output_arch << p_force;
+        }
+
+        {
+            AbstractForce<3>* p_force;
+            std::ifstream ifs(archive_filename.c_str(), std::ios::binary);
+            boost::archive::text_iarchive input_arch(ifs);
+            input_arch >> p_force;
+
+            RepulsionForceMassCorrected<3>* p_repulsion_force = dynamic_cast<RepulsionForceMassCorrected<3>*>(p_force);
+            TS_ASSERT(p_repulsion_force != NULL);
+            TS_ASSERT_DELTA(p_repulsion_force->GetMeinekeSpringStiffness(), 1.5, 1e-12);
+            TS_ASSERT_DELTA(p_repulsion_force->GetVerletSkin(), 0.75, 1e-12);
+            TS_ASSERT_EQUALS(p_repulsion_force->GetUseSpatialReordering(), false);
+            TS_ASSERT_EQUALS(p_repulsion_force->GetForceLawTableResolution(), 64u);
+            TS_ASSERT_EQUALS(p_repulsion_force->GetUseCubicForceLawTable(), false);
+            // The number of threads depends on the machine, so is not archived
+            TS_ASSERT_EQUALS(p_repulsion_force->GetNumberOfThreads(), 1u);
+
+            delete p_force;
+        }
+    }
+};
+
+#endif /*TESTREPULSIONFORCEMASSCORRECTED_HPP_*/
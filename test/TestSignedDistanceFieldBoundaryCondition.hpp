@@ -0,0 +1,384 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTSIGNEDDISTANCEFIELDBOUNDARYCONDITION_HPP_
+#define TESTSIGNEDDISTANCEFIELDBOUNDARYCONDITION_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "ElegansStochasticCellCycleModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "TrianglesMeshReader.hpp"
+#include "TetrahedralMesh.hpp"
+
+#include "EllipsoidMovingBoundaryCondition.hpp"
+#include "CombinedStaticGonadBoundaryCondition.hpp"
+#include "GonadArmMovingBoundaryCondition.hpp"
+#include "SurfaceMeshDistanceFunction.hpp"
+#include "SignedDistanceField.hpp"
+#include "SignedDistanceFieldBoundaryCondition.hpp"
+
+class TestSignedDistanceFieldBoundaryCondition : public AbstractCellBasedTestSuite
+{
+private:
+
+    /** @return a location from its coordinates. */
+    c_vector<double,3> MakeLocation(double x, double y, double z)
+    {
+        c_vector<double,3> location;
+        location[0] = x;
+        location[1] = y;
+        location[2] = z;
+        return location;
+    }
+
+    /**
+     * @return a population of cells at the given locations, each of radius 0.5.
+     *
+     * @param rLocations the locations of the cells
+     * @param rpMesh set to the mesh of the population, to be deleted by the caller
+     */
+    NodeBasedCellPopulation<3>* MakePopulation(const std::vector<c_vector<double,3> >& rLocations, NodesOnlyMesh<3>*& rpMesh)
+    {
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<rLocations.size(); i++)
+        {
+            nodes.push_back(new Node<3>(i, rLocations[i]));
+        }
+        rpMesh = new NodesOnlyMesh<3>;
+        rpMesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, rpMesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3>* p_population = new NodeBasedCellPopulation<3>(*rpMesh, cells);
+        for (unsigned i=0; i<rpMesh->GetNumNodes(); i++)
+        {
+            rpMesh->GetNode(i)->SetRadius(0.5);
+        }
+        return p_population;
+    }
+
+public:
+
+    void TestSurfaceMeshDistanceFunction() throw(Exception)
+    {
+        /*
+         * Write out an octahedron |x|+|y|+|z| = 3, one triangle per octant, so that the exact signed distance is
+         * known: inside it is the distance to the closest face plane, and outside it lies between that and the
+         * distance to the point where the ray from the centre leaves the octahedron.
+         */
+        OutputFileHandler handler("TestSurfaceMeshDistanceFunction");
+        out_stream p_node_file = handler.OpenOutputFile("octahedron.node");
+        *p_node_file << "6 3 0 0\n";
+        *p_node_file << "0 3 0 0\n1 -3 0 0\n2 0 3 0\n3 0 -3 0\n4 0 0 3\n5 0 0 -3\n";
+        p_node_file->close();
+
+        out_stream p_element_file = handler.OpenOutputFile("octahedron.ele");
+        *p_element_file << "8 3 0\n";
+        unsigned element_index = 0;
+        for (unsigned x_node=0; x_node<2; x_node++)
+        {
+            for (unsigned y_node=2; y_node<4; y_node++)
+            {
+                for (unsigned z_node=4; z_node<6; z_node++)
+                {
+                    *p_element_file << element_index++ << " " << x_node << " " << y_node << " " << z_node << "\n";
+                }
+            }
+        }
+        p_element_file->close();
+
+        out_stream p_edge_file = handler.OpenOutputFile("octahedron.edge");
+        *p_edge_file << "0 0\n";
+        p_edge_file->close();
+
+        TrianglesMeshReader<2,3> mesh_reader(handler.GetOutputDirectoryFullPath() + "octahedron");
+        TetrahedralMesh<2,3> surface_mesh;
+        surface_mesh.ConstructFromMeshReader(mesh_reader);
+        SurfaceMeshDistanceFunction surface(surface_mesh);
+        TS_ASSERT_EQUALS(surface.GetNumTriangles(), 8u);
+
+        // Inside, closest to the interior of a face
+        TS_ASSERT_DELTA(surface.GetSignedDistance(MakeLocation(0.0, 0.0, 0.0)), -sqrt(3.0), 1e-12);
+        TS_ASSERT_DELTA(surface.GetSignedDistance(MakeLocation(0.5, 0.5, 0.5)), -0.5*sqrt(3.0), 1e-12);
+
+        // Outside, closest to the interior of a face, to a corner and to an edge
+        TS_ASSERT_DELTA(surface.GetSignedDistance(MakeLocation(2.0, 2.0, 2.0)), sqrt(3.0), 1e-12);
+        TS_ASSERT_DELTA(surface.GetSignedDistance(MakeLocation(5.0, 0.0, 0.0)), 2.0, 1e-12);
+        TS_ASSERT_DELTA(surface.GetSignedDistance(MakeLocation(3.0, 3.0, 0.0)), 3.0/sqrt(2.0), 1e-12);
+
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        for (unsigned i=0; i<1000; i++)
+        {
+            c_vector<double,3> location;
+            for (unsigned d=0; d<3; d++)
+            {
+                location[d] = 10.0*p_gen->ranf() - 5.0;
+            }
+            double norm_1 = fabs(location[0]) + fabs(location[1]) + fabs(location[2]);
+            double plane_distance = (norm_1 - 3.0)/sqrt(3.0);
+            double distance = surface.GetSignedDistance(location);
+
+            if (norm_1 < 3.0)
+            {
+                TS_ASSERT_DELTA(distance, plane_distance, 1e-12);
+            }
+            else
+            {
+                TS_ASSERT_LESS_THAN_EQUALS(plane_distance - 1e-12, distance);
+                TS_ASSERT_LESS_THAN_EQUALS(distance, norm_2(location)*(1.0 - 3.0/norm_1) + 1e-12);
+            }
+        }
+
+        // A mesh with no triangles cannot be used
+        TetrahedralMesh<2,3> empty_mesh;
+        TS_ASSERT_THROWS_THIS(SurfaceMeshDistanceFunction empty_surface(empty_mesh), "The surface mesh has no triangles.");
+    }
+
+    void TestSampledCombinedStaticFieldKeepsCellsOutOfSyncytium() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        /*
+         * Place cells inside the syncytium on the upper straight, where its radius is 4 in a tube of radius 10, and
+         * near the axis of the lower straight, where there is no syncytium.
+         */
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<c_vector<double,3> > locations;
+        for (unsigned i=0; i<40; i++)
+        {
+            double x = 30.0 + 20.0*p_gen->ranf();
+            double R = 0.5 + 1.5*p_gen->ranf();
+            double angle = 2.0*M_PI*p_gen->ranf();
+            double y = (i%2 == 0) ? 20.0 : -20.0;
+            locations.push_back(MakeLocation(x, y + R*cos(angle), R*sin(angle)));
+        }
+        NodesOnlyMesh<3>* p_mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(locations, p_mesh);
+
+        CombinedStaticGonadBoundaryCondition<3> combined(p_population, 176.0, 161.0, 20.0, 10.0);
+        c_vector<double,3> lower_corner = MakeLocation(20.0, -32.0, -12.0);
+        c_vector<double,3> upper_corner = MakeLocation(60.0, 32.0, 12.0);
+        boost::shared_ptr<SignedDistanceField<3> > p_field(new SignedDistanceField<3>(lower_corner, upper_corner, 1.0));
+        p_field->Sample(combined);
+
+        // On the axis of the upper straight a cell is 4 inside the syncytium, so outside the allowed region
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(40.0, 20.0, 0.0)), 4.0, 1e-12);
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(40.0, 26.0, 0.0)), -2.0, 1e-12);
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(40.0, 32.0, 0.0)), 2.0, 1e-12);
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(40.0, -20.0, 0.0)), -10.0, 1e-12);
+
+        /*
+         * Interpolated distances around the upper straight should be close to the exact ones, away from its axis
+         * and from the ridge where the syncytium and tube surfaces are equally close.
+         */
+        for (unsigned i=0; i<200; i++)
+        {
+            double x = 25.0 + 30.0*p_gen->ranf();
+            double R = (i%2 == 0) ? 1.5 + 4.5*p_gen->ranf() : 8.0 + 4.0*p_gen->ranf();
+            double angle = 2.0*M_PI*p_gen->ranf();
+            c_vector<double,3> location = MakeLocation(x, 20.0 + R*cos(angle), R*sin(angle));
+            TS_ASSERT_DELTA(p_field->GetSignedDistance(location), combined.GetSignedDistance(location), 0.1);
+        }
+
+        // Imposing the sampled field should push cells out of the syncytium, and leave those on the lower straight
+        SignedDistanceFieldBoundaryCondition<3> boundary_condition(p_population, p_field);
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        boundary_condition.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT(boundary_condition.VerifyBoundaryCondition());
+
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            c_vector<double,3> location = p_mesh->GetNode(i)->rGetLocation();
+            if (i%2 == 0)
+            {
+                double R = sqrt(pow(location[1] - 20.0, 2) + pow(location[2], 2));
+                TS_ASSERT_LESS_THAN(4.5 - 0.1, R);
+                TS_ASSERT_LESS_THAN(R, 9.5);
+                TS_ASSERT_LESS_THAN(combined.GetSignedDistance(location) + 0.5, 0.1);
+            }
+            else
+            {
+                TS_ASSERT_DELTA(norm_2(location - locations[i]), 0.0, 1e-12);
+            }
+        }
+
+        // Tidy up
+        delete p_population;
+        delete p_mesh;
+    }
+
+    void TestSampledArmFieldMatchesArm() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        std::vector<c_vector<double,3> > locations;
+        locations.push_back(MakeLocation(100.0, -20.0, 0.0));
+        NodesOnlyMesh<3>* p_mesh;
+        NodeBasedCellPopulation<3>* p_population = MakePopulation(locations, p_mesh);
+
+        // An arm that has grown round the turn and about 21 along the upper straight, so the box holds its distal cap
+        GonadArmMovingBoundaryCondition<3> arm(p_population, 260.0, 176.0, 161.0, 20.0, 5.0, 8.0, 0.7, 0.1);
+        c_vector<double,3> lower_corner = MakeLocation(-30.0, -30.0, -8.0);
+        c_vector<double,3> upper_corner = MakeLocation(30.0, 30.0, 8.0);
+        boost::shared_ptr<SignedDistanceField<3> > p_field(new SignedDistanceField<3>(lower_corner, upper_corner, 1.0));
+        p_field->Sample(arm);
+
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(10.0, -20.0, 0.0)), -5.0, 1e-12);
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(-20.0, 0.0, 0.0)), -5.0, 1e-12);
+        TS_ASSERT_DELTA(p_field->GetSignedDistance(MakeLocation(-20.0, 0.0, 3.0)), -2.0, 1e-12);
+
+        // Interpolated distances should be close to the exact ones away from the centreline and the turn centre
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        unsigned num_compared = 0;
+        for (unsigned i=0; i<2000; i++)
+        {
+            c_vector<double,3> location = MakeLocation(60.0*p_gen->ranf() - 30.0, 60.0*p_gen->ranf() - 30.0, 16.0*p_gen->ranf() - 8.0);
+            double exact_distance = arm.GetSignedDistance(location);
+            double R = exact_distance + 5.0;
+            if (R > 2.0 && R < 10.0)
+            {
+                TS_ASSERT_DELTA(p_field->GetSignedDistance(location), exact_distance, 0.15);
+                num_compared++;
+            }
+        }
+        TS_ASSERT_LESS_THAN(100u, num_compared);
+
+        // Tidy up
+        delete p_population;
+        delete p_mesh;
+    }
+
+
+    void TestSampledFieldConfinesCells() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        // Scatter cells in a shell outside a sphere of radius 5
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<50; i++)
+        {
+            c_vector<double,3> direction;
+            for (unsigned d=0; d<3; d++)
+            {
+                direction[d] = p_gen->StandardNormalRandomDeviate();
+            }
+            direction *= (5.0 + 2.0*p_gen->ranf())/norm_2(direction);
+            nodes.push_back(new Node<3>(i, false, direction[0], direction[1], direction[2]));
+        }
+
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            p_mesh->GetNode(i)->SetRadius(0.5);
+        }
+
+        // Sample the sphere from the analytic boundary condition, whose distance estimate is exact for a sphere
+        EllipsoidMovingBoundaryCondition<3> sphere(&cell_population, zero_vector<double>(3), 5.0, 5.0, 5.0);
+        c_vector<double,3> lower_corner = -8.0*scalar_vector<double>(3, 1.0);
+        c_vector<double,3> upper_corner = 8.0*scalar_vector<double>(3, 1.0);
+        boost::shared_ptr<SignedDistanceField<3> > p_field(new SignedDistanceField<3>(lower_corner, upper_corner, 0.5));
+        p_field->Sample(sphere);
+        TS_ASSERT_EQUALS(p_field->rGetNumPoints()[0], 33u);
+
+        // Interpolated distances away from the centre should be close to the exact ones
+        for (unsigned i=0; i<100; i++)
+        {
+            c_vector<double,3> location;
+            for (unsigned d=0; d<3; d++)
+            {
+                location[d] = 14.0*p_gen->ranf() - 7.0;
+            }
+            if (norm_2(location) > 2.0)
+            {
+                TS_ASSERT_DELTA(p_field->GetSignedDistance(location), norm_2(location) - 5.0, 0.1);
+            }
+        }
+
+        // The field should survive a round trip through a file
+        OutputFileHandler handler("TestSignedDistanceField");
+        std::string file_name = handler.GetOutputDirectoryFullPath() + "sphere.sdf";
+        p_field->SaveToFile(file_name);
+        SignedDistanceField<3> loaded_field;
+        loaded_field.LoadFromFile(file_name);
+        TS_ASSERT_EQUALS(loaded_field.rGetValues().size(), p_field->rGetValues().size());
+        TS_ASSERT_DELTA(loaded_field.GetSpacing(), 0.5, 1e-12);
+        c_vector<double,3> test_location;
+        test_location[0] = 1.3; test_location[1] = -4.1; test_location[2] = 2.7;
+        TS_ASSERT_DELTA(loaded_field.GetSignedDistance(test_location), p_field->GetSignedDistance(test_location), 1e-12);
+
+        // Imposing the boundary condition should bring every cell inside
+        SignedDistanceFieldBoundaryCondition<3> boundary_condition(&cell_population, p_field);
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        boundary_condition.ImposeBoundaryCondition(old_locations);
+        TS_ASSERT(boundary_condition.VerifyBoundaryCondition());
+
+        boundary_condition.SetVerifyFromImposedRecord(false);
+        TS_ASSERT(boundary_condition.VerifyBoundaryCondition());
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(p_mesh->GetNode(i)->rGetLocation()), 4.5 + 0.05);
+        }
+
+        // Tidy up
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTSIGNEDDISTANCEFIELDBOUNDARYCONDITION_HPP_*/
@@ -0,0 +1,481 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTSTATECHARTCELLCYCLEMODELSERIALIZABLE_HPP_
+#define TESTSTATECHARTCELLCYCLEMODELSERIALIZABLE_HPP_
+/*Checks the statechart cell cycle model's archiving: loading the positional (version 0) and named (version 1)
+ *formats of the chart variables, variables the current chart doesn't have, and the deferred restore of a loaded
+ *chart. Also checks multi-rate updating of the chart, and that the models' pool is reused rather than grown.*/
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "SmartPointers.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "StatechartCellCycleModelSerializable.hpp"
+
+#include <fstream>
+#include <string>
+#include <set>
+#include <deque>
+
+class TestStatechartCellCycleModelSerializable : public AbstractCellBasedTestSuite
+{
+private:
+
+    /*Make a cell with a statechart cell cycle model, born at the given time, and initialise its chart.*/
+    CellPtr MakeCell(double birthTime)
+    {
+        StatechartCellCycleModelSerializable* p_model = new StatechartCellCycleModelSerializable();
+        p_model->SetBirthTime(birthTime);
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellPtr p_cell(new Cell(p_state, p_model));
+        p_cell->SetCellProliferativeType(p_transit_type);
+        p_cell->InitialiseCellCycleModel();
+        return p_cell;
+    }
+
+    /*
+     * Load a model's construct data, as written by an older save_construct_data(), from a file and restore its
+     * chart on a new cell.
+     */
+    StatechartCellCycleModelSerializable* LoadConstructData(const std::string& rArchiveFilename, unsigned fileVersion, CellPtr& rCell)
+    {
+        std::ifstream ifs(rArchiveFilename.c_str(), std::ios::binary);
+        boost::archive::text_iarchive input_arch(ifs);
+        StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>(::operator new(sizeof(StatechartCellCycleModelSerializable)));
+        boost::serialization::load_construct_data(input_arch, p_model, fileVersion);
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        rCell = CellPtr(new Cell(p_state, p_model, true));
+        return p_model;
+    }
+
+public:
+
+    void TestLoadingOlderArchiveFormats() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 100);
+
+        // A chart part way through S phase: born G1 + 1 hours ago, so it has been in S for an hour
+        CellPtr p_reference_cell = MakeCell(-(3.33 + 1.0));
+        StatechartCellCycleModelSerializable* p_reference_model = static_cast<StatechartCellCycleModelSerializable*>(p_reference_cell->GetCellCycleModel());
+        TS_ASSERT_EQUALS(p_reference_model->GetCurrentCellCyclePhase(), S_PHASE);
+        int state = p_reference_model->GetStatechartState();
+        TS_ASSERT_EQUALS(CellStatechart::NUM_VARIABLES, 1u);
+        TS_ASSERT_EQUALS(CellStatechart::GetVariableIndex("TimeInPhase"), 0);
+        TS_ASSERT_EQUALS(CellStatechart::GetVariableIndex("NoSuchVariable"), -1);
+
+        OutputFileHandler handler("TestStatechartCellCycleModelSerializable", false);
+
+        // Version 0: the variables by position
+        {
+            std::string archive_filename = handler.GetOutputDirectoryFullPath() + "version_0.arch";
+            {
+                std::ofstream ofs(archive_filename.c_str());
+                boost::archive::text_oarchive output_arch(ofs);
+                int number_of_vars = 1;
+                double time_in_phase = 2.5;
+                output_arch << state;
+                output_arch << number_of_vars;
+                output_arch << time_in_phase;
+            }
+
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 0, p_cell);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 2.5, 1e-12);
+            TS_ASSERT_EQUALS(p_model->GetCurrentCellCyclePhase(), S_PHASE);
+        }
+
+        // Version 0 from a chart with more variables: the extra ones are dropped
+        {
+            std::string archive_filename = handler.GetOutputDirectoryFullPath() + "version_0_extra.arch";
+            {
+                std::ofstream ofs(archive_filename.c_str());
+                boost::archive::text_oarchive output_arch(ofs);
+                int number_of_vars = 3;
+                double values[3] = {2.5, 7.0, 9.0};
+                output_arch << state;
+                output_arch << number_of_vars;
+                for (unsigned i=0; i<3; i++)
+                {
+                    output_arch << values[i];
+                }
+            }
+
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 0, p_cell);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 2.5, 1e-12);
+        }
+
+        // Version 1: the variables by name
+        {
+            std::string archive_filename = handler.GetOutputDirectoryFullPath() + "version_1.arch";
+            {
+                std::ofstream ofs(archive_filename.c_str());
+                boost::archive::text_oarchive output_arch(ofs);
+                int number_of_vars = 1;
+                std::string name("TimeInPhase");
+                double time_in_phase = 1.75;
+                output_arch << state;
+                output_arch << number_of_vars;
+                output_arch << name;
+                output_arch << time_in_phase;
+            }
+
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 1, p_cell);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 1.75, 1e-12);
+        }
+
+        // Version 1 from a chart that has since renamed or removed a variable, and put it first: variables are
+        // matched by name, not position, and one the current chart doesn't have is dropped
+        {
+            std::string archive_filename = handler.GetOutputDirectoryFullPath() + "version_1_renamed.arch";
+            {
+                std::ofstream ofs(archive_filename.c_str());
+                boost::archive::text_oarchive output_arch(ofs);
+                int number_of_vars = 2;
+                std::string names[2] = {"TimeInPhaseOld", "TimeInPhase"};
+                double values[2] = {7.0, 1.25};
+                output_arch << state;
+                output_arch << number_of_vars;
+                for (unsigned i=0; i<2; i++)
+                {
+                    output_arch << names[i];
+                    output_arch << values[i];
+                }
+            }
+
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 1, p_cell);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 1.25, 1e-12);
+        }
+
+        // A variable the archive doesn't have keeps the chart's default
+        {
+            std::string archive_filename = handler.GetOutputDirectoryFullPath() + "version_1_missing.arch";
+            {
+                std::ofstream ofs(archive_filename.c_str());
+                boost::archive::text_oarchive output_arch(ofs);
+                int number_of_vars = 1;
+                std::string name("RenamedTimeInPhase");
+                double value = 7.0;
+                output_arch << state;
+                output_arch << number_of_vars;
+                output_arch << name;
+                output_arch << value;
+            }
+
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 1, p_cell);
+            double pending_values[CellStatechart::NUM_VARIABLES];
+            p_model->GetStatechartVariables(pending_values);
+            TS_ASSERT_DELTA(pending_values[0], 0.0, 1e-12);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 0.0, 1e-12);
+        }
+
+        // The current format round trips through save_construct_data() and load_construct_data()
+        {
+            p_reference_model->pStatechart->TimeInPhase = 0.5;
+            std::string archive_filename = handler.GetOutputDirectoryFullPath() + "current.arch";
+            {
+                std::ofstream ofs(archive_filename.c_str());
+                boost::archive::text_oarchive output_arch(ofs);
+                const StatechartCellCycleModelSerializable* const p_const_model = p_reference_model;
+                boost::serialization::save_construct_data(output_arch, p_const_model, 2u);
+            }
+
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 2, p_cell);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 0.5, 1e-12);
+        }
+    }
+
+    void TestDeferredRestoreAfterLoading() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        OutputFileHandler handler("TestStatechartCellCycleModelSerializable", false);
+        std::string archive_filename = handler.GetOutputDirectoryFullPath() + "cell.arch";
+
+        int state;
+        {
+            SimulationTime* p_simulation_time = SimulationTime::Instance();
+            p_simulation_time->SetEndTimeAndNumberOfTimeSteps(1.0, 100);
+
+            // A chart an hour into S phase, updated every third timestep
+            CellPtr p_cell = MakeCell(-(3.33 + 1.0));
+            StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>(p_cell->GetCellCycleModel());
+            p_model->SetStatechartUpdateInterval(3);
+            p_model->pStatechart->TimeInPhase = 1.5;
+            state = p_model->GetStatechartState();
+
+            std::ofstream ofs(archive_filename.c_str());
+            boost::archive::text_oarchive output_arch(ofs);
+            CellPtr const p_const_cell = p_cell;
+            output_arch << static_cast<const SimulationTime&>(*p_simulation_time);
+            output_arch << p_const_cell;
+        }
+
+        {
+            SimulationTime::Destroy();
+            SimulationTime* p_simulation_time = SimulationTime::Instance();
+            p_simulation_time->SetStartTime(0.0);
+
+            CellPtr p_cell;
+            std::ifstream ifs(archive_filename.c_str(), std::ios::binary);
+            boost::archive::text_iarchive input_arch(ifs);
+            input_arch >> *p_simulation_time;
+            input_arch >> p_cell;
+
+            StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>(p_cell->GetCellCycleModel());
+            TS_ASSERT_EQUALS(p_model->GetStatechartUpdateInterval(), 3u);
+            TS_ASSERT_EQUALS(p_model->GetCurrentCellCyclePhase(), S_PHASE);
+
+            // Until it is first needed the chart isn't restored, but the getters return the values waiting for it
+            TS_ASSERT(p_model->mLoadingFromArchive);
+            TS_ASSERT(p_model->pStatechart->terminated());
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            double pending_values[CellStatechart::NUM_VARIABLES];
+            p_model->GetStatechartVariables(pending_values);
+            TS_ASSERT_DELTA(pending_values[0], 1.5, 1e-12);
+
+            // A daughter made before the first update restores the parent's chart first, so gets its state
+            StatechartCellCycleModelSerializable* p_daughter_model = static_cast<StatechartCellCycleModelSerializable*>(p_model->CreateCellCycleModel());
+            TS_ASSERT(!p_model->mLoadingFromArchive);
+            TS_ASSERT(!p_model->pStatechart->terminated());
+            TS_ASSERT_EQUALS(p_model->GetStatechartState(), state);
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, 1.5, 1e-12);
+
+            TS_ASSERT(!p_daughter_model->mLoadingFromArchive);
+            TS_ASSERT_EQUALS(p_daughter_model->GetStatechartState(), state);
+            TS_ASSERT_EQUALS(p_daughter_model->GetStatechartUpdateInterval(), 3u);
+
+            delete p_daughter_model;
+        }
+    }
+
+    void TestMultiRateUpdatesMatchEveryTimestep() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        // Stay short of an hour, when the chart may leave mitosis, and well inside G1
+        unsigned interval = 4;
+        double dt = 0.01;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.96, 96);
+
+        CellPtr p_every_step_cell = MakeCell(0.0);
+        StatechartCellCycleModelSerializable* p_every_step_model = static_cast<StatechartCellCycleModelSerializable*>(p_every_step_cell->GetCellCycleModel());
+        p_every_step_model->SetDistanceAwayFromDTC(50.0);
+        TS_ASSERT_EQUALS(p_every_step_model->GetStatechartUpdateInterval(), 1u);
+
+        CellPtr p_multi_rate_cell = MakeCell(0.0);
+        StatechartCellCycleModelSerializable* p_multi_rate_model = static_cast<StatechartCellCycleModelSerializable*>(p_multi_rate_cell->GetCellCycleModel());
+        p_multi_rate_model->SetDistanceAwayFromDTC(50.0);
+        TS_ASSERT_THROWS_THIS(p_multi_rate_model->SetStatechartUpdateInterval(0), "The statechart update interval must be at least one timestep");
+        p_multi_rate_model->SetStatechartUpdateInterval(interval);
+        TS_ASSERT_EQUALS(p_multi_rate_model->GetStatechartUpdateInterval(), interval);
+
+        double time_in_phase_at_last_update = 0.0;
+        for (unsigned step=1; step<=96; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_every_step_model->UpdateCellCyclePhase();
+            p_multi_rate_model->UpdateCellCyclePhase();
+            TS_ASSERT_DELTA(p_every_step_model->pStatechart->TimeInPhase, step*dt, 1e-12);
+
+            if (step%interval == 0)
+            {
+                // One update of interval*dt has the same effect as interval updates of dt
+                TS_ASSERT_DELTA(p_multi_rate_model->pStatechart->TimeInPhase, p_every_step_model->pStatechart->TimeInPhase, 1e-12);
+                TS_ASSERT_DELTA(p_multi_rate_model->GetStatechartTimestep(), 0.0, 1e-12);
+                time_in_phase_at_last_update = p_multi_rate_model->pStatechart->TimeInPhase;
+            }
+            else
+            {
+                // In between the chart is left alone and the time accumulates
+                TS_ASSERT_DELTA(p_multi_rate_model->pStatechart->TimeInPhase, time_in_phase_at_last_update, 1e-12);
+                TS_ASSERT_DELTA(p_multi_rate_model->GetStatechartTimestep(), (step%interval)*dt, 1e-12);
+            }
+            TS_ASSERT_EQUALS(p_multi_rate_model->GetCurrentCellCyclePhase(), G_ONE_PHASE);
+        }
+    }
+
+    void TestAccumulatedTimeCarriesAcrossDivision() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        unsigned interval = 4;
+        double dt = 0.01;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.5, 50);
+
+        CellPtr p_cell = MakeCell(0.0);
+        StatechartCellCycleModelSerializable* p_model = static_cast<StatechartCellCycleModelSerializable*>(p_cell->GetCellCycleModel());
+        p_model->SetDistanceAwayFromDTC(50.0);
+        p_model->SetStatechartUpdateInterval(interval);
+
+        // Divide half way to the next update
+        for (unsigned step=1; step<=2; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_model->UpdateCellCyclePhase();
+        }
+        TS_ASSERT_DELTA(p_model->GetStatechartTimestep(), 2*dt, 1e-12);
+
+        StatechartCellCycleModelSerializable* p_daughter_model = static_cast<StatechartCellCycleModelSerializable*>(p_model->CreateCellCycleModel());
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        CellPtr p_daughter_cell(new Cell(p_state, p_daughter_model));
+        p_model->ResetForDivision();
+        TS_ASSERT_EQUALS(p_daughter_model->GetStatechartUpdateInterval(), interval);
+        TS_ASSERT_DELTA(p_daughter_model->GetStatechartTimestep(), 2*dt, 1e-12);
+
+        // Both charts then update on the same timestep, each advancing through the whole interval
+        double parent_time_in_phase = p_model->pStatechart->TimeInPhase;
+        double daughter_time_in_phase = p_daughter_model->pStatechart->TimeInPhase;
+        for (unsigned step=3; step<=8; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_model->UpdateCellCyclePhase();
+            p_daughter_model->UpdateCellCyclePhase();
+            TS_ASSERT_DELTA(p_daughter_model->GetStatechartTimestep(), p_model->GetStatechartTimestep(), 1e-12);
+
+            if (step%interval == 0)
+            {
+                parent_time_in_phase += interval*dt;
+                daughter_time_in_phase += interval*dt;
+            }
+            TS_ASSERT_DELTA(p_model->pStatechart->TimeInPhase, parent_time_in_phase, 1e-12);
+            TS_ASSERT_DELTA(p_daughter_model->pStatechart->TimeInPhase, daughter_time_in_phase, 1e-12);
+        }
+    }
+
+    void TestPoolIsReusedAcrossBirthsAndDeaths() throw(Exception)
+    {
+        EXIT_IF_PARALLEL;
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 100);
+
+        // Take as many chunks from the pool as will ever be in use at once, then give them all back
+        unsigned max_num_models = 60;
+        std::set<void*> pool_chunks;
+        std::deque<StatechartCellCycleModelSerializable*> models;
+        for (unsigned i=0; i<max_num_models; i++)
+        {
+            models.push_back(new StatechartCellCycleModelSerializable());
+            TS_ASSERT(StatechartCellCycleModelSerializable::IsFromPool(models.back()));
+            pool_chunks.insert(models.back());
+        }
+        TS_ASSERT_EQUALS(pool_chunks.size(), max_num_models);
+        while (!models.empty())
+        {
+            delete models.front();
+            models.pop_front();
+        }
+
+        // Steady deaths and births of up to that many models should only ever reuse those chunks
+        for (unsigned i=0; i<50; i++)
+        {
+            models.push_back(new StatechartCellCycleModelSerializable());
+        }
+        for (unsigned round=0; round<100; round++)
+        {
+            for (unsigned i=0; i<10; i++)
+            {
+                delete models.front();
+                models.pop_front();
+            }
+            for (unsigned i=0; i<10; i++)
+            {
+                models.push_back(new StatechartCellCycleModelSerializable());
+            }
+            for (unsigned i=0; i<models.size(); i++)
+            {
+                TS_ASSERT_EQUALS(pool_chunks.count(models[i]), 1u);
+            }
+        }
+        while (!models.empty())
+        {
+            delete models.front();
+            models.pop_front();
+        }
+
+        /*
+         * A model built by load_construct_data() in memory from the global operator new, as boost::serialization
+         * may allocate it, isn't from the pool, so deleting it with its cell must hand it back to the global
+         * operator delete instead.
+         */
+        OutputFileHandler handler("TestStatechartCellCycleModelSerializable", false);
+        std::string archive_filename = handler.GetOutputDirectoryFullPath() + "pool.arch";
+        {
+            CellPtr p_reference_cell = MakeCell(0.0);
+            std::ofstream ofs(archive_filename.c_str());
+            boost::archive::text_oarchive output_arch(ofs);
+            const StatechartCellCycleModelSerializable* const p_const_model = static_cast<StatechartCellCycleModelSerializable*>(p_reference_cell->GetCellCycleModel());
+            boost::serialization::save_construct_data(output_arch, p_const_model, 2u);
+        }
+        {
+            CellPtr p_cell;
+            StatechartCellCycleModelSerializable* p_model = LoadConstructData(archive_filename, 2, p_cell);
+            p_model->RestoreStatechartFromArchive();
+            TS_ASSERT(!StatechartCellCycleModelSerializable::IsFromPool(p_model));
+            TS_ASSERT_EQUALS(pool_chunks.count(p_model), 0u);
+        }
+
+        // ...and the pool is still handing out its own chunks afterwards
+        StatechartCellCycleModelSerializable* p_model = new StatechartCellCycleModelSerializable();
+        TS_ASSERT_EQUALS(pool_chunks.count(p_model), 1u);
+        delete p_model;
+    }
+};
+
+#endif /*TESTSTATECHARTCELLCYCLEMODELSERIALIZABLE_HPP_*/
@@ -0,0 +1,345 @@
+/*
+
+Copyright (c) 2005-2013, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTTUBEBOUNDARYCONDITIONCULLING_HPP_
+#define TESTTUBEBOUNDARYCONDITIONCULLING_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "CellsGenerator.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "ElegansStochasticCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "CombinedStaticGonadBoundaryCondition.hpp"
+#include "GonadArmMovingBoundaryCondition.hpp"
+
+class TestTubeBoundaryConditionCulling : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestCullingDoesNotChangeResult() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        // Scatter cells through the proximal straight of a tube of radius 10, some of them near the wall
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<200; i++)
+        {
+            double x = 20.0 + 130.0*p_gen->ranf();
+            double r = 9.0*sqrt(p_gen->ranf());
+            double theta = 2.0*M_PI*p_gen->ranf();
+            nodes.push_back(new Node<3>(i, false, x, -20.0 + r*cos(theta), r*sin(theta)));
+        }
+
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            p_mesh->GetNode(i)->SetRadius(2.5);
+        }
+
+        CombinedStaticGonadBoundaryCondition<3> culled(&cell_population, 176, 161, 20, 10);
+        CombinedStaticGonadBoundaryCondition<3> unculled(&cell_population, 176, 161, 20, 10);
+        unculled.SetCullInteriorCells(false);
+        // Sharing the cells between threads (when built with OpenMP) must not change the result either
+#ifndef _OPENMP
+        TS_WARN("Built without OpenMP, so sharing the cells between threads is not being tested; see README.md");
+#endif
+        unculled.SetNumberOfThreads(4);
+        TS_ASSERT_EQUALS(unculled.GetNumberOfThreads(), 4u);
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 10);
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        unsigned total_culled = 0;
+        for (unsigned step=0; step<10; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+
+            // Jiggle the cells, then impose each condition on the same locations
+            std::vector<c_vector<double,3> > locations(p_mesh->GetNumNodes());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    p_mesh->GetNode(i)->rGetModifiableLocation()[d] += 0.6*p_gen->ranf() - 0.3;
+                }
+                locations[i] = p_mesh->GetNode(i)->rGetLocation();
+            }
+
+            culled.ImposeBoundaryCondition(old_locations);
+            TS_ASSERT(culled.VerifyBoundaryCondition());
+            TS_ASSERT_EQUALS(culled.GetNumCellsImposed(), 200u);
+            total_culled += culled.GetNumCellsCulled();
+
+            std::vector<c_vector<double,3> > culled_locations(p_mesh->GetNumNodes());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                culled_locations[i] = p_mesh->GetNode(i)->rGetLocation();
+                p_mesh->GetNode(i)->rGetModifiableLocation() = locations[i];
+            }
+
+            unculled.ImposeBoundaryCondition(old_locations);
+            TS_ASSERT_EQUALS(unculled.GetNumCellsCulled(), 0u);
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    TS_ASSERT_DELTA(p_mesh->GetNode(i)->rGetLocation()[d], culled_locations[i][d], 1e-12);
+                }
+            }
+        }
+
+        // Most cells are well inside the wall, so most should have been skipped after the first step
+        TS_ASSERT_LESS_THAN(500u, total_culled);
+
+        // Tidy up
+        delete p_mesh;
+    }
+
+    void TestProjectionCacheDoesNotChangeMovingArmResult() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+        // Scatter cells around both ends of the turn of an arm that has grown past it, many of them outside the wall
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<200; i++)
+        {
+            double x = 6.0*p_gen->ranf() - 3.0;
+            double y_centre = (i%2 == 0) ? -20.0 : 20.0;
+            double r = 5.5*sqrt(p_gen->ranf());
+            double theta = 2.0*M_PI*p_gen->ranf();
+            nodes.push_back(new Node<3>(i, false, x, y_centre + r*cos(theta), r*sin(theta)));
+        }
+
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            p_mesh->GetNode(i)->SetRadius(1.0);
+        }
+
+        // The arm grows by 0.35 in length and 0.05 in radius each timestep, so cached pieces are reused
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 20);
+        GonadArmMovingBoundaryCondition<3> cached(&cell_population, 260.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+        GonadArmMovingBoundaryCondition<3> exact(&cell_population, 260.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+        TS_ASSERT_DELTA(cached.GetProjectionTolerance(), 0.5, 1e-12);
+        exact.SetProjectionTolerance(0.0);
+
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        unsigned total_moved = 0;
+        for (unsigned step=0; step<20; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+
+            // Jiggle the cells, some of them across the ends of the turn, then impose each condition on the same locations
+            std::vector<c_vector<double,3> > locations(p_mesh->GetNumNodes());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    p_mesh->GetNode(i)->rGetModifiableLocation()[d] += 0.6*p_gen->ranf() - 0.3;
+                }
+                locations[i] = p_mesh->GetNode(i)->rGetLocation();
+            }
+
+            cached.ImposeBoundaryCondition(old_locations);
+            TS_ASSERT(cached.VerifyBoundaryCondition());
+
+            std::vector<c_vector<double,3> > cached_locations(p_mesh->GetNumNodes());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                cached_locations[i] = p_mesh->GetNode(i)->rGetLocation();
+                if (norm_2(cached_locations[i] - locations[i]) > 0.0)
+                {
+                    total_moved++;
+                }
+                p_mesh->GetNode(i)->rGetModifiableLocation() = locations[i];
+            }
+
+            exact.ImposeBoundaryCondition(old_locations);
+            TS_ASSERT(exact.VerifyBoundaryCondition());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    TS_ASSERT_DELTA(p_mesh->GetNode(i)->rGetLocation()[d], cached_locations[i][d], 1e-12);
+                }
+            }
+        }
+
+        // Cells were moved onto the wall throughout, and the default tolerance did reuse cached pieces
+        TS_ASSERT_LESS_THAN(50u, total_moved);
+        TS_ASSERT_LESS_THAN(0u, cached.rGetProjectionCache().GetNumPieceProjections());
+        TS_ASSERT_EQUALS(exact.rGetProjectionCache().GetNumPieceProjections(), 0u);
+
+        // Tidy up
+        delete p_mesh;
+    }
+
+    void TestThreadsDoNotChangeMovingArmResult() throw(Exception)
+    {
+        /** The next line is needed because we cannot currently run node based simulations in parallel. */
+        EXIT_IF_PARALLEL;
+
+#ifndef _OPENMP
+        TS_WARN("Built without OpenMP, so sharing the cells between threads is not being tested; see README.md");
+#endif
+
+        // Scatter cells along the lower straight, round the turn and into the upper straight, some outside the wall
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<300; i++)
+        {
+            c_vector<double,3> location = zero_vector<double>(3);
+            if (i%3 == 0)
+            {
+                location[0] = 20.0 + 150.0*p_gen->ranf();
+                location[1] = -20.0;
+            }
+            else if (i%3 == 1)
+            {
+                double angle = M_PI*(0.5 + p_gen->ranf());
+                location[0] = 20.0*cos(angle);
+                location[1] = 20.0*sin(angle);
+            }
+            else
+            {
+                location[0] = 15.0*p_gen->ranf();
+                location[1] = 20.0;
+            }
+            c_vector<double,3> offset;
+            for (unsigned d=0; d<3; d++)
+            {
+                offset[d] = p_gen->StandardNormalRandomDeviate();
+            }
+            location += 6.5*sqrt(p_gen->ranf())*offset/norm_2(offset);
+            nodes.push_back(new Node<3>(i, location));
+        }
+
+        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>;
+        p_mesh->ConstructNodesWithoutMesh(nodes, 20.0);
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        CellsGenerator<ElegansStochasticCellCycleModel, 3> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_transit_type);
+        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells);
+        for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+        {
+            p_mesh->GetNode(i)->SetRadius(1.0);
+        }
+
+        // A growing arm imposed on one thread, and the same arm imposed with the cells shared between four
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 10);
+        GonadArmMovingBoundaryCondition<3> serial(&cell_population, 260.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+        GonadArmMovingBoundaryCondition<3> threaded(&cell_population, 260.0, 176, 161, 20, 5, 8, 0.7, 0.1);
+        TS_ASSERT_EQUALS(serial.GetNumberOfThreads(), 1u);
+        threaded.SetNumberOfThreads(4);
+        TS_ASSERT_EQUALS(threaded.GetNumberOfThreads(), 4u);
+
+        std::map<Node<3>*, c_vector<double,3> > old_locations;
+        unsigned total_moved = 0;
+        for (unsigned step=0; step<10; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+
+            // Jiggle the cells, then impose each condition on the same locations
+            std::vector<c_vector<double,3> > locations(p_mesh->GetNumNodes());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    p_mesh->GetNode(i)->rGetModifiableLocation()[d] += 0.6*p_gen->ranf() - 0.3;
+                }
+                locations[i] = p_mesh->GetNode(i)->rGetLocation();
+            }
+
+            serial.ImposeBoundaryCondition(old_locations);
+            TS_ASSERT(serial.VerifyBoundaryCondition());
+            TS_ASSERT_EQUALS(serial.GetNumCellsImposed(), 300u);
+
+            std::vector<c_vector<double,3> > serial_locations(p_mesh->GetNumNodes());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                serial_locations[i] = p_mesh->GetNode(i)->rGetLocation();
+                if (norm_2(serial_locations[i] - locations[i]) > 0.0)
+                {
+                    total_moved++;
+                }
+                p_mesh->GetNode(i)->rGetModifiableLocation() = locations[i];
+            }
+
+            // Each cell is imposed on independently, so the threads must give exactly the same locations
+            threaded.ImposeBoundaryCondition(old_locations);
+            TS_ASSERT(threaded.VerifyBoundaryCondition());
+            TS_ASSERT_EQUALS(threaded.GetNumCellsImposed(), 300u);
+            TS_ASSERT_EQUALS(threaded.GetNumCellsCulled(), serial.GetNumCellsCulled());
+            for (unsigned i=0; i<p_mesh->GetNumNodes(); i++)
+            {
+                for (unsigned d=0; d<3; d++)
+                {
+                    TS_ASSERT_EQUALS(p_mesh->GetNode(i)->rGetLocation()[d], serial_locations[i][d]);
+                }
+            }
+        }
+
+        // Cells were moved onto the wall throughout
+        TS_ASSERT_LESS_THAN(100u, total_moved);
+
+        // Tidy up
+        delete p_mesh;
+    }
+};
+
+#endif /*TESTTUBEBOUNDARYCONDITIONCULLING_HPP_*/